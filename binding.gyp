@@ -4,6 +4,27 @@
       "target_name": "iota_common",
       "sources": [
          "src/interface.cpp",
+         "src/pow/backend.cpp",
+         "src/pow/benchmark.cpp",
+         "src/pow/cpu.cpp",
+         "src/pow/curl.cpp",
+         "src/pow/flight.cpp",
+         "src/pow/hash_batch.cpp",
+         "src/pow/hashcash.cpp",
+         "src/pow/job.cpp",
+         "src/pow/midstate.cpp",
+         "src/pow/search.cpp",
+         "src/pow/search_avx2.cpp",
+         "src/pow/search_avx512.cpp",
+         "src/pow/socket_backend.cpp",
+         "src/pow/transaction.cpp",
+         "src/ring/job_ring.cpp",
+         "src/scheduler/scheduler.cpp",
+         "src/sign/address_range.cpp",
+         "src/sign/iss.cpp",
+         "src/sign/kerl.cpp",
+         "src/sign/kerl_avx2.cpp",
+         "src/sign/kerl_avx512.cpp",
          "iota_common/common/model/bundle.c",
          "iota_common/common/model/transaction.c",
          "iota_common/common/helpers/pow.c",
@@ -32,7 +53,7 @@
          "iota_common/utils/memset_safe.c",
          "iota_common/utils/system.c",
          "iota_common/utils/time.c",
-         "src/keccak/KeccakP-1600-reference.c",
+         "src/keccak/KeccakP-1600-opt64.c",
          "src/keccak/KeccakSpongeWidth1600.c",
          "src/keccak/KeccakHash.c",
       ],
@@ -46,7 +67,6 @@
           }],
         ],
       "include_dirs": [
-         "<!(node -e \"require('nan')\")",
          "iota_common",
          "src",
          "src/utarray",
@@ -55,8 +75,96 @@
       "defines": [
         "PCURL_STATE_SHORT",
         "PCURL_SBOX_UNWIND_4",
-        "PTRIT_SSE2"
+        "PTRIT_SSE2",
+        "ENTANGLED_POW_AVX2",
+        "ENTANGLED_POW_AVX512",
+        "NAPI_VERSION=6"
+      ]
+    },
+    {
+      "target_name": "keccak_test",
+      "type": "executable",
+      "sources": [
+         "src/keccak/KeccakP-1600-test.c",
+         "src/keccak/KeccakP-1600-opt64.c",
+      ],
+      # The reference implementation is included whole, with byte/word helpers only its own big-endian path uses
+      "cflags+": ["-std=gnu99", "-Wno-unused-function"],
+      "conditions": [
+          ['OS=="mac"', {
+            "xcode_settings": {
+              "GCC_C_LANGUAGE_STANDARD": "gnu99",
+              "WARNING_CFLAGS": ["-Wno-unused-function"],
+            },
+          }],
+        ],
+      "include_dirs": [
+         "src/keccak"
+      ]
+    },
+    {
+      "target_name": "kerl_test",
+      "type": "executable",
+      "sources": [
+         "src/sign/kerl_test.cpp",
+         "src/sign/kerl.cpp",
+         "src/sign/kerl_avx2.cpp",
+         "src/sign/kerl_avx512.cpp",
+         "src/pow/cpu.cpp",
+         "src/keccak/KeccakP-1600-opt64.c",
+         "src/keccak/KeccakSpongeWidth1600.c",
+         "src/keccak/KeccakHash.c",
+      ],
+      "include_dirs": [
+         "src"
+      ],
+      "defines": [
+        "ENTANGLED_POW_AVX2",
+        "ENTANGLED_POW_AVX512"
       ]
     }
+  ],
+  "conditions": [
+    ['OS!="win"', {
+      "targets": [
+        {
+          "target_name": "entangled_pow_worker",
+          "type": "executable",
+          "sources": [
+             "src/worker/pow_worker.cpp",
+             "src/pow/backend.cpp",
+             "src/pow/cpu.cpp",
+             "src/pow/curl.cpp",
+             "src/pow/flight.cpp",
+             "src/pow/hash_batch.cpp",
+             "src/pow/job.cpp",
+             "src/pow/midstate.cpp",
+             "src/pow/search.cpp",
+             "src/pow/search_avx2.cpp",
+             "src/pow/search_avx512.cpp",
+             "src/pow/socket_backend.cpp",
+             "src/pow/transaction.cpp",
+             "src/scheduler/scheduler.cpp",
+          ],
+          "cflags+": ["-msse2", "-pthread"],
+          "ldflags": ["-pthread"],
+          "conditions": [
+              ['OS=="mac"', {
+                "xcode_settings": {
+                  "OTHER_CFLAGS" : ["-msse2"],
+                },
+              }],
+            ],
+          "include_dirs": [
+             "src"
+          ],
+          "defines": [
+            "PTRIT_SSE2",
+            "ENTANGLED_POW_AVX2",
+            "ENTANGLED_POW_AVX512"
+          ]
+        }
+      ]
+    }]
   ]
 }
@@ -1,10 +1,140 @@
 // Type definitions for entangled-node
 
-export function powTrytesFunc(trytes: string, mwm: number): Promise<string>
-export function powBundleFunc(trytes: Array<string>, trunk: string, branch: string, mwm: number): Promise<Array<string>>
+export interface PowProgress {
+	attempts: number
+	elapsed: number
+	hashrate: number
+}
+
+export interface PowOptions {
+	signal?: AbortSignal
+	deadline?: Date | number
+	timeout?: number
+	onProgress?: (progress: PowProgress) => void
+	progressInterval?: number
+	priority?: Priority
+	threads?: number
+	cpus?: Array<number>
+	nice?: number
+	partition?: { index: number; count: number }
+	range?: { start: number; end: number }
+	stats?: boolean
+}
+
+export interface PowStats {
+	weight: number
+	attempts: number
+	elapsed: number
+	threads: number
+	backend: 'local' | 'socket'
+}
+
+export interface PowDefaults {
+	threads?: number
+	cpus?: Array<number>
+	nice?: number
+}
+
+export type Priority = 'interactive' | 'normal' | 'bulk'
+
+export type PowKernel = 'ptrit64' | 'sse2' | 'avx2' | 'avx512'
+
+export interface SchedulerQueueStats {
+	queued: number
+	capacity: number
+	admitted: number
+	rejected: number
+}
+
+export interface SchedulerStats {
+	threads: number
+	running: number
+	queues: Record<Priority, SchedulerQueueStats>
+}
+
+export interface JobRing {
+	transactionHash(trytes: string): Promise<string>
+	genAddressTrytes(seed: string, index: number, security?: number): Promise<string>
+	close(): void
+	readonly buffer: SharedArrayBuffer
+}
+
+export type HasherInput = string | Buffer | Int8Array | Array<number>
+
+export class Kerl {
+	absorb(input: HasherInput): this
+	squeeze(length?: number): Array<number>
+	squeezeTrytes(length?: number): string
+	reset(): this
+	clone(): Kerl
+}
+
+export class CurlP81 {
+	absorb(input: HasherInput): this
+	squeeze(length?: number): Array<number>
+	squeezeTrytes(length?: number): string
+	reset(): this
+	clone(): CurlP81
+}
+
+export interface HashStreamOptions {
+	concurrency?: number
+	mwm?: number
+	highWaterMark?: number
+}
+
+export interface CalibrationMeasure {
+	kernel: string
+	threads: number
+	hashrate: number
+}
+
+export interface Calibration extends CalibrationMeasure {
+	date: string
+	cpu: string
+	cores: number
+	version: string
+	results: Array<CalibrationMeasure>
+}
+
+export function powTrytesFunc(trytes: string, mwm: number, options: PowOptions & { stats: true }): Promise<PowStats & { nonce: string }>
+export function powTrytesFunc(trytes: string, mwm: number, options?: PowOptions): Promise<string>
+export function powTrytesBatchFunc(trytes: Array<string>, mwm: number, options?: PowOptions): Promise<Array<string>>
+export function powBundleFunc(trytes: Array<string>, trunk: string, branch: string, mwm: number, options: PowOptions & { stats: true }): Promise<PowStats & { trytes: Array<string> }>
+export function powBundleFunc(trytes: Array<string>, trunk: string, branch: string, mwm: number, options?: PowOptions): Promise<Array<string>>
+export function powBundlesFunc(bundles: Array<{ trytes: Array<string>; trunk: string; branch: string }>, mwm: number, options?: PowOptions): Array<Promise<Array<string>>>
+export function hashcashFunc(buffer: string, nonceOffset: number, nonceLength: number, mwm: number, options?: PowOptions): Promise<{ nonce: string; hash: string }>
+export function hashcashFunc(buffer: Array<number>, nonceOffset: number, nonceLength: number, mwm: number, options?: PowOptions): Promise<{ nonce: Array<number>; hash: Array<number> }>
 export function genAddressTrytesFunc(seed: string, index: number, security: number): Promise<string>
 export function genAddressTritsFunc(seed: Int8Array, index: number, security: number): Promise<Int8Array>
+export function genAddressRange(seed: string, start: number, count: number, security?: number, options?: { chunkSize?: number }): AsyncIterableIterator<Array<string>>
+export function genAddressBatchFunc(seeds: Buffer, indexes: Uint32Array | Array<number>, security?: number | Uint8Array | Array<number>): Promise<Buffer>
 export function genSignatureTrytesFunc(seed: string, index: number, security: number, bundle: string): Promise<string>
 export function genSignatureTritsFunc(seed: Int8Array, index: number, security: number, bundle: Int8Array): Promise<Int8Array>
 export function transactionHashFunc(trytes: string): Promise<string>
-export function bundleMiner(bundleNormalizedMax: Int8Array, security: number, essence: Int8Array, essenceLength: number, count: number, nprocs: number, miningThreshold: number): Promise<number>
+export function transactionHashesFunc(trytes: Array<string> | Buffer, options: { weights: true }): Promise<{ hashes: Array<string>; weights: Uint8Array }>
+export function transactionHashesFunc(trytes: Array<string> | Buffer, options?: { weights?: boolean }): Promise<Array<string>>
+export function bundleMiner(bundleNormalizedMax: Int8Array, security: number, essence: Int8Array, essenceLength: number, count: number, nprocs: number, miningThreshold: number, fullySecure: number): Promise<number>
+
+export function powTrytesSync(trytes: string, mwm: number): string
+export function powBundleSync(trytes: Array<string>, trunk: string, branch: string, mwm: number): Array<string>
+export function genAddressTrytesSync(seed: string, index: number, security: number): string
+export function genAddressTritsSync(seed: Int8Array, index: number, security: number): Int8Array
+export function genSignatureTrytesSync(seed: string, index: number, security: number, bundle: string): string
+export function genSignatureTritsSync(seed: Int8Array, index: number, security: number, bundle: Int8Array): Int8Array
+export function transactionHashSync(trytes: string): string
+export function bundleMinerSync(bundleNormalizedMax: Int8Array, security: number, essence: Int8Array, essenceLength: number, count: number, nprocs: number, miningThreshold: number, fullySecure: number): number
+
+export function createJobRing(options?: { slots?: number }): JobRing
+export function createHashStream(options?: HashStreamOptions): import('stream').Transform
+export function schedulerStats(): SchedulerStats
+export function setQueueCapacity(priority: Priority, capacity: number): void
+export function setPowDefaults(defaults: PowDefaults): void
+export function calibrate(options?: { duration?: number; file?: string; save?: boolean }): Promise<Calibration>
+export function calibration(): Calibration | null
+export function estimatePowTime(mwm: number, transactions?: number): number
+export function powKernels(): { supported: Array<PowKernel>; selected: PowKernel }
+export function setPowKernel(kernel: PowKernel): void
+export function setPowBackend(options?: { socket: string; retries?: number; retryDelay?: number; fallback?: boolean }): void
+export function midstateCacheStats(): { entries: number; capacity: number; hits: number; misses: number }
+export function setMidstateCacheCapacity(capacity: number): void
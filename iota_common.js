@@ -1,19 +1,166 @@
+const fs = require('fs')
+const os = require('os')
+const path = require('path')
+const { Transform } = require('stream')
 const iotaCommonApi = require('./build/Release/iota_common.node')
+const { version } = require('./package.json')
+
+/**
+ * Error a Proof of Work job is rejected with once its AbortSignal fires
+ * @returns {Error} AbortError
+ **/
+const abortError = () => {
+	const err = new Error('Proof of Work cancelled')
+	err.name = 'AbortError'
+	err.code = 'ABORT_ERR'
+	return err
+}
+
+/**
+ * Names native cancellation errors like DOM AbortErrors
+ * @param {Error} err - Native Proof of Work error
+ * @returns {Error} The same error
+ **/
+const powError = (err) => {
+	if (err.code === 'ABORT_ERR') {
+		err.name = 'AbortError'
+	}
+	return err
+}
+
+/**
+ * Starts a native Proof of Work job honouring the cancellation, deadline and progress options
+ * @param {Object} options - (optional) Job options, see powTrytesFunc
+ * @param {Function} start - Starts the native job with its native options and completion callback, returns its id
+ * @param {Function} resolve - Called with the job result, and its statistics for a single request job
+ * @param {Function} reject - Called with the job error
+ **/
+const startPowJob = (options, start, resolve, reject) => {
+	const { signal, deadline, timeout, onProgress, progressInterval, priority, threads, cpus, nice } = options || {}
+	const nativeOptions = {}
+
+	if (signal && signal.aborted) {
+		reject(abortError())
+		return
+	}
+
+	if (timeout !== undefined) {
+		nativeOptions.timeout = timeout
+	}
+	if (deadline !== undefined) {
+		const remaining = new Date(deadline).getTime() - Date.now()
+		nativeOptions.timeout = nativeOptions.timeout === undefined ? remaining : Math.min(nativeOptions.timeout, remaining)
+	}
+	if (nativeOptions.timeout !== undefined && nativeOptions.timeout <= 0) {
+		const err = new Error('Proof of Work deadline exceeded')
+		err.code = 'ETIMEDOUT'
+		reject(err)
+		return
+	}
+	if (priority) {
+		nativeOptions.priority = priority
+	}
+	Object.assign(nativeOptions, { threads, cpus, nice })
+
+	let id
+	let timer
+	const onAbort = () => iotaCommonApi.cancelJob(id)
+	const callback = (err, result, stats) => {
+		if (signal) {
+			signal.removeEventListener('abort', onAbort)
+		}
+		clearInterval(timer)
+		if (err) {
+			reject(powError(err))
+		} else {
+			resolve(result, stats)
+		}
+	}
+
+	try {
+		id = start(nativeOptions, callback)
+	} catch (err) {
+		// Rejected by the scheduler with an EBUSY error, or invalid options
+		reject(err)
+		return
+	}
+	if (signal) {
+		signal.addEventListener('abort', onAbort, { once: true })
+	}
+	if (onProgress) {
+		// Progress is sampled from the native job, so that no native thread is spent waiting on the search
+		timer = setInterval(() => {
+			const progress = iotaCommonApi.jobProgress(id)
+			if (progress) {
+				progress.hashrate = progress.elapsed > 0 ? (progress.attempts * 1000) / progress.elapsed : 0
+				onProgress(progress)
+			}
+		}, Math.max(1, progressInterval || 1000))
+	}
+}
+
+/**
+ * Resolves a job with its result, or with { [name]: result, weight, attempts, elapsed, threads, backend } if the
+ * stats option is set
+ * @param {Object} options - (optional) Job options
+ * @param {string} name - Name of the result
+ * @param {Function} resolve - Resolves the job promise
+ * @returns {Function} Resolves with the job result and statistics
+ **/
+const resolveWithStats = (options, name, resolve) => (result, stats) =>
+	resolve(options && options.stats ? Object.assign({ [name]: result }, stats) : result)
 
 /**
  * Do Proof of Work on trytes
  * @param {string} trytes - Input trytes value
  * @param {number} mwm - (optional) Min Weight Magnitude
+ * @param {Object} options - (optional) Job options
+ * @param {AbortSignal} options.signal - Cancels the search, the promise is then rejected with an AbortError
+ * @param {Date|number} options.deadline - Date after which the search is abandoned with an ETIMEDOUT error
+ * @param {number} options.timeout - Milliseconds after which the search is abandoned with an ETIMEDOUT error
+ * @param {Function} options.onProgress - Called with { attempts, elapsed, hashrate } while searching
+ * @param {number} options.progressInterval - Minimum milliseconds between two onProgress calls, 1000 by default
+ * @param {string} options.priority - Scheduler queue of the job: 'interactive', 'normal' (default) or 'bulk'
+ * @param {number} options.threads - Maximum number of threads searching at once, all threads of its pool by default
+ * @param {Array<number>} options.cpus - CPUs the search is confined to, see setPowDefaults
+ * @param {number} options.nice - Nice increment of the threads searching, see setPowDefaults
+ * @param {Object} options.partition - Searches only partition { index, count } of the nonce space, so that count
+ * processes can share the job. The promise is rejected with an ERANGE error once the partition is exhausted.
+ * @param {Object} options.range - Searches only the iteration counters { start, end } of the nonce space, out of
+ * 3^27, instead of a partition
+ * @param {boolean} options.stats - Resolves with { nonce, weight, attempts, elapsed, threads, backend } instead: the
+ * trailing zero trits of the hash, the nonces tried, the milliseconds spent, the largest number of threads that
+ * searched at once and the backend the search ran on
  * @returns {string} Proof of Work
  **/
-const powTrytesFunc = (trytes, mwm) => {
+const powTrytesFunc = (trytes, mwm, options) => {
+	const { partition, range } = options || {}
+
+	return new Promise((resolve, reject) => {
+		startPowJob(
+			options,
+			(nativeOptions, callback) => iotaCommonApi.powTrytesAsync(trytes, mwm || 14, Object.assign(nativeOptions, { partition, range }), callback),
+			resolveWithStats(options, 'nonce', resolve),
+			reject
+		)
+	})
+}
+
+/**
+ * Do Proof of Work on independent transactions at once. Several transactions share each search, which is much
+ * faster than one powTrytesFunc call each for the many transactions of a low Min Weight Magnitude.
+ * @param {Array<string>} trytes - Input transaction trytes
+ * @param {number} mwm - (optional) Min Weight Magnitude
+ * @param {Object} options - (optional) Job options, see powTrytesFunc
+ * @returns {Array<string>} Proof of Work of each transaction
+ **/
+const powTrytesBatchFunc = (trytes, mwm, options) => {
+	if (trytes.length === 0) {
+		return Promise.resolve([])
+	}
+
 	return new Promise((resolve, reject) => {
-		try {
-			const pow = iotaCommonApi.powTrytes(trytes, mwm || 14)
-			resolve(pow)
-		} catch (err) {
-			reject(err)
-		}
+		startPowJob(options, (nativeOptions, callback) => iotaCommonApi.powTrytesBatchAsync(trytes, mwm || 14, nativeOptions, callback), resolve, reject)
 	})
 }
 
@@ -23,16 +170,63 @@ const powTrytesFunc = (trytes, mwm) => {
  * @param {string} trunk - Trunk hash
  * @param {string} branch - Bundle hash
  * @param {number} mwm - (optional) Min Weight Magnitude
+ * @param {Object} options - (optional) Job options, see powTrytesFunc. With stats set, resolves with
+ * { trytes, weight, attempts, elapsed, threads, backend }, weight being the smallest of the bundle.
  * @returns {Array<string>} Output transaction trytes
  **/
-const powBundleFunc = (trytes, trunk, branch, mwm) => {
+const powBundleFunc = (trytes, trunk, branch, mwm, options) => {
 	return new Promise((resolve, reject) => {
-		try {
-			const transactions = iotaCommonApi.powBundle(trytes, trunk, branch, mwm || 14)
-			resolve(transactions)
-		} catch (err) {
-			reject(err)
-		}
+		startPowJob(
+			options,
+			(nativeOptions, callback) => iotaCommonApi.powBundleAsync(trytes, trunk, branch, mwm || 14, nativeOptions, callback),
+			resolveWithStats(options, 'trytes', resolve),
+			reject
+		)
+	})
+}
+
+/**
+ * Do Proof of Work on independent bundles at once, sharing the cores fairly between them
+ * @param {Array<Object>} bundles - Bundles as { trytes, trunk, branch }, see powBundleFunc
+ * @param {number} mwm - (optional) Min Weight Magnitude
+ * @param {Object} options - (optional) Job options applying to every bundle, see powTrytesFunc
+ * @returns {Array<Promise<Array<string>>>} Output transaction trytes of each bundle, settled as soon as it is done
+ **/
+const powBundlesFunc = (bundles, mwm, options) => {
+	if (bundles.length === 0) {
+		return []
+	}
+
+	const settlers = []
+	const results = bundles.map(() => new Promise((resolve, reject) => settlers.push({ resolve, reject })))
+	const onBundle = (index, err, trytes) => (err ? settlers[index].reject(powError(err)) : settlers[index].resolve(trytes))
+
+	startPowJob(
+		options,
+		(nativeOptions, callback) => iotaCommonApi.powBundlesAsync(bundles, mwm || 14, nativeOptions, onBundle, callback),
+		() => {},
+		(err) => settlers.forEach(({ reject }) => reject(err))
+	)
+	return results
+}
+
+/**
+ * Do Curl-P-81 hashcash on an arbitrary buffer: finds a nonce at the given place giving its hash a minimum weight
+ * @param {string|Array<number>} buffer - Input trytes, or trits, a multiple of 243 trits long
+ * @param {number} nonceOffset - Offset of the nonce in the buffer, in trytes or trits like the buffer
+ * @param {number} nonceLength - Length of the nonce, at least 9 trits, within one 243 trit block of the buffer
+ * @param {number} mwm - Min Weight Magnitude, the number of trailing zero trits of the hash
+ * @param {Object} options - (optional) Job options, see powTrytesFunc
+ * @returns {Object} The { nonce, hash } found, in trytes or trits like the buffer
+ **/
+const hashcashFunc = (buffer, nonceOffset, nonceLength, mwm, options) => {
+	return new Promise((resolve, reject) => {
+		startPowJob(
+			options,
+			(nativeOptions, callback) => iotaCommonApi.hashcashAsync(buffer, nonceOffset, nonceLength, mwm, nativeOptions, callback),
+			resolve,
+			reject
+		)
 	})
 }
 
@@ -45,12 +239,7 @@ const powBundleFunc = (trytes, trunk, branch, mwm) => {
  **/
 const genAddressTrytesFunc = (seed, index, security) => {
 	return new Promise((resolve, reject) => {
-		try {
-			const address = iotaCommonApi.genAddressTrytes(seed, index, security || 2)
-			resolve(address)
-		} catch (err) {
-			reject(err)
-		}
+		iotaCommonApi.genAddressTrytesAsync(seed, index, security || 2, (err, address) => (err ? reject(err) : resolve(address)))
 	})
 }
 
@@ -63,12 +252,64 @@ const genAddressTrytesFunc = (seed, index, security) => {
  **/
 const genAddressTritsFunc = (seed, index, security) => {
 	return new Promise((resolve, reject) => {
-		try {
-			const address = iotaCommonApi.genAddressTrits(seed, index, security || 2)
-			resolve(address)
-		} catch (err) {
-			reject(err)
+		iotaCommonApi.genAddressTritsAsync(seed, index, security || 2, (err, address) => (err ? reject(err) : resolve(address)))
+	})
+}
+
+/**
+ * Generates the addresses of a range of indexes, as an async iterator over chunks of addresses. Every chunk is
+ * derived at once over all native threads, and the next one while the current one is consumed, so that long ranges
+ * are scanned without a call per address nor every address in memory at once.
+ * @param {string} seed - Seed in trytes
+ * @param {number} start - First address index
+ * @param {number} count - Number of addresses
+ * @param {number} security - (optional) Target security
+ * @param {Object} options - (optional) Options
+ * @param {number} options.chunkSize - Addresses per chunk, 256 by default
+ * @returns {AsyncIterableIterator<Array<string>>} Chunks of addresses in trytes, in index order
+ **/
+const genAddressRange = (seed, start, count, security, options) => {
+	const { chunkSize } = options || {}
+	const size = Math.max(1, chunkSize || 256)
+	const end = start + count
+	const chunk = (index) => {
+		const addresses = new Promise((resolve, reject) => {
+			iotaCommonApi.genAddressRangeAsync(seed, index, Math.min(size, end - index), security || 2, (err, result) =>
+				err ? reject(err) : resolve(result)
+			)
+		})
+		// A chunk derived ahead is dropped if iteration stops early
+		addresses.catch(() => {})
+		return addresses
+	}
+
+	return (async function* () {
+		let next = start < end ? chunk(start) : null
+		for (let index = start; index < end; index += size) {
+			const addresses = await next
+			next = index + size < end ? chunk(index + size) : null
+			yield addresses
 		}
+	})()
+}
+
+/**
+ * Generates the addresses of many (seed, index, security) tuples in one native call, spread over all native threads.
+ * Seeds are copied out of the Buffer before this returns, so that it can be zeroed right away, and the native copy
+ * of every seed is scrubbed as soon as it is read.
+ * @param {Buffer} seeds - Seeds packed 81 trytes each, shorter seeds being padded with 9s
+ * @param {Uint32Array|Array<number>} indexes - Address index of every seed
+ * @param {number|Uint8Array|Array<number>} security - (optional) Target security, of all seeds or of every seed
+ * @returns {Promise<Buffer>} Addresses packed 81 trytes each, in the order of the seeds
+ **/
+const genAddressBatchFunc = (seeds, indexes, security) => {
+	return new Promise((resolve, reject) => {
+		const count = indexes.length
+		const securities =
+			ArrayBuffer.isView(security) || Array.isArray(security) ? Uint8Array.from(security) : new Uint8Array(count).fill(security || 2)
+		iotaCommonApi.genAddressBatchAsync(seeds, Uint32Array.from(indexes), securities, (err, addresses) =>
+			err ? reject(err) : resolve(addresses)
+		)
 	})
 }
 
@@ -82,12 +323,7 @@ const genAddressTritsFunc = (seed, index, security) => {
  **/
 const genSignatureTrytesFunc = (seed, index, security, bundle) => {
 	return new Promise((resolve, reject) => {
-		try {
-			const signature = iotaCommonApi.genSignatureTrytes(seed, index, security || 2, bundle)
-			resolve(signature)
-		} catch (err) {
-			reject(err)
-		}
+		iotaCommonApi.genSignatureTrytesAsync(seed, index, security || 2, bundle, (err, signature) => (err ? reject(err) : resolve(signature)))
 	})
 }
 
@@ -101,12 +337,7 @@ const genSignatureTrytesFunc = (seed, index, security, bundle) => {
  **/
 const genSignatureTritsFunc = (seed, index, security, bundle) => {
 	return new Promise((resolve, reject) => {
-		try {
-			const signature = iotaCommonApi.genSignatureTrits(seed, index, security || 2, bundle)
-			resolve(signature)
-		} catch (err) {
-			reject(err)
-		}
+		iotaCommonApi.genSignatureTritsAsync(seed, index, security || 2, bundle, (err, signature) => (err ? reject(err) : resolve(signature)))
 	})
 }
 
@@ -117,12 +348,23 @@ const genSignatureTritsFunc = (seed, index, security, bundle) => {
  **/
 const transactionHashFunc = (trytes) => {
 	return new Promise((resolve, reject) => {
-		try {
-			const hash = iotaCommonApi.transactionHash(trytes)
-			resolve(hash)
-		} catch (err) {
-			reject(err)
-		}
+		iotaCommonApi.transactionHashAsync(trytes, (err, hash) => (err ? reject(err) : resolve(hash)))
+	})
+}
+
+/**
+ * Hashes many transactions at once, 64 to 512 per Curl pass depending on the kernel, spread over the native threads
+ * @param {Array<string>|Buffer} trytes - Transactions trytes, or a Buffer of packed 2673 trytes transactions
+ * @param {Object} options - (optional) Options
+ * @param {boolean} options.weights - Resolves with { hashes, weights } instead, weights being a Uint8Array of the
+ * number of trailing zero trits of every hash
+ * @returns {Array<string>} Hashes trytes, in the same order
+ **/
+const transactionHashesFunc = (trytes, options) => {
+	const { weights } = options || {}
+
+	return new Promise((resolve, reject) => {
+		iotaCommonApi.transactionHashesAsync(trytes, !!weights, (err, hashes) => (err ? reject(err) : resolve(hashes)))
 	})
 }
 
@@ -140,22 +382,499 @@ const transactionHashFunc = (trytes) => {
  **/
 const bundleMiner = (bundleNormalizedMax, security, essence, essenceLength, count, nprocs, miningThreshold, fullySecure) => {
 	return new Promise((resolve, reject) => {
-		try {
-			const index = iotaCommonApi.bundleMiner(bundleNormalizedMax, security || 2, essence, essenceLength, count, nprocs || 0, miningThreshold, fullySecure)
-			resolve(index)
-		} catch (err) {
-			reject(err)
+		iotaCommonApi.bundleMinerAsync(bundleNormalizedMax, security || 2, essence, essenceLength, count, nprocs || 0, miningThreshold, fullySecure, (err, index) => (err ? reject(err) : resolve(index)))
+	})
+}
+
+/**
+ * Creates a job ring: transaction hashes and addresses are written into a SharedArrayBuffer and handed over to the
+ * native thread pool once per batch, instead of one native call per job, which pays off at high submission rates.
+ * Jobs submitted in the same tick are kicked together, results are collected once per batch of completions.
+ * @param {Object} options - (optional) Ring options
+ * @param {number} options.slots - Number of jobs in flight, rounded up to a power of two, 64 by default. Jobs
+ * submitted while the ring is full wait in JS.
+ * @returns {Object} { transactionHash(trytes), genAddressTrytes(seed, index, security), close(), buffer }, the
+ * functions returning promises
+ **/
+const createJobRing = (options) => {
+	const layout = iotaCommonApi.jobRingLayout
+	const { slots: requested } = options || {}
+	let slots = 1
+	while (slots < (requested || 64)) {
+		slots *= 2
+	}
+
+	const buffer = new SharedArrayBuffer(layout.headerBytes + slots * layout.slotBytes)
+	const words = new Int32Array(buffer)
+	const bytes = Buffer.from(buffer)
+	const settlers = new Array(slots)
+	const backlog = []
+	let head = 0
+	let reaped = 0
+	let kicking = false
+	let closed = false
+
+	const slotOffset = (index) => layout.headerBytes + (index & (slots - 1)) * layout.slotBytes
+	const inFlight = () => (head - reaped) >>> 0
+
+	const kick = () => {
+		kicking = false
+		if (!closed) {
+			iotaCommonApi.jobRingKick(ring)
+		}
+	}
+
+	const write = (job) => {
+		const offset = slotOffset(head)
+		const length = bytes.write(job.input, offset + layout.input, layout.inputBytes, 'latin1')
+
+		words[(offset + layout.kind) / 4] = job.kind
+		words[(offset + layout.index) / 4] = job.index
+		words[(offset + layout.security) / 4] = job.security
+		words[(offset + layout.inputLength) / 4] = length
+		Atomics.store(words, (offset + layout.state) / 4, 1)
+		settlers[head & (slots - 1)] = job
+		head = (head + 1) >>> 0
+		Atomics.store(words, layout.head, head | 0)
+		if (!kicking) {
+			kicking = true
+			Promise.resolve().then(kick)
+		}
+	}
+
+	const submit = (kind, input, index, security) =>
+		new Promise((resolve, reject) => {
+			if (closed) {
+				reject(new Error('Job ring closed'))
+				return
+			}
+			if (typeof input !== 'string') {
+				reject(new TypeError('Wrong arguments'))
+				return
+			}
+			if (inFlight() === 0 && backlog.length === 0) {
+				iotaCommonApi.jobRingRef(ring, true)
+			}
+
+			const job = { kind, input, index: index | 0, security: security | 0, resolve, reject }
+			if (inFlight() < slots) {
+				write(job)
+			} else {
+				backlog.push(job)
+			}
+		})
+
+	const onComplete = () => {
+		// Cleared before collecting, so that jobs completing meanwhile call back again
+		Atomics.store(words, layout.notify, 0)
+		while (reaped !== head) {
+			const offset = slotOffset(reaped)
+			const state = Atomics.load(words, (offset + layout.state) / 4)
+			if (state < 2) {
+				break
+			}
+
+			const job = settlers[reaped & (slots - 1)]
+			settlers[reaped & (slots - 1)] = undefined
+			if (state === 2) {
+				job.resolve(bytes.toString('latin1', offset + layout.output, offset + layout.output + layout.outputBytes))
+			} else {
+				job.reject(new Error('Job failed'))
+			}
+			Atomics.store(words, (offset + layout.state) / 4, 0)
+			reaped = (reaped + 1) >>> 0
+		}
+		Atomics.notify(words, layout.completed)
+
+		while (backlog.length > 0 && inFlight() < slots) {
+			write(backlog.shift())
+		}
+		if (inFlight() === 0 && !closed) {
+			iotaCommonApi.jobRingRef(ring, false)
+		}
+	}
+
+	const ring = iotaCommonApi.createJobRing(new Uint8Array(buffer), slots, onComplete)
+
+	return {
+		transactionHash: (trytes) => submit(layout.transactionHash, trytes, 0, 0),
+		genAddressTrytes: (seed, index, security) => submit(layout.addressTrytes, seed, index, security || 2),
+		/**
+		 * Rejects the jobs not completed yet and releases the native side
+		 **/
+		close: () => {
+			if (closed) {
+				return
+			}
+			closed = true
+			iotaCommonApi.jobRingClose(ring)
+			const err = new Error('Job ring closed')
+			settlers.forEach((job) => job && job.reject(err))
+			settlers.fill(undefined)
+			backlog.splice(0).forEach((job) => job.reject(err))
+		},
+		buffer
+	}
+}
+
+const TRANSACTION_TRYTES = 2673
+const TRYTE_ALPHABET = '9ABCDEFGHIJKLMNOPQRSTUVWXYZ'
+
+/**
+ * Number of trailing zero trits of a hash, the weight its Proof of Work reached
+ * @param {string} hash - Hash trytes
+ * @returns {number} Weight
+ **/
+const hashWeight = (hash) => {
+	let weight = 0
+	for (let i = hash.length - 1; i >= 0; i--) {
+		const value = TRYTE_ALPHABET.indexOf(hash[i])
+		const magnitude = Math.min(value, 27 - value)
+		if (magnitude !== 0) {
+			// Trits are little endian within a tryte, the top trit is 0 up to 4 and the middle one up to 1
+			return weight + (magnitude <= 1 ? 2 : magnitude <= 4 ? 1 : 0)
+		}
+		weight += 3
+	}
+	return weight
+}
+
+/**
+ * Creates a Transform stream hashing transactions. Written chunks, strings or Buffers, are read as a stream of
+ * trytes split into 2673 trytes transactions; their hashes are read in the same order. Hashing runs on the native
+ * thread pool through a job ring. At most `concurrency` transactions are hashed at once, writes are held back
+ * beyond, so a slow reader stops the writer instead of buffering without bound.
+ * @param {Object} options - (optional) Stream options
+ * @param {number} options.concurrency - Transactions hashed at once, 64 by default
+ * @param {number} options.mwm - (optional) Transactions whose hash weight is below this Min Weight Magnitude are not
+ * read but emitted with an 'invalid' event as (trytes, hash)
+ * @param {number} options.highWaterMark - Hashes buffered for the reader, 16 by default
+ * @returns {Transform} Stream of hashes
+ **/
+const createHashStream = (options) => {
+	const { concurrency, mwm, highWaterMark } = options || {}
+	const limit = Math.max(1, concurrency || 64)
+	const ring = createJobRing({ slots: limit })
+	const pending = []
+	let remainder = ''
+	let waiting = null
+	let flushing = null
+
+	// Reads the hashes in order as they are done, and resumes writing once there is room again
+	const collect = (stream) => {
+		while (pending.length > 0 && pending[0].done && !stream.destroyed) {
+			const { trytes, hash, err } = pending.shift()
+			if (err) {
+				stream.destroy(err)
+				return
+			}
+			if (mwm && hashWeight(hash) < mwm) {
+				stream.emit('invalid', trytes, hash)
+			} else {
+				stream.push(hash)
+			}
+		}
+		if (waiting && pending.length < limit) {
+			const callback = waiting
+			waiting = null
+			callback()
+		}
+		if (flushing && pending.length === 0) {
+			flushing()
+		}
+	}
+
+	const submit = (stream, trytes) => {
+		const entry = { trytes, done: false }
+		pending.push(entry)
+		ring.transactionHash(trytes).then(
+			(hash) => Object.assign(entry, { hash, done: true }),
+			(err) => Object.assign(entry, { err, done: true })
+		).then(() => collect(stream))
+	}
+
+	return new Transform({
+		readableObjectMode: true,
+		readableHighWaterMark: highWaterMark || 16,
+		transform(chunk, encoding, callback) {
+			const trytes = remainder + (typeof chunk === 'string' ? chunk : chunk.toString('latin1'))
+			let offset = 0
+			for (; offset + TRANSACTION_TRYTES <= trytes.length; offset += TRANSACTION_TRYTES) {
+				submit(this, trytes.slice(offset, offset + TRANSACTION_TRYTES))
+			}
+			remainder = trytes.slice(offset)
+			if (pending.length < limit) {
+				callback()
+			} else {
+				waiting = callback
+			}
+		},
+		flush(callback) {
+			flushing = () => {
+				flushing = null
+				ring.close()
+				callback(remainder.length > 0 ? new Error('Incomplete transaction trytes at the end of the stream') : null)
+			}
+			if (pending.length === 0) {
+				flushing()
+			}
+		},
+		destroy(err, callback) {
+			ring.close()
+			callback(err)
 		}
 	})
 }
 
+/**
+ * Scheduler statistics. Every async function runs on a single native thread pool whose queues are served in
+ * priority order: signing, address generation and hashing are 'interactive', Proof of Work is 'normal' unless
+ * options.priority says otherwise and bundle mining is 'bulk'. A call is rejected with an EBUSY error when its queue
+ * already holds its capacity of waiting jobs.
+ * @returns {Object} { threads, running, queues: { interactive, normal, bulk } }, each queue being
+ * { queued, capacity, admitted, rejected }
+ **/
+const schedulerStats = () => iotaCommonApi.schedulerStats()
+
+/**
+ * Sets the number of jobs that may wait in a scheduler queue
+ * @param {string} priority - 'interactive', 'normal' or 'bulk'
+ * @param {number} capacity - Maximum number of waiting jobs
+ **/
+const setQueueCapacity = (priority, capacity) => iotaCommonApi.setQueueCapacity(priority, capacity)
+
+let powDefaults = {}
+
+/**
+ * Sets the Proof of Work options applying to jobs that do not set them, process-wide. Jobs with CPUs or a nice
+ * increment run on a dedicated pool of threads, one per CPU of the set or per core, pinned and niced once when
+ * started, so that the threads handling other requests keep running where they are. Pinning and nice levels are
+ * only applied on Linux. Identical jobs in flight share the search of the first one, and its options.
+ * @param {Object} defaults - Options
+ * @param {number} defaults.threads - Maximum number of threads searching at once per job, 0 for all of its pool
+ * @param {Array<number>} defaults.cpus - CPUs Proof of Work is confined to, empty for all of them
+ * @param {number} defaults.nice - Added to the nice level of the process, as with nice -n. Negative values need
+ * privileges.
+ **/
+const setPowDefaults = (defaults) => {
+	iotaCommonApi.setPowDefaults(defaults || {})
+	powDefaults = Object.assign({}, defaults)
+}
+
+/**
+ * Statistics of the midstate cache. Attaching a transaction only changes its last three Curl blocks, from the trunk
+ * on, so the Curl state after the others is cached: reattaching a bundle to another trunk and branch, with
+ * powBundleFunc, powBundlesFunc or powTrytesFunc, then absorbs 3 blocks per transaction instead of 33.
+ * @returns {Object} { entries, capacity, hits, misses }
+ **/
+const midstateCacheStats = () => iotaCommonApi.midstateCacheStats()
+
+/**
+ * Sets the number of transactions whose midstate is cached, about 3 KB each, 1024 by default. 0 disables the cache.
+ * @param {number} capacity - Maximum number of cached midstates
+ **/
+const setMidstateCacheCapacity = (capacity) => iotaCommonApi.setMidstateCacheCapacity(capacity)
+
+const CALIBRATION_FILE = process.env.ENTANGLED_CALIBRATION_FILE || path.join(os.homedir(), '.entangled-node', 'calibration.json')
+let calibrationResult = null
+
+/**
+ * Describes the machine a calibration was measured on, a calibration file being ignored on any other
+ * @returns {Object} { cpu, cores, version }
+ **/
+const calibrationHost = () => {
+	const cpus = os.cpus()
+	return { cpu: cpus.length > 0 ? cpus[0].model : 'unknown', cores: cpus.length, version }
+}
+
+/**
+ * Selects the kernel and thread count of a calibration for every Proof of Work from now on
+ * @param {Object} result - Calibration result
+ **/
+const applyCalibration = (result) => {
+	iotaCommonApi.setPowKernel(result.kernel)
+	if (powDefaults.threads === undefined) {
+		iotaCommonApi.setPowDefaults(Object.assign({}, powDefaults, { threads: result.threads }))
+	}
+	calibrationResult = result
+}
+
+/**
+ * Benchmarks every Proof of Work kernel supported by the CPU with several thread counts, selects the fastest
+ * configuration and persists it, so that it is applied again whenever the module is loaded on this machine. Thread
+ * counts set with setPowDefaults take precedence over the calibrated one.
+ * @param {Object} options - (optional) Calibration options
+ * @param {number} options.duration - Milliseconds to spend benchmarking, 3000 by default
+ * @param {string} options.file - Where to persist the result, ~/.entangled-node/calibration.json by default or the
+ * ENTANGLED_CALIBRATION_FILE environment variable
+ * @param {boolean} options.save - Whether to persist the result, true by default
+ * @returns {Promise<Object>} { kernel, threads, hashrate, results }, hashrate being in nonces per second and results
+ * listing every configuration measured
+ **/
+const calibrate = async (options) => {
+	const { duration, file, save } = options || {}
+	const { threads: poolThreads } = iotaCommonApi.schedulerStats()
+	const threadCounts = []
+	for (let threads = 1; threads < poolThreads; threads *= 2) {
+		threadCounts.push(threads)
+	}
+	threadCounts.push(poolThreads)
+
+	const configurations = []
+	iotaCommonApi.powKernels().supported.forEach((kernel) => threadCounts.forEach((threads) => configurations.push({ kernel, threads })))
+
+	const slice = Math.max(100, (duration || 3000) / configurations.length)
+	const results = []
+	for (const { kernel, threads } of configurations) {
+		const { attempts, elapsed } = await new Promise((resolve, reject) =>
+			iotaCommonApi.powBenchmarkAsync(kernel, threads, slice, (err, measure) => (err ? reject(err) : resolve(measure)))
+		)
+		results.push({ kernel, threads, hashrate: elapsed > 0 ? (attempts * 1000) / elapsed : 0 })
+	}
+
+	// Fewer threads win ties within 2%, leaving cores to the rest of the process
+	const best = results.reduce((best, result) => (result.hashrate > best.hashrate * 1.02 ? result : best))
+	const result = Object.assign({ date: new Date().toISOString() }, calibrationHost(), best, { results })
+	if (save !== false) {
+		const target = file || CALIBRATION_FILE
+		fs.mkdirSync(path.dirname(target), { recursive: true })
+		fs.writeFileSync(target, JSON.stringify(result, null, 2))
+	}
+	applyCalibration(result)
+	return result
+}
+
+/**
+ * Returns the calibration in effect, measured by calibrate() or loaded from its file, or null
+ * @returns {Object} See calibrate
+ **/
+const calibration = () => calibrationResult
+
+/**
+ * Estimates the time Proof of Work takes with the calibrated configuration: on average 3^mwm nonces are tried per
+ * transaction
+ * @param {number} mwm - Min Weight Magnitude
+ * @param {number} transactions - (optional) Number of transactions, 1 by default
+ * @returns {number} Expected milliseconds, or NaN without calibration
+ **/
+const estimatePowTime = (mwm, transactions) => {
+	if (!calibrationResult || !(calibrationResult.hashrate > 0)) {
+		return NaN
+	}
+	return ((transactions || 1) * Math.pow(3, mwm) * 1000) / calibrationResult.hashrate
+}
+
+/**
+ * Proof of Work kernels, by lane width: 'ptrit64', 'sse2', 'avx2' and 'avx512'. The widest one supported by the CPU
+ * is selected when the module is loaded, unless a calibration or the ENTANGLED_POW_KERNEL environment variable says
+ * otherwise.
+ * @returns {Object} { supported, selected }
+ **/
+const powKernels = () => iotaCommonApi.powKernels()
+
+/**
+ * Forces the kernel of the Proof of Work searches started from now on, process-wide, for instance to benchmark it
+ * @param {string} kernel - One of powKernels().supported, an EINVAL error is thrown otherwise
+ **/
+const setPowKernel = (kernel) => iotaCommonApi.setPowKernel(kernel)
+
+/**
+ * Sets where Proof of Work runs from now on, process-wide. Transaction and bundle requests can be sent to an
+ * entangled_pow_worker process listening on a Unix socket, other requests keep running in process.
+ * @param {Object} [options] - Worker settings, Proof of Work running in process if omitted
+ * @param {string} options.socket - Path of the worker socket
+ * @param {number} options.retries - Retries of a request whose worker cannot be reached, 2 by default
+ * @param {number} options.retryDelay - Milliseconds before the first retry, growing with the next ones, 100 by default
+ * @param {boolean} options.fallback - Runs requests whose worker cannot be reached in process, true by default.
+ * Otherwise they reject with an ECONNREFUSED error.
+ **/
+const setPowBackend = (options) => iotaCommonApi.setPowBackend(options)
+
+// A calibration file from another machine, release or build is ignored
+try {
+	const saved = JSON.parse(fs.readFileSync(CALIBRATION_FILE, 'utf8'))
+	const host = calibrationHost()
+	if (saved.cpu === host.cpu && saved.cores === host.cores && saved.version === host.version && iotaCommonApi.powKernels().supported.includes(saved.kernel)) {
+		applyCalibration(saved)
+	}
+} catch (err) {
+	// Not calibrated
+}
+if (process.env.ENTANGLED_POW_KERNEL) {
+	setPowKernel(process.env.ENTANGLED_POW_KERNEL)
+}
+if (process.env.ENTANGLED_POW_SOCKET) {
+	setPowBackend({ socket: process.env.ENTANGLED_POW_SOCKET })
+}
+
+/**
+ * Synchronous variants of the functions above. They block the event loop until the native computation returns,
+ * which is only desirable in scripts and worker threads. Proof of Work still runs on the native thread pool.
+ **/
+
+const powTrytesSync = (trytes, mwm) => iotaCommonApi.powTrytes(trytes, mwm || 14)
+
+const powBundleSync = (trytes, trunk, branch, mwm) => iotaCommonApi.powBundle(trytes, trunk, branch, mwm || 14)
+
+const genAddressTrytesSync = (seed, index, security) => iotaCommonApi.genAddressTrytes(seed, index, security || 2)
+
+const genAddressTritsSync = (seed, index, security) => iotaCommonApi.genAddressTrits(seed, index, security || 2)
+
+const genSignatureTrytesSync = (seed, index, security, bundle) => iotaCommonApi.genSignatureTrytes(seed, index, security || 2, bundle)
+
+const genSignatureTritsSync = (seed, index, security, bundle) => iotaCommonApi.genSignatureTrits(seed, index, security || 2, bundle)
+
+const transactionHashSync = (trytes) => iotaCommonApi.transactionHash(trytes)
+
+/**
+ * Streaming Kerl and Curl-P-81 hashers. Their sponge stays in native memory between calls:
+ * - absorb(input) absorbs trytes, as a string or a Buffer, or trits, as an Array or an Int8Array, a multiple of 243
+ * trits long, and returns the hasher
+ * - squeeze(length) squeezes length trits, 243 by default, and squeezeTrytes(length) length trytes, 81 by default
+ * - reset() empties the sponge and returns the hasher
+ * - clone() returns a new hasher with a copy of the sponge, to absorb different data after a common prefix
+ **/
+const { Kerl, CurlP81 } = iotaCommonApi
+
+const bundleMinerSync = (bundleNormalizedMax, security, essence, essenceLength, count, nprocs, miningThreshold, fullySecure) =>
+	iotaCommonApi.bundleMiner(bundleNormalizedMax, security || 2, essence, essenceLength, count, nprocs || 0, miningThreshold, fullySecure)
+
 module.exports = {
 	powTrytesFunc,
+	powTrytesBatchFunc,
 	powBundleFunc,
+	powBundlesFunc,
+	hashcashFunc,
 	genAddressTrytesFunc,
 	genAddressTritsFunc,
+	genAddressRange,
+	genAddressBatchFunc,
 	genSignatureTrytesFunc,
 	genSignatureTritsFunc,
 	transactionHashFunc,
-	bundleMiner
+	transactionHashesFunc,
+	bundleMiner,
+	powTrytesSync,
+	powBundleSync,
+	genAddressTrytesSync,
+	genAddressTritsSync,
+	genSignatureTrytesSync,
+	genSignatureTritsSync,
+	transactionHashSync,
+	bundleMinerSync,
+	createJobRing,
+	createHashStream,
+	Kerl,
+	CurlP81,
+	schedulerStats,
+	setQueueCapacity,
+	setPowDefaults,
+	calibrate,
+	calibration,
+	estimatePowTime,
+	powKernels,
+	setPowKernel,
+	setPowBackend,
+	midstateCacheStats,
+	setMidstateCacheCapacity
 }
@@ -1,331 +1,2788 @@
-#include <nan.h>
-#include <iostream>
+#include <node_api.h>
+#include <string.h>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <vector>
 
 #include "common/helpers/digest.h"
-#include "common/helpers/pow.h"
-#include "common/helpers/sign.h"
+#include "pow/benchmark.h"
+#include "pow/curl.h"
+#include "pow/hash_batch.h"
+#include "pow/hashcash.h"
+#include "pow/midstate.h"
+#include "pow/socket_backend.h"
+#include "pow/transaction.h"
+#include "ring/job_ring.h"
+#include "scheduler/scheduler.h"
+#include "sign/address_range.h"
+#include "sign/iss.h"
+#include "sign/kerl.h"
 #include "utils/bundle_miner.h"
 #include "utils/memset_safe.h"
 
-static NAN_METHOD(powTrytes) {
-  if (info.Length() < 2) {
-    Nan::ThrowError("Wrong number of arguments");
-    return;
+#define EXPORT(name) \
+  { #name, NULL, name, NULL, NULL, NULL, napi_enumerable, NULL }
+
+#define METHOD(name, method, data) \
+  { name, NULL, method, NULL, NULL, NULL, napi_default, data }
+
+/*
+ * Argument marshalling shared by the synchronous methods and the async workers. Everything is copied out of JS on
+ * the main thread so that workers never touch JS values.
+ */
+
+template <size_t N>
+static size_t getArgs(napi_env env, napi_callback_info info, napi_value (&argv)[N]) {
+  size_t argc = N;
+
+  // Missing arguments are set to undefined
+  napi_get_cb_info(env, info, &argc, argv, NULL, NULL);
+  return argc;
+}
+
+static bool isType(napi_env env, napi_value value, napi_valuetype type) {
+  napi_valuetype actual;
+  return napi_typeof(env, value, &actual) == napi_ok && actual == type;
+}
+
+static bool isArray(napi_env env, napi_value value) {
+  bool result = false;
+  napi_is_array(env, value, &result);
+  return result;
+}
+
+static napi_value getProperty(napi_env env, napi_value object, char const *name) {
+  napi_value value;
+  napi_get_named_property(env, object, name, &value);
+  return value;
+}
+
+static uint32_t arrayLength(napi_env env, napi_value array) {
+  uint32_t length = 0;
+  napi_get_array_length(env, array, &length);
+  return length;
+}
+
+static std::string readString(napi_env env, napi_value value) {
+  size_t length = 0;
+
+  napi_get_value_string_utf8(env, value, NULL, 0, &length);
+  std::vector<char> buffer(length + 1);
+  napi_get_value_string_utf8(env, value, buffer.data(), buffer.size(), &length);
+  return std::string(buffer.data(), length);
+}
+
+static uint32_t readUint32(napi_env env, napi_value value) {
+  uint32_t result = 0;
+  napi_get_value_uint32(env, value, &result);
+  return result;
+}
+
+static double readDouble(napi_env env, napi_value value) {
+  double result = 0;
+  napi_get_value_double(env, value, &result);
+  return result;
+}
+
+template <typename T>
+static void readInts(napi_env env, napi_value array, T *values, size_t length) {
+  uint32_t count = static_cast<uint32_t>(std::min<size_t>(arrayLength(env, array), length));
+
+  for (uint32_t i = 0; i < count; i++) {
+    napi_value element;
+    int32_t value = 0;
+    napi_get_element(env, array, i, &element);
+    napi_get_value_int32(env, element, &value);
+    values[i] = static_cast<T>(value);
+  }
+}
+
+static void readTrits(napi_env env, napi_value array, trit_t *trits, size_t length) {
+  readInts(env, array, trits, length);
+}
+
+static void readStrings(napi_env env, napi_value array, std::vector<std::string> &strings) {
+  uint32_t length = arrayLength(env, array);
+
+  strings.reserve(length);
+  for (uint32_t i = 0; i < length; i++) {
+    napi_value element;
+    napi_get_element(env, array, i, &element);
+    strings.push_back(readString(env, element));
+  }
+}
+
+static napi_value newString(napi_env env, char const *value, size_t length = NAPI_AUTO_LENGTH) {
+  napi_value result;
+  napi_create_string_utf8(env, value, length, &result);
+  return result;
+}
+
+static napi_value newString(napi_env env, std::string const &value) {
+  return newString(env, value.data(), value.size());
+}
+
+static napi_value newNumber(napi_env env, double value) {
+  napi_value result;
+  napi_create_double(env, value, &result);
+  return result;
+}
+
+static napi_value newTritsArray(napi_env env, trit_t const *trits, size_t length) {
+  napi_value ret;
+
+  napi_create_array_with_length(env, length, &ret);
+  for (size_t i = 0; i < length; i++) {
+    napi_value trit;
+    napi_create_int32(env, trits[i], &trit);
+    napi_set_element(env, ret, i, trit);
+  }
+  return ret;
+}
+
+static napi_value newStringsArray(napi_env env, std::vector<std::string> const &strings) {
+  napi_value ret;
+
+  napi_create_array_with_length(env, strings.size(), &ret);
+  for (size_t i = 0; i < strings.size(); i++) {
+    napi_set_element(env, ret, i, newString(env, strings[i]));
+  }
+  return ret;
+}
+
+static napi_value newError(napi_env env, char const *code, char const *message) {
+  napi_value error;
+
+  napi_create_error(env, code == NULL ? NULL : newString(env, code), newString(env, message), &error);
+  return error;
+}
+
+static napi_value throwError(napi_env env, char const *message, char const *code = NULL) {
+  napi_throw_error(env, code, message);
+  return NULL;
+}
+
+static void scrubString(std::string &value) {
+  if (!value.empty()) {
+    memset_safe((void *)value.data(), value.size(), 0, value.size());
+  }
+}
+
+static char const kInvalidSeedMessage[] = "Invalid seed, bundle hash or security level";
+
+/*
+ * Per instance state. The addon is context-aware: every worker_threads isolate loading it gets its own job table,
+ * while the scheduler and the Proof of Work flights stay process-wide.
+ */
+
+class PowWorker;
+
+struct Instance {
+  std::map<uint32_t, PowWorker *> powJobs;
+  uint32_t powNextJobId;
+  napi_ref kerlConstructor;
+  napi_ref curlConstructor;
+};
+
+static std::shared_ptr<Instance> getInstance(napi_env env) {
+  void *data = NULL;
+
+  napi_get_instance_data(env, &data);
+  return *static_cast<std::shared_ptr<Instance> *>(data);
+}
+
+/*
+ * Scheduler glue. Workers run on the process-wide scheduler rather than on the libuv pool, and only their
+ * completion is posted back to the JS thread of the instance that queued them, through a thread-safe function.
+ */
+
+static napi_value throwBusy(napi_env env, entangled::priority_t priority) {
+  std::string message = std::string("Scheduler queue is full: ") + entangled::priorityName(priority);
+  return throwError(env, message.c_str(), "EBUSY");
+}
+
+/**
+ * Thread-safe function posting results to the JS thread. Node deletes it as soon as the instance is torn down, so
+ * scheduler threads only reach it through this wrapper, which then drops their results.
+ */
+class Completion {
+ public:
+  /**
+   * @param callback JS function passed to call
+   * @param name Async resource name
+   * @param calls Number of results to post, the thread-safe function is released after the last one. With 0 it is
+   * only released by abandon().
+   * @param context Passed to call and finalize
+   * @param finalize Called on the JS thread once every result was handled or the instance is torn down, or NULL
+   * @param call Called on the JS thread with each result, or with a NULL env to free it on tear down
+   */
+  static std::shared_ptr<Completion> create(napi_env env, napi_value callback, char const *name, size_t calls,
+                                            void *context, napi_finalize finalize,
+                                            napi_threadsafe_function_call_js call) {
+    std::shared_ptr<Completion> completion(new Completion(calls, context, finalize));
+    std::shared_ptr<Completion> *holder = new std::shared_ptr<Completion>(completion);
+
+    if (napi_create_threadsafe_function(env, callback, NULL, newString(env, name), 0, 1, holder, onFinalize, context,
+                                        call, &completion->function_) != napi_ok) {
+      delete holder;
+      return NULL;
+    }
+    return completion;
+  }
+
+  /**
+   * Posts a result, from any thread
+   *
+   * @return false if the instance is torn down, the caller still owns data then
+   */
+  bool post(void *data) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (function_ == NULL) {
+      return false;
+    }
+    napi_status status = napi_call_threadsafe_function(function_, data, napi_tsfn_nonblocking);
+    if (status == napi_closing) {
+      // The thread-safe function no longer counts this thread
+      function_ = NULL;
+      return false;
+    }
+    if (calls_ > 0 && --calls_ == 0) {
+      release();
+    }
+    return status == napi_ok;
+  }
+
+  /**
+   * Sets whether the pending results keep the event loop alive, from the JS thread
+   */
+  void ref(napi_env env, bool ref) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (function_ != NULL) {
+      ref ? napi_ref_threadsafe_function(env, function_) : napi_unref_threadsafe_function(env, function_);
+    }
+  }
+
+  /**
+   * Gives up the results not posted yet
+   */
+  void abandon() {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (function_ != NULL) {
+      release();
+    }
+  }
+
+ private:
+  Completion(size_t calls, void *context, napi_finalize finalize)
+      : function_(NULL), calls_(calls), context_(context), finalize_(finalize) {}
+
+  static void onFinalize(napi_env env, void *data, void *hint) {
+    std::shared_ptr<Completion> *holder = static_cast<std::shared_ptr<Completion> *>(data);
+    std::shared_ptr<Completion> completion = *holder;
+
+    delete holder;
+    {
+      std::lock_guard<std::mutex> lock(completion->mutex_);
+      completion->function_ = NULL;
+    }
+    if (completion->finalize_ != NULL) {
+      completion->finalize_(env, completion->context_, NULL);
+    }
+  }
+
+  // Called with mutex_ held
+  void release() {
+    napi_release_threadsafe_function(function_, napi_tsfn_release);
+    function_ = NULL;
+  }
+
+  std::mutex mutex_;
+  napi_threadsafe_function function_;
+  size_t calls_;
+  void *context_;
+  napi_finalize finalize_;
+};
+
+/**
+ * Native computation run on the scheduler, whose result is passed to a node-style callback
+ */
+class Worker {
+ public:
+  Worker() : errorCode_(NULL) {}
+
+  virtual ~Worker() {}
+
+  /**
+   * Runs on a scheduler thread
+   */
+  virtual void Execute() = 0;
+
+  /**
+   * Returns the result on the JS thread, once Execute() succeeded
+   */
+  virtual napi_value Result(napi_env env) = 0;
+
+  /**
+   * Calls back on the JS thread, then deletes the worker. Only deletes it if the instance is being torn down.
+   */
+  static void Complete(napi_env env, napi_value callback, void *context, void *data) {
+    Worker *worker = static_cast<Worker *>(data);
+
+    if (env != NULL) {
+      napi_value undefined, argv[2];
+      size_t argc = 1;
+
+      napi_get_undefined(env, &undefined);
+      if (!worker->errorMessage_.empty()) {
+        argv[0] = newError(env, worker->errorCode_, worker->errorMessage_.c_str());
+      } else {
+        napi_get_null(env, &argv[0]);
+        argv[1] = worker->Result(env);
+        argc = 2;
+      }
+      napi_call_function(env, undefined, callback, argc, argv, NULL);
+    }
+    delete worker;
+  }
+
+ protected:
+  void SetErrorMessage(char const *message, char const *code = NULL) {
+    errorMessage_ = message;
+    errorCode_ = code;
+  }
+
+ private:
+  std::string errorMessage_;
+  char const *errorCode_;
+};
+
+/**
+ * Runs worker->Execute() on the scheduler, then completes it on the JS thread. Throws an EBUSY error and deletes
+ * the worker if the queue is full.
+ */
+static bool queueWorker(napi_env env, Worker *worker, napi_value callback, char const *name,
+                        entangled::priority_t priority) {
+  std::shared_ptr<Completion> completion = Completion::create(env, callback, name, 1, NULL, NULL, Worker::Complete);
+
+  if (completion == NULL) {
+    delete worker;
+    throwError(env, "Could not create the completion callback");
+    return false;
+  }
+
+  if (!entangled::Scheduler::instance().submit(priority, [worker, completion] {
+        worker->Execute();
+        if (!completion->post(worker)) {
+          delete worker;
+        }
+      })) {
+    completion->abandon();
+    delete worker;
+    throwBusy(env, priority);
+    return false;
+  }
+  return true;
+}
+
+static napi_value schedulerStats(napi_env env, napi_callback_info info) {
+  entangled::scheduler_stats_t stats = entangled::Scheduler::instance().stats();
+  napi_value ret, queues;
+
+  napi_create_object(env, &ret);
+  napi_create_object(env, &queues);
+  for (int i = 0; i < entangled::PRIORITY_COUNT; i++) {
+    napi_value queue;
+    napi_create_object(env, &queue);
+    napi_set_named_property(env, queue, "queued", newNumber(env, stats.queued[i]));
+    napi_set_named_property(env, queue, "capacity", newNumber(env, stats.capacity[i]));
+    napi_set_named_property(env, queue, "admitted", newNumber(env, stats.admitted[i]));
+    napi_set_named_property(env, queue, "rejected", newNumber(env, stats.rejected[i]));
+    napi_set_named_property(env, queues, entangled::priorityName(static_cast<entangled::priority_t>(i)), queue);
+  }
+
+  napi_set_named_property(env, ret, "threads", newNumber(env, stats.threads));
+  napi_set_named_property(env, ret, "running", newNumber(env, stats.running));
+  napi_set_named_property(env, ret, "queues", queues);
+  return ret;
+}
+
+static napi_value setQueueCapacity(napi_env env, napi_callback_info info) {
+  napi_value argv[2];
+  entangled::priority_t priority;
+
+  getArgs(env, info, argv);
+  if (!isType(env, argv[0], napi_string) || !isType(env, argv[1], napi_number)) {
+    return throwError(env, "Wrong arguments");
+  }
+
+  if (!entangled::priorityFromName(readString(env, argv[0]).c_str(), priority)) {
+    return throwError(env, "Unknown priority");
+  }
+
+  entangled::Scheduler::instance().setCapacity(priority, readUint32(env, argv[1]));
+  return NULL;
+}
+
+/**
+ * Reads the threads, cpus and nice properties of an options object, leaving missing ones untouched
+ *
+ * @return false if an exception is pending
+ */
+static bool parsePowSettings(napi_env env, napi_value value, entangled::pow_settings_t &settings) {
+  napi_value threads = getProperty(env, value, "threads");
+  napi_value cpus = getProperty(env, value, "cpus");
+  napi_value nice = getProperty(env, value, "nice");
+
+  if (isType(env, threads, napi_number)) {
+    settings.threads = readUint32(env, threads);
+  }
+  if (isArray(env, cpus)) {
+    settings.placement.cpus.resize(arrayLength(env, cpus));
+    readInts(env, cpus, settings.placement.cpus.data(), settings.placement.cpus.size());
+    std::sort(settings.placement.cpus.begin(), settings.placement.cpus.end());
+    settings.placement.cpus.erase(std::unique(settings.placement.cpus.begin(), settings.placement.cpus.end()),
+                                  settings.placement.cpus.end());
+  }
+  if (isType(env, nice, napi_number)) {
+    settings.placement.nice = static_cast<int>(readDouble(env, nice));
+  }
+
+  char const *error = entangled::placementError(settings.placement);
+  if (error != NULL) {
+    throwError(env, error, "EINVAL");
+    return false;
+  }
+  return true;
+}
+
+static napi_value setPowDefaults(napi_env env, napi_callback_info info) {
+  napi_value argv[1];
+  entangled::pow_settings_t settings = {0, entangled::Placement()};
+
+  getArgs(env, info, argv);
+  if (!isType(env, argv[0], napi_object)) {
+    return throwError(env, "Wrong arguments");
+  }
+
+  if (!parsePowSettings(env, argv[0], settings)) {
+    return NULL;
+  }
+  entangled::setPowDefaults(settings);
+  return NULL;
+}
+
+static napi_value midstateCacheStats(napi_env env, napi_callback_info info) {
+  entangled::midstate_cache_stats_t stats = entangled::MidstateCache::instance().stats();
+  napi_value ret;
+
+  napi_create_object(env, &ret);
+  napi_set_named_property(env, ret, "entries", newNumber(env, static_cast<double>(stats.entries)));
+  napi_set_named_property(env, ret, "capacity", newNumber(env, static_cast<double>(stats.capacity)));
+  napi_set_named_property(env, ret, "hits", newNumber(env, static_cast<double>(stats.hits)));
+  napi_set_named_property(env, ret, "misses", newNumber(env, static_cast<double>(stats.misses)));
+  return ret;
+}
+
+static napi_value setMidstateCacheCapacity(napi_env env, napi_callback_info info) {
+  napi_value argv[1];
+
+  getArgs(env, info, argv);
+  if (!isType(env, argv[0], napi_number)) {
+    return throwError(env, "Wrong arguments");
+  }
+
+  entangled::MidstateCache::instance().setCapacity(readUint32(env, argv[0]));
+  return NULL;
+}
+
+/*
+ * Proof of Work jobs. Every async search is registered under an id so that JS can cancel it and sample its
+ * progress.
+ */
+
+struct PowOptions {
+  uint64_t timeoutMs;
+  entangled::priority_t priority;
+  entangled::pow_settings_t settings;
+};
+
+static char const *powStatusCode(entangled::pow_status_t status) {
+  switch (status) {
+    case entangled::POW_CANCELLED:
+      return "ABORT_ERR";
+    case entangled::POW_TIMED_OUT:
+      return "ETIMEDOUT";
+    case entangled::POW_INVALID_INPUT:
+      return "EINVAL";
+    case entangled::POW_REJECTED:
+      return "EBUSY";
+    case entangled::POW_EXHAUSTED:
+      return "ERANGE";
+    case entangled::POW_UNAVAILABLE:
+      return "ECONNREFUSED";
+    default:
+      return "EPOW";
+  }
+}
+
+static napi_value newPowError(napi_env env, entangled::pow_status_t status) {
+  return newError(env, powStatusCode(status), entangled::powStatusMessage(status));
+}
+
+static bool parsePowOptions(napi_env env, napi_value value, PowOptions &options) {
+  options.timeoutMs = 0;
+  options.priority = entangled::PRIORITY_NORMAL;
+  options.settings = entangled::powDefaults();
+
+  if (isType(env, value, napi_undefined) || isType(env, value, napi_null)) {
+    return true;
+  }
+  if (!isType(env, value, napi_object)) {
+    throwError(env, "Wrong arguments");
+    return false;
+  }
+
+  napi_value timeout = getProperty(env, value, "timeout");
+  napi_value priority = getProperty(env, value, "priority");
+
+  if (isType(env, priority, napi_string) &&
+      !entangled::priorityFromName(readString(env, priority).c_str(), options.priority)) {
+    throwError(env, "Unknown priority");
+    return false;
+  }
+  if (isType(env, timeout, napi_number)) {
+    options.timeoutMs = static_cast<uint64_t>(std::max(1.0, readDouble(env, timeout)));
+  }
+  return parsePowSettings(env, value, options.settings);
+}
+
+/**
+ * Runs one or more PowTasks on the current backend, by default as sliced jobs on the scheduler, each of them joining
+ * an identical request in flight if any. Results are posted back to the JS thread as each request is done. Once
+ * started, the worker is owned by its completion, which deletes it once every request reported.
+ */
+class PowWorker {
+ public:
+  PowWorker(napi_env env, PowOptions const &options)
+      : instance_(getInstance(env)),
+        options_(options),
+        control_(std::make_shared<entangled::Control>()),
+        completion_(NULL),
+        onResult_(NULL),
+        remaining_(0),
+        status_(entangled::POW_FOUND) {
+    if (options_.timeoutMs > 0) {
+      control_->setTimeout(options_.timeoutMs);
+    }
+    id_ = instance_->powNextJobId++;
+    instance_->powJobs[id_] = this;
+  }
+
+  // Also runs when the instance is torn down before the job is done, nobody can wait for its result anymore then
+  virtual ~PowWorker() {
+    control_->cancel();
+    instance_->powJobs.erase(id_);
+  }
+
+  uint32_t id() const { return id_; }
+
+  void Cancel() { control_->cancel(); }
+
+  /**
+   * Returns the attempts of every request of the job so far
+   */
+  double Attempts() const {
+    double attempts = 0;
+
+    for (auto const &request : requests_) {
+      if (request.progress) {
+        attempts += static_cast<double>(request.progress->attempts());
+      }
+    }
+    return attempts;
+  }
+
+  double ElapsedMs() const { return control_->elapsedMs(); }
+
+  /**
+   * Adds a request to the job, before Start()
+   */
+  void Add(std::string const &key, std::shared_ptr<entangled::PowTask> task) {
+    requests_.push_back({key, task, NULL, NULL});
+  }
+
+  /**
+   * Joins or submits every request, sharing the pool threads between them. Throws an EBUSY error if the queue is
+   * full for a single request; in a batch, rejected requests fail on their own.
+   *
+   * @param callback Node-style callback called once every request is done. A single request job passes it the
+   * statistics of the request after its result, see Stats().
+   * @param onResult (index, err, result) callback called as each request is done, or NULL. The final callback then
+   * gets no result and only fails if the job could not start.
+   * @param name Async resource name
+   *
+   * @return false if an exception is pending, the worker being deleted
+   */
+  bool Start(napi_env env, napi_value callback, napi_value onResult, char const *name) {
+    entangled::Scheduler *scheduler = entangled::Scheduler::pool(options_.settings.placement);
+
+    if (scheduler == NULL) {
+      onFinalize(env, this, NULL);
+      throwError(env, "Too many Proof of Work thread pools", "EBUSY");
+      return false;
+    }
+
+    size_t threads = scheduler->threads();
+    if (options_.settings.threads > 0) {
+      threads = std::min(threads, options_.settings.threads);
+    }
+    size_t slots = std::max<size_t>(1, (threads + requests_.size() - 1) / std::max<size_t>(1, requests_.size()));
+    std::shared_ptr<entangled::PowBackend> backend = entangled::powBackend();
+
+    if (onResult != NULL) {
+      napi_create_reference(env, onResult, 1, &onResult_);
+    }
+    completion_ = Completion::create(env, callback, name, requests_.size(), this, onFinalize, onDone);
+    if (completion_ == NULL) {
+      onFinalize(env, this, NULL);
+      throwError(env, "Could not create the completion callback");
+      return false;
+    }
+    remaining_ = requests_.size();
+
+    for (size_t i = 0; i < requests_.size(); i++) {
+      // Requests may outlive the worker if the instance is torn down, so they only hold the completion
+      std::shared_ptr<Completion> completion = completion_;
+      auto done = [completion, i](entangled::pow_status_t status, std::shared_ptr<entangled::PowTask> task) {
+        Done *result = new Done{i, status, task};
+
+        if (!completion->post(result)) {
+          delete result;
+        }
+      };
+
+      if (!backend->submit({requests_[i].key, requests_[i].task, control_, scheduler, options_.priority, slots}, done,
+                           requests_[i].progress)) {
+        if (requests_.size() == 1) {
+          completion_->abandon();
+          throwBusy(env, options_.priority);
+          return false;
+        }
+        done(entangled::POW_REJECTED, requests_[i].task);
+      }
+    }
+    return true;
+  }
+
+ protected:
+  /**
+   * Returns the result of a request on the JS thread, once it succeeded
+   */
+  virtual napi_value Result(napi_env env, size_t index) = 0;
+
+  /**
+   * Returns the number of trailing zero trits the Proof of Work of a request achieved once it succeeded, or -1 if
+   * it is not tracked
+   */
+  virtual int Weight(size_t index) {
+    (void)index;
+    return -1;
+  }
+
+  /**
+   * Returns the task holding the result of a request, shared by its flight when it ran in process
+   */
+  std::shared_ptr<entangled::PowTask> task(size_t index) const { return requests_[index].result; }
+
+ private:
+  struct Request {
+    std::string key;
+    std::shared_ptr<entangled::PowTask> task;
+    // Attempts of the request while it runs, and the task holding its result once done
+    std::shared_ptr<entangled::Control> progress;
+    std::shared_ptr<entangled::PowTask> result;
+  };
+
+  struct Done {
+    size_t index;
+    entangled::pow_status_t status;
+    std::shared_ptr<entangled::PowTask> task;
+  };
+
+  static void onDone(napi_env env, napi_value callback, void *context, void *data) {
+    std::unique_ptr<Done> done(static_cast<Done *>(data));
+
+    if (env != NULL) {
+      PowWorker *worker = static_cast<PowWorker *>(context);
+      worker->requests_[done->index].result = done->task;
+      worker->HandleResult(env, callback, done->index, done->status);
+    }
+  }
+
+  static void onFinalize(napi_env env, void *data, void *hint) {
+    PowWorker *worker = static_cast<PowWorker *>(data);
+
+    if (worker->onResult_ != NULL) {
+      napi_delete_reference(env, worker->onResult_);
+    }
+    delete worker;
+  }
+
+  void HandleResult(napi_env env, napi_value callback, size_t index, entangled::pow_status_t status) {
+    napi_value undefined, argv[3];
+    size_t argc = 1;
+
+    napi_get_undefined(env, &undefined);
+    if (onResult_ != NULL) {
+      // Every request succeeds or fails on its own
+      napi_value onResult;
+      napi_get_reference_value(env, onResult_, &onResult);
+      napi_create_uint32(env, static_cast<uint32_t>(index), &argv[0]);
+      napi_get_null(env, &argv[1]);
+      napi_get_null(env, &argv[2]);
+      if (status == entangled::POW_FOUND) {
+        argv[2] = Result(env, index);
+      } else {
+        argv[1] = newPowError(env, status);
+      }
+      napi_call_function(env, undefined, onResult, 3, argv, NULL);
+    } else if (status != entangled::POW_FOUND && status_ == entangled::POW_FOUND) {
+      // Otherwise the first failure fails the whole job
+      status_ = status;
+    }
+
+    if (--remaining_ > 0) {
+      return;
+    }
+
+    if (status_ != entangled::POW_FOUND) {
+      argv[0] = newPowError(env, status_);
+    } else {
+      napi_get_null(env, &argv[0]);
+      if (onResult_ == NULL) {
+        argv[1] = Result(env, 0);
+        argv[2] = Stats(env, 0);
+        argc = 3;
+      }
+    }
+    napi_call_function(env, undefined, callback, argc, argv, NULL);
+  }
+
+  /**
+   * Returns { weight, attempts, elapsed, threads, backend } for a request that succeeded
+   */
+  napi_value Stats(napi_env env, size_t index) {
+    napi_value stats;
+    int weight = Weight(index);
+    char const *backend = control_->backend();
+
+    napi_create_object(env, &stats);
+    if (weight >= 0) {
+      napi_set_named_property(env, stats, "weight", newNumber(env, weight));
+    }
+    napi_set_named_property(env, stats, "attempts", newNumber(env, static_cast<double>(control_->attempts())));
+    napi_set_named_property(env, stats, "elapsed", newNumber(env, control_->elapsedMs()));
+    napi_set_named_property(env, stats, "threads", newNumber(env, static_cast<double>(control_->threads())));
+    napi_set_named_property(env, stats, "backend", newString(env, backend != NULL ? backend : "local"));
+    return stats;
+  }
+
+  std::shared_ptr<Instance> instance_;
+  PowOptions options_;
+  std::vector<Request> requests_;
+  std::shared_ptr<entangled::Control> control_;
+  std::shared_ptr<Completion> completion_;
+  napi_ref onResult_;
+  size_t remaining_;
+  uint32_t id_;
+  entangled::pow_status_t status_;
+};
+
+static PowWorker *findPowJob(napi_env env, napi_value id) {
+  std::shared_ptr<Instance> instance = getInstance(env);
+
+  auto job = instance->powJobs.find(readUint32(env, id));
+  return job == instance->powJobs.end() ? NULL : job->second;
+}
+
+static napi_value cancelJob(napi_env env, napi_callback_info info) {
+  napi_value argv[1], ret;
+
+  getArgs(env, info, argv);
+  if (!isType(env, argv[0], napi_number)) {
+    return throwError(env, "Wrong arguments");
+  }
+
+  PowWorker *job = findPowJob(env, argv[0]);
+  if (job != NULL) {
+    job->Cancel();
+  }
+  napi_get_boolean(env, job != NULL, &ret);
+  return ret;
+}
+
+static napi_value jobProgress(napi_env env, napi_callback_info info) {
+  napi_value argv[1], ret;
+
+  getArgs(env, info, argv);
+  if (!isType(env, argv[0], napi_number)) {
+    return throwError(env, "Wrong arguments");
+  }
+
+  PowWorker *job = findPowJob(env, argv[0]);
+  if (job == NULL) {
+    return NULL;
+  }
+
+  napi_create_object(env, &ret);
+  napi_set_named_property(env, ret, "attempts", newNumber(env, job->Attempts()));
+  napi_set_named_property(env, ret, "elapsed", newNumber(env, job->ElapsedMs()));
+  return ret;
+}
+
+static napi_value throwPowError(napi_env env, entangled::pow_status_t status) {
+  return throwError(env, entangled::powStatusMessage(status), powStatusCode(status));
+}
+
+/**
+ * Starts a PowWorker, returning its job id
+ */
+static napi_value startPowWorker(napi_env env, PowWorker *worker, napi_value callback, napi_value onResult,
+                                 char const *name) {
+  napi_value ret;
+
+  napi_create_uint32(env, worker->id(), &ret);
+  if (!worker->Start(env, callback, onResult, name)) {
+    return NULL;
+  }
+  return ret;
+}
+
+/*
+ * Proof of Work on trytes
+ */
+
+struct PowTrytesArgs {
+  std::string trytes;
+  uint8_t mwm;
+  uint64_t start;
+  uint64_t end;
+};
+
+static bool parsePowTrytesArgs(napi_env env, size_t argc, napi_value const *argv, PowTrytesArgs &args) {
+  if (argc < 2) {
+    throwError(env, "Wrong number of arguments");
+    return false;
+  }
+
+  if (!isType(env, argv[0], napi_string) || !isType(env, argv[1], napi_number)) {
+    throwError(env, "Wrong arguments");
+    return false;
+  }
+
+  args.trytes = readString(env, argv[0]);
+  args.mwm = static_cast<uint8_t>(readUint32(env, argv[1]));
+  args.start = 0;
+  args.end = entangled::kCounterValues;
+  return true;
+}
+
+// Reads a non-negative integer up to max, false otherwise
+static bool readCounter(napi_env env, napi_value value, uint64_t max, uint64_t &counter) {
+  if (!isType(env, value, napi_number)) {
+    return false;
+  }
+
+  double number = readDouble(env, value);
+  if (!(number >= 0 && number <= static_cast<double>(max)) || number != std::floor(number)) {
+    return false;
+  }
+  counter = static_cast<uint64_t>(number);
+  return true;
+}
+
+/**
+ * Reads the part of the nonce space a search is restricted to, from its partition { index, count } or its range of
+ * iteration counters { start, end } options
+ */
+static bool parsePowRange(napi_env env, napi_value options, PowTrytesArgs &args) {
+  if (!isType(env, options, napi_object)) {
+    return true;
+  }
+
+  napi_value partition = getProperty(env, options, "partition");
+  napi_value range = getProperty(env, options, "range");
+  uint64_t index, count;
+
+  if (isType(env, partition, napi_object)) {
+    if (!readCounter(env, getProperty(env, partition, "count"), entangled::kMaxPartitions, count) || count == 0 ||
+        !readCounter(env, getProperty(env, partition, "index"), count - 1, index)) {
+      throwError(env, "Invalid nonce partition", "EINVAL");
+      return false;
+    }
+    entangled::partitionRange(index, count, args.start, args.end);
+  } else if (isType(env, range, napi_object)) {
+    if (!readCounter(env, getProperty(env, range, "start"), entangled::kCounterValues, args.start) ||
+        !readCounter(env, getProperty(env, range, "end"), entangled::kCounterValues, args.end) ||
+        args.start >= args.end) {
+      throwError(env, "Invalid nonce range", "EINVAL");
+      return false;
+    }
+  }
+  return true;
+}
+
+static napi_value powTrytes(napi_env env, napi_callback_info info) {
+  napi_value argv[2];
+  size_t argc = getArgs(env, info, argv);
+  PowTrytesArgs args;
+  entangled::pow_status_t status;
+  std::string nonce;
+
+  if (!parsePowTrytesArgs(env, argc, argv, args)) {
+    return NULL;
+  }
+
+  status = entangled::powTrytes(args.trytes, args.mwm, std::make_shared<entangled::Control>(), nonce);
+  if (status != entangled::POW_FOUND) {
+    return throwPowError(env, status);
+  }
+
+  return newString(env, nonce);
+}
+
+class PowTrytesWorker : public PowWorker {
+ public:
+  PowTrytesWorker(napi_env env, PowOptions const &options, PowTrytesArgs const &args) : PowWorker(env, options) {
+    Add(entangled::trytesPowKey(args.trytes, args.mwm, args.start, args.end),
+        std::make_shared<entangled::TrytesPowTask>(args.trytes, args.mwm, args.start, args.end));
+  }
+
+ protected:
+  napi_value Result(napi_env env, size_t index) {
+    return newString(env, std::static_pointer_cast<entangled::TrytesPowTask>(task(index))->nonce());
+  }
+
+  int Weight(size_t index) { return std::static_pointer_cast<entangled::TrytesPowTask>(task(index))->weight(); }
+};
+
+static napi_value powTrytesAsync(napi_env env, napi_callback_info info) {
+  napi_value argv[4];
+  size_t argc = getArgs(env, info, argv);
+  PowTrytesArgs args;
+  PowOptions options;
+
+  if (!parsePowTrytesArgs(env, argc, argv, args)) {
+    return NULL;
+  }
+
+  if (argc < 4 || !isType(env, argv[3], napi_function)) {
+    return throwError(env, "Wrong arguments");
+  }
+
+  if (!parsePowOptions(env, argv[2], options) || !parsePowRange(env, argv[2], args)) {
+    return NULL;
+  }
+
+  return startPowWorker(env, new PowTrytesWorker(env, options, args), argv[3], NULL, "entangled:powTrytes");
+}
+
+/*
+ * Proof of Work on a batch of independent transactions, packed into the lanes of shared searches
+ */
+
+struct PowTrytesBatchArgs {
+  std::vector<std::string> trytes;
+  uint8_t mwm;
+};
+
+static bool parsePowTrytesBatchArgs(napi_env env, size_t argc, napi_value const *argv, PowTrytesBatchArgs &args) {
+  if (argc < 2) {
+    throwError(env, "Wrong number of arguments");
+    return false;
+  }
+
+  if (!isArray(env, argv[0]) || arrayLength(env, argv[0]) == 0 || !isType(env, argv[1], napi_number)) {
+    throwError(env, "Wrong arguments");
+    return false;
+  }
+
+  readStrings(env, argv[0], args.trytes);
+  args.mwm = static_cast<uint8_t>(readUint32(env, argv[1]));
+  return true;
+}
+
+class PowTrytesBatchWorker : public PowWorker {
+ public:
+  PowTrytesBatchWorker(napi_env env, PowOptions const &options, PowTrytesBatchArgs const &args)
+      : PowWorker(env, options) {
+    Add(entangled::trytesBatchPowKey(args.trytes, args.mwm),
+        std::make_shared<entangled::TrytesBatchPowTask>(args.trytes, args.mwm));
+  }
+
+ protected:
+  napi_value Result(napi_env env, size_t index) {
+    return newStringsArray(env, std::static_pointer_cast<entangled::TrytesBatchPowTask>(task(index))->nonces());
+  }
+};
+
+static napi_value powTrytesBatchAsync(napi_env env, napi_callback_info info) {
+  napi_value argv[4];
+  size_t argc = getArgs(env, info, argv);
+  PowTrytesBatchArgs args;
+  PowOptions options;
+
+  if (!parsePowTrytesBatchArgs(env, argc, argv, args)) {
+    return NULL;
+  }
+
+  if (argc < 4 || !isType(env, argv[3], napi_function)) {
+    return throwError(env, "Wrong arguments");
+  }
+
+  if (!parsePowOptions(env, argv[2], options)) {
+    return NULL;
+  }
+
+  return startPowWorker(env, new PowTrytesBatchWorker(env, options, args), argv[3], NULL,
+                        "entangled:powTrytesBatch");
+}
+
+/*
+ * Proof of Work on a bundle
+ */
+
+struct PowBundleArgs {
+  std::vector<std::string> txsTrytes;
+  std::string trunk;
+  std::string branch;
+  uint8_t mwm;
+};
+
+static bool parsePowBundleArgs(napi_env env, size_t argc, napi_value const *argv, PowBundleArgs &args) {
+  if (argc < 4) {
+    throwError(env, "Wrong number of arguments");
+    return false;
+  }
+
+  if (!isArray(env, argv[0]) || !isType(env, argv[1], napi_string) || !isType(env, argv[2], napi_string) ||
+      !isType(env, argv[3], napi_number)) {
+    throwError(env, "Wrong arguments");
+    return false;
+  }
+
+  readStrings(env, argv[0], args.txsTrytes);
+  args.trunk = readString(env, argv[1]);
+  args.branch = readString(env, argv[2]);
+  args.mwm = static_cast<uint8_t>(readUint32(env, argv[3]));
+  return true;
+}
+
+static napi_value powBundle(napi_env env, napi_callback_info info) {
+  napi_value argv[4];
+  size_t argc = getArgs(env, info, argv);
+  PowBundleArgs args;
+  entangled::pow_status_t status;
+
+  if (!parsePowBundleArgs(env, argc, argv, args)) {
+    return NULL;
+  }
+
+  status = entangled::powBundle(args.txsTrytes, args.trunk, args.branch, args.mwm,
+                                std::make_shared<entangled::Control>());
+  if (status != entangled::POW_FOUND) {
+    return throwPowError(env, status);
+  }
+
+  return newStringsArray(env, args.txsTrytes);
+}
+
+/**
+ * Proof of Work on one or more independent bundles
+ */
+class PowBundleWorker : public PowWorker {
+ public:
+  PowBundleWorker(napi_env env, PowOptions const &options, std::vector<PowBundleArgs> const &bundles)
+      : PowWorker(env, options) {
+    for (auto const &bundle : bundles) {
+      Add(entangled::bundlePowKey(bundle.txsTrytes, bundle.trunk, bundle.branch, bundle.mwm),
+          std::make_shared<entangled::BundlePowTask>(bundle.txsTrytes, bundle.trunk, bundle.branch, bundle.mwm));
+    }
+  }
+
+ protected:
+  napi_value Result(napi_env env, size_t index) {
+    return newStringsArray(env, std::static_pointer_cast<entangled::BundlePowTask>(task(index))->txs());
+  }
+
+  int Weight(size_t index) { return std::static_pointer_cast<entangled::BundlePowTask>(task(index))->weight(); }
+};
+
+static napi_value powBundleAsync(napi_env env, napi_callback_info info) {
+  napi_value argv[6];
+  size_t argc = getArgs(env, info, argv);
+  std::vector<PowBundleArgs> bundles(1);
+  PowOptions options;
+
+  if (!parsePowBundleArgs(env, argc, argv, bundles[0])) {
+    return NULL;
+  }
+
+  if (argc < 6 || !isType(env, argv[5], napi_function)) {
+    return throwError(env, "Wrong arguments");
+  }
+
+  if (!parsePowOptions(env, argv[4], options)) {
+    return NULL;
+  }
+
+  return startPowWorker(env, new PowBundleWorker(env, options, bundles), argv[5], NULL, "entangled:powBundle");
+}
+
+/*
+ * Proof of Work on independent bundles
+ */
+
+static bool parsePowBundlesArgs(napi_env env, size_t argc, napi_value const *argv,
+                                std::vector<PowBundleArgs> &bundles) {
+  if (argc < 2) {
+    throwError(env, "Wrong number of arguments");
+    return false;
+  }
+
+  if (!isArray(env, argv[0]) || arrayLength(env, argv[0]) == 0 || !isType(env, argv[1], napi_number)) {
+    throwError(env, "Wrong arguments");
+    return false;
+  }
+
+  uint8_t mwm = static_cast<uint8_t>(readUint32(env, argv[1]));
+  bundles.resize(arrayLength(env, argv[0]));
+  for (size_t i = 0; i < bundles.size(); i++) {
+    napi_value bundle;
+    napi_get_element(env, argv[0], static_cast<uint32_t>(i), &bundle);
+    if (!isType(env, bundle, napi_object)) {
+      throwError(env, "Wrong arguments");
+      return false;
+    }
+
+    napi_value trytes = getProperty(env, bundle, "trytes");
+    napi_value trunk = getProperty(env, bundle, "trunk");
+    napi_value branch = getProperty(env, bundle, "branch");
+    if (!isArray(env, trytes) || !isType(env, trunk, napi_string) || !isType(env, branch, napi_string)) {
+      throwError(env, "Wrong arguments");
+      return false;
+    }
+
+    readStrings(env, trytes, bundles[i].txsTrytes);
+    bundles[i].trunk = readString(env, trunk);
+    bundles[i].branch = readString(env, branch);
+    bundles[i].mwm = mwm;
+  }
+  return true;
+}
+
+static napi_value powBundlesAsync(napi_env env, napi_callback_info info) {
+  napi_value argv[5];
+  size_t argc = getArgs(env, info, argv);
+  std::vector<PowBundleArgs> bundles;
+  PowOptions options;
+
+  if (!parsePowBundlesArgs(env, argc, argv, bundles)) {
+    return NULL;
+  }
+
+  if (argc < 5 || !isType(env, argv[3], napi_function) || !isType(env, argv[4], napi_function)) {
+    return throwError(env, "Wrong arguments");
+  }
+
+  if (!parsePowOptions(env, argv[2], options)) {
+    return NULL;
+  }
+
+  return startPowWorker(env, new PowBundleWorker(env, options, bundles), argv[4], argv[3], "entangled:powBundles");
+}
+
+/*
+ * Hashcash on an arbitrary buffer, in trytes or trits, the nonce offset and length being in the same unit
+ */
+
+struct HashcashArgs {
+  std::vector<trit_t> trits;
+  size_t nonceOffset;
+  size_t nonceTrits;
+  uint8_t mwm;
+  bool trytes;
+};
+
+static bool parseHashcashArgs(napi_env env, size_t argc, napi_value const *argv, HashcashArgs &args) {
+  if (argc < 4) {
+    throwError(env, "Wrong number of arguments");
+    return false;
+  }
+
+  args.trytes = isType(env, argv[0], napi_string);
+  if ((!args.trytes && !isArray(env, argv[0])) || !isType(env, argv[1], napi_number) ||
+      !isType(env, argv[2], napi_number) || !isType(env, argv[3], napi_number)) {
+    throwError(env, "Wrong arguments");
+    return false;
+  }
+
+  size_t unit = args.trytes ? 3 : 1;
+  if (args.trytes) {
+    std::string trytes = readString(env, argv[0]);
+    args.trits.resize(3 * trytes.size());
+    if (!entangled::trytesToTrits(trytes.data(), trytes.size(), args.trits.data())) {
+      throwError(env, "Invalid trytes", "EINVAL");
+      return false;
+    }
+  } else {
+    args.trits.resize(arrayLength(env, argv[0]));
+    readTrits(env, argv[0], args.trits.data(), args.trits.size());
+  }
+  args.nonceOffset = unit * readUint32(env, argv[1]);
+  args.nonceTrits = unit * readUint32(env, argv[2]);
+  args.mwm = static_cast<uint8_t>(std::min<uint32_t>(readUint32(env, argv[3]), 255));
+  return true;
+}
+
+class HashcashWorker : public PowWorker {
+ public:
+  HashcashWorker(napi_env env, PowOptions const &options, HashcashArgs const &args)
+      : PowWorker(env, options), trytes_(args.trytes) {
+    Add(entangled::hashcashPowKey(args.trits, args.nonceOffset, args.nonceTrits, args.mwm),
+        std::make_shared<entangled::HashcashPowTask>(args.trits, args.nonceOffset, args.nonceTrits, args.mwm));
+  }
+
+ protected:
+  napi_value Result(napi_env env, size_t index) {
+    auto hashcash = std::static_pointer_cast<entangled::HashcashPowTask>(task(index));
+    napi_value ret;
+
+    napi_create_object(env, &ret);
+    napi_set_named_property(env, ret, "nonce", newTrits(env, hashcash->nonce()));
+    napi_set_named_property(env, ret, "hash", newTrits(env, hashcash->hash()));
+    return ret;
+  }
+
+ private:
+  // Trits as trytes if the buffer was given in trytes, their length then being a multiple of 3
+  napi_value newTrits(napi_env env, std::vector<trit_t> const &trits) {
+    if (!trytes_) {
+      return newTritsArray(env, trits.data(), trits.size());
+    }
+
+    std::string trytes(trits.size() / 3, '9');
+    entangled::tritsToTrytes(trits.data(), trytes.size(), &trytes[0]);
+    return newString(env, trytes);
+  }
+
+  bool trytes_;
+};
+
+static napi_value hashcashAsync(napi_env env, napi_callback_info info) {
+  napi_value argv[6];
+  size_t argc = getArgs(env, info, argv);
+  HashcashArgs args;
+  PowOptions options;
+
+  if (!parseHashcashArgs(env, argc, argv, args)) {
+    return NULL;
+  }
+
+  if (argc < 6 || !isType(env, argv[5], napi_function)) {
+    return throwError(env, "Wrong arguments");
+  }
+
+  if (!parsePowOptions(env, argv[4], options)) {
+    return NULL;
+  }
+
+  return startPowWorker(env, new HashcashWorker(env, options, args), argv[5], NULL, "entangled:hashcash");
+}
+
+/*
+ * Proof of Work backends. Requests run in process unless a worker process is set to take them.
+ */
+
+static napi_value setPowBackend(napi_env env, napi_callback_info info) {
+  napi_value argv[1];
+
+  getArgs(env, info, argv);
+  if (isType(env, argv[0], napi_undefined) || isType(env, argv[0], napi_null)) {
+    entangled::setPowBackend(std::make_shared<entangled::LocalPowBackend>());
+    return NULL;
+  }
+
+  napi_value socket = getProperty(env, argv[0], "socket");
+  napi_value retries = getProperty(env, argv[0], "retries");
+  napi_value retryDelay = getProperty(env, argv[0], "retryDelay");
+  napi_value fallback = getProperty(env, argv[0], "fallback");
+
+  if (!isType(env, socket, napi_string)) {
+    return throwError(env, "Wrong arguments");
+  }
+#ifdef _WIN32
+  return throwError(env, "Proof of Work workers are not supported on this platform", "ENOTSUP");
+#else
+  bool local = true;
+  std::shared_ptr<entangled::PowBackend> backend;
+
+  if (isType(env, fallback, napi_boolean)) {
+    napi_get_value_bool(env, fallback, &local);
+  }
+  if (local) {
+    backend = std::make_shared<entangled::LocalPowBackend>();
+  }
+  entangled::setPowBackend(std::make_shared<entangled::SocketPowBackend>(
+      readString(env, socket), isType(env, retries, napi_number) ? readUint32(env, retries) : 2,
+      isType(env, retryDelay, napi_number) ? readUint32(env, retryDelay) : 100, backend));
+  return NULL;
+#endif
+}
+
+/*
+ * Proof of Work calibration. JS benchmarks every kernel and thread count, then selects the fastest ones.
+ */
+
+static napi_value powKernels(napi_env env, napi_callback_info info) {
+  napi_value ret, kernels;
+  uint32_t count = 0;
+
+  napi_create_object(env, &ret);
+  napi_create_array(env, &kernels);
+  for (int i = 0; i < entangled::POW_KERNEL_COUNT; i++) {
+    entangled::pow_kernel_t kernel = static_cast<entangled::pow_kernel_t>(i);
+    if (entangled::powKernelSupported(kernel)) {
+      napi_set_element(env, kernels, count++, newString(env, entangled::powKernelName(kernel)));
+    }
+  }
+  napi_set_named_property(env, ret, "supported", kernels);
+  napi_set_named_property(env, ret, "selected", newString(env, entangled::powKernelName(entangled::powKernel())));
+  return ret;
+}
+
+static bool readPowKernel(napi_env env, napi_value value, entangled::pow_kernel_t &kernel) {
+  if (!isType(env, value, napi_string)) {
+    throwError(env, "Wrong arguments");
+    return false;
+  }
+  if (!entangled::powKernelFromName(readString(env, value).c_str(), kernel) ||
+      !entangled::powKernelSupported(kernel)) {
+    throwError(env, "Unsupported Proof of Work kernel", "EINVAL");
+    return false;
+  }
+  return true;
+}
+
+static napi_value setPowKernel(napi_env env, napi_callback_info info) {
+  napi_value argv[1];
+  entangled::pow_kernel_t kernel;
+
+  getArgs(env, info, argv);
+  if (readPowKernel(env, argv[0], kernel)) {
+    entangled::setPowKernel(kernel);
+  }
+  return NULL;
+}
+
+struct PowBenchmarkResult {
+  double attempts;
+  double elapsedMs;
+};
+
+static void onPowBenchmarkDone(napi_env env, napi_value callback, void *context, void *data) {
+  std::unique_ptr<PowBenchmarkResult> result(static_cast<PowBenchmarkResult *>(data));
+
+  if (env != NULL) {
+    napi_value undefined, argv[2];
+    napi_get_undefined(env, &undefined);
+    napi_get_null(env, &argv[0]);
+    napi_create_object(env, &argv[1]);
+    napi_set_named_property(env, argv[1], "attempts", newNumber(env, result->attempts));
+    napi_set_named_property(env, argv[1], "elapsed", newNumber(env, result->elapsedMs));
+    napi_call_function(env, undefined, callback, 2, argv, NULL);
+  }
+}
+
+static napi_value powBenchmarkAsync(napi_env env, napi_callback_info info) {
+  napi_value argv[4];
+  size_t argc = getArgs(env, info, argv);
+  entangled::pow_kernel_t kernel;
+
+  if (argc < 4) {
+    return throwError(env, "Wrong number of arguments");
+  }
+
+  if (!isType(env, argv[1], napi_number) || !isType(env, argv[2], napi_number) ||
+      !isType(env, argv[3], napi_function)) {
+    return throwError(env, "Wrong arguments");
+  }
+
+  if (!readPowKernel(env, argv[0], kernel)) {
+    return NULL;
   }
 
-  if (!info[0]->IsString() || !info[1]->IsNumber()) {
-    Nan::ThrowError("Wrong arguments");
-    return;
+  // Measured where Proof of Work runs by default
+  entangled::Scheduler *scheduler = entangled::Scheduler::pool(entangled::powDefaults().placement);
+  if (scheduler == NULL) {
+    return throwError(env, "Too many Proof of Work thread pools", "EBUSY");
   }
 
-  char *nonce = NULL;
-  std::string trytes(*Nan::Utf8String(info[0]));
-  auto ctrytes = trytes.c_str();
-  auto mwm = static_cast<uint8_t>(Nan::To<unsigned>(info[1]).FromJust());
+  std::shared_ptr<Completion> completion =
+      Completion::create(env, argv[3], "entangled:powBenchmark", 1, NULL, NULL, onPowBenchmarkDone);
+  if (completion == NULL) {
+    return throwError(env, "Could not create the completion callback");
+  }
+
+  auto control = std::make_shared<entangled::Control>();
+  control->setTimeout(static_cast<uint64_t>(std::max(1.0, readDouble(env, argv[2]))));
+  auto job = std::make_shared<entangled::PowJob>(
+      std::make_shared<entangled::BenchmarkPowTask>(kernel), control, scheduler, entangled::PRIORITY_BULK,
+      std::max<uint32_t>(1, readUint32(env, argv[1])), [completion, control](entangled::pow_status_t status) {
+        PowBenchmarkResult *result =
+            new PowBenchmarkResult{static_cast<double>(control->attempts()), control->elapsedMs()};
+
+        if (!completion->post(result)) {
+          delete result;
+        }
+      });
+
+  if (!job->start()) {
+    completion->abandon();
+    return throwBusy(env, entangled::PRIORITY_BULK);
+  }
+  return NULL;
+}
 
-  if ((nonce = iota_pow_trytes(ctrytes, mwm)) == NULL) {
-    Nan::ThrowError("Binding iota_pow_trytes failed");
-    return;
+/*
+ * Address generation in trytes
+ */
+
+struct GenAddressTrytesArgs {
+  std::string seed;
+  uint64_t index;
+  uint64_t security;
+};
+
+static bool parseGenAddressTrytesArgs(napi_env env, size_t argc, napi_value const *argv,
+                                      GenAddressTrytesArgs &args) {
+  if (argc < 3) {
+    throwError(env, "Wrong number of arguments");
+    return false;
   }
 
-  auto ret = Nan::New(nonce).ToLocalChecked();
-  free(nonce);
+  if (!isType(env, argv[0], napi_string) || !isType(env, argv[1], napi_number) ||
+      !isType(env, argv[2], napi_number)) {
+    throwError(env, "Wrong arguments");
+    return false;
+  }
 
-  info.GetReturnValue().Set(ret);
+  args.seed = readString(env, argv[0]);
+  args.index = readUint32(env, argv[1]);
+  args.security = readUint32(env, argv[2]);
+  return true;
 }
 
-static NAN_METHOD(powBundle) {
-  if (info.Length() < 4) {
-    Nan::ThrowError("Wrong number of arguments");
-    return;
-  }
+static napi_value genAddressTrytes(napi_env env, napi_callback_info info) {
+  napi_value argv[3];
+  size_t argc = getArgs(env, info, argv);
+  GenAddressTrytesArgs args;
+  char address[entangled::kHashTrytes + 1] = {0};
 
-  if (!info[0]->IsArray() || !info[1]->IsString() || !info[2]->IsString() || !info[3]->IsNumber()) {
-    Nan::ThrowError("Wrong arguments");
-    return;
+  if (!parseGenAddressTrytesArgs(env, argc, argv, args)) {
+    return NULL;
   }
 
-  bundle_transactions_t *bundle = NULL;
-  iota_transaction_t tx;
-  iota_transaction_t *curTx = NULL;
-  flex_trit_t serializedFlexTrits[FLEX_TRIT_SIZE_8019];
-  char serializedTrytes[NUM_TRYTES_SERIALIZED_TRANSACTION + 1] = {0};
-  flex_trit_t flexTrunk[FLEX_TRIT_SIZE_243];
-  flex_trit_t flexBranch[FLEX_TRIT_SIZE_243];
+  bool valid = entangled::issAddressTrytes(args.seed.data(), args.seed.size(), args.index, args.security, address);
+  scrubString(args.seed);
+
+  if (!valid) {
+    return throwError(env, kInvalidSeedMessage);
+  }
+  return newString(env, address);
+}
 
-  std::string trunk(*Nan::Utf8String(info[1]));
-  flex_trits_from_trytes(flexTrunk, NUM_TRITS_TRUNK, (tryte_t *)trunk.c_str(), NUM_TRYTES_TRUNK, NUM_TRYTES_TRUNK);
-  std::string branch(*Nan::Utf8String(info[2]));
-  flex_trits_from_trytes(flexBranch, NUM_TRITS_BRANCH, (tryte_t *)branch.c_str(), NUM_TRYTES_BRANCH, NUM_TRYTES_BRANCH);
+class GenAddressTrytesWorker : public Worker {
+ public:
+  GenAddressTrytesWorker(GenAddressTrytesArgs const &args) : args_(args), address_() {}
 
-  bundle_transactions_new(&bundle);
+  ~GenAddressTrytesWorker() { scrubString(args_.seed); }
 
-  v8::Local<v8::Array> txsTrytes = v8::Local<v8::Array>::Cast(info[0]);
-  size_t txNum = txsTrytes->Length();
-  for (size_t i = 0; i < txNum; i++) {
-    flex_trits_from_trytes(
-        serializedFlexTrits, NUM_TRITS_SERIALIZED_TRANSACTION,
-        (tryte_t *)(*Nan::Utf8String(txsTrytes->Get(Nan::GetCurrentContext(), i).ToLocalChecked().As<v8::String>())),
-        NUM_TRYTES_SERIALIZED_TRANSACTION, NUM_TRYTES_SERIALIZED_TRANSACTION);
-    transaction_deserialize_from_trits(&tx, serializedFlexTrits, false);
-    bundle_transactions_add(bundle, &tx);
+  void Execute() {
+    bool valid = entangled::issAddressTrytes(args_.seed.data(), args_.seed.size(), args_.index, args_.security,
+                                             address_);
+    scrubString(args_.seed);
+    if (!valid) {
+      SetErrorMessage(kInvalidSeedMessage);
+    }
   }
 
-  auto mwm = static_cast<uint8_t>(Nan::To<unsigned>(info[3]).FromJust());
+  napi_value Result(napi_env env) { return newString(env, address_); }
+
+ private:
+  GenAddressTrytesArgs args_;
+  char address_[entangled::kHashTrytes + 1];
+};
 
-  if (iota_pow_bundle(bundle, flexTrunk, flexBranch, mwm) != RC_OK) {
-    bundle_transactions_free(&bundle);
-    Nan::ThrowError("Binding iota_pow_bundle failed");
-    return;
+static napi_value genAddressTrytesAsync(napi_env env, napi_callback_info info) {
+  napi_value argv[4];
+  size_t argc = getArgs(env, info, argv);
+  GenAddressTrytesArgs args;
+
+  if (!parseGenAddressTrytesArgs(env, argc, argv, args)) {
+    return NULL;
   }
 
-  v8::Local<v8::Array> ret = Nan::New<v8::Array>(txNum);
-  size_t i = 0;
-  BUNDLE_FOREACH(bundle, curTx) {
-    transaction_serialize_on_flex_trits(curTx, serializedFlexTrits);
-    flex_trits_to_trytes((tryte_t *)serializedTrytes, NUM_TRYTES_SERIALIZED_TRANSACTION, serializedFlexTrits,
-                         NUM_TRITS_SERIALIZED_TRANSACTION, NUM_TRITS_SERIALIZED_TRANSACTION);
-    ret->Set(Nan::GetCurrentContext(), i, Nan::New<v8::String>((char *)serializedTrytes).ToLocalChecked()).FromJust();
-    i++;
+  if (argc < 4 || !isType(env, argv[3], napi_function)) {
+    scrubString(args.seed);
+    return throwError(env, "Wrong arguments");
   }
-  bundle_transactions_free(&bundle);
 
-  info.GetReturnValue().Set(ret);
+  queueWorker(env, new GenAddressTrytesWorker(args), argv[3], "entangled:genAddressTrytes",
+              entangled::PRIORITY_INTERACTIVE);
+  scrubString(args.seed);
+  return NULL;
 }
 
-static NAN_METHOD(genAddressTrytes) {
-  if (info.Length() < 3) {
-    Nan::ThrowError("Wrong number of arguments");
-    return;
+/*
+ * Address generation in trits
+ */
+
+struct GenAddressTritsArgs {
+  trit_t seed[243];
+  uint64_t index;
+  uint64_t security;
+};
+
+static bool parseGenAddressTritsArgs(napi_env env, size_t argc, napi_value const *argv, GenAddressTritsArgs &args) {
+  if (argc < 3) {
+    throwError(env, "Wrong number of arguments");
+    return false;
   }
 
-  if (!info[0]->IsString() || !info[1]->IsNumber() || !info[2]->IsNumber()) {
-    Nan::ThrowError("Wrong arguments");
-    return;
+  if (!isArray(env, argv[0]) || !isType(env, argv[1], napi_number) || !isType(env, argv[2], napi_number)) {
+    throwError(env, "Wrong arguments");
+    return false;
   }
 
-  char *address = NULL;
-  std::string seed(*Nan::Utf8String(info[0]));
-  auto cseed = seed.c_str();
-  auto index = static_cast<uint64_t>(Nan::To<unsigned>(info[1]).FromJust());
-  auto security = static_cast<uint64_t>(Nan::To<unsigned>(info[2]).FromJust());
+  memset(args.seed, 0, sizeof(args.seed));
+  readTrits(env, argv[0], args.seed, 243);
+  args.index = readUint32(env, argv[1]);
+  args.security = readUint32(env, argv[2]);
+  return true;
+}
+
+static napi_value genAddressTrits(napi_env env, napi_callback_info info) {
+  napi_value argv[3];
+  size_t argc = getArgs(env, info, argv);
+  GenAddressTritsArgs args;
 
-  if ((address = iota_sign_address_gen_trytes(cseed, index, security)) == NULL) {
-    memset_safe((void *)cseed, 81, 0, 81);
-    Nan::ThrowError("Binding iota_sign_address_gen_trytes failed");
-    return;
+  if (!parseGenAddressTritsArgs(env, argc, argv, args)) {
+    return NULL;
   }
 
-  memset_safe((void *)cseed, 81, 0, 81);
+  trit_t address[243];
+  bool valid = entangled::issAddressTrits(args.seed, args.index, args.security, address);
 
-  auto ret = Nan::New(address).ToLocalChecked();
-  free(address);
+  memset_safe((void *)args.seed, 243, 0, 243);
 
-  info.GetReturnValue().Set(ret);
+  if (!valid) {
+    return throwError(env, kInvalidSeedMessage);
+  }
+  return newTritsArray(env, address, 243);
 }
 
-static NAN_METHOD(genAddressTrits) {
-  if (info.Length() < 3) {
-    Nan::ThrowError("Wrong number of arguments");
-    return;
+class GenAddressTritsWorker : public Worker {
+ public:
+  GenAddressTritsWorker(GenAddressTritsArgs const &args) : args_(args), address_() {}
+
+  ~GenAddressTritsWorker() { memset_safe((void *)args_.seed, 243, 0, 243); }
+
+  void Execute() {
+    bool valid = entangled::issAddressTrits(args_.seed, args_.index, args_.security, address_);
+    memset_safe((void *)args_.seed, 243, 0, 243);
+    if (!valid) {
+      SetErrorMessage(kInvalidSeedMessage);
+    }
+  }
+
+  napi_value Result(napi_env env) { return newTritsArray(env, address_, 243); }
+
+ private:
+  GenAddressTritsArgs args_;
+  trit_t address_[243];
+};
+
+static napi_value genAddressTritsAsync(napi_env env, napi_callback_info info) {
+  napi_value argv[4];
+  size_t argc = getArgs(env, info, argv);
+  GenAddressTritsArgs args;
+
+  if (!parseGenAddressTritsArgs(env, argc, argv, args)) {
+    return NULL;
   }
 
-  if (!info[0]->IsArray() || !info[1]->IsNumber() || !info[2]->IsNumber()) {
-    Nan::ThrowError("Wrong arguments");
-    return;
+  if (argc < 4 || !isType(env, argv[3], napi_function)) {
+    memset_safe((void *)args.seed, 243, 0, 243);
+    return throwError(env, "Wrong arguments");
   }
 
-  trit_t seed[243];
-  v8::Local<v8::Array> trits = v8::Local<v8::Array>::Cast(info[0]);
-  for (size_t i = 0; i < trits->Length(); i++) {
-    seed[i] =
-        trits->Get(Nan::GetCurrentContext(), i).ToLocalChecked()->NumberValue(Nan::GetCurrentContext()).FromJust();
+  queueWorker(env, new GenAddressTritsWorker(args), argv[3], "entangled:genAddressTrits",
+              entangled::PRIORITY_INTERACTIVE);
+  memset_safe((void *)args.seed, 243, 0, 243);
+  return NULL;
+}
+
+/*
+ * Address range generation
+ */
+
+// Addresses generated per call, JS iterating over larger ranges in chunks
+static uint32_t const kMaxAddressRangeCount = 65536;
+
+struct GenAddressRangeArgs {
+  std::string seed;
+  uint64_t start;
+  uint32_t count;
+  uint64_t security;
+};
+
+class GenAddressRangeWorker : public Worker {
+ public:
+  GenAddressRangeWorker(GenAddressRangeArgs const &args) : args_(args), addresses_(args.count * 243) {}
+
+  ~GenAddressRangeWorker() { scrubString(args_.seed); }
+
+  void Execute() {
+    trit_t seed[243];
+    bool valid = entangled::issSeedTrits(args_.seed.data(), args_.seed.size(), seed) &&
+                 entangled::addressRange(seed, args_.start, args_.count, args_.security, addresses_.data(),
+                                         &entangled::Scheduler::instance(), entangled::PRIORITY_INTERACTIVE);
+
+    memset_safe((void *)seed, 243, 0, 243);
+    scrubString(args_.seed);
+    if (!valid) {
+      SetErrorMessage(kInvalidSeedMessage);
+    }
   }
-  uint64_t index = static_cast<uint64_t>(Nan::To<unsigned>(info[1]).FromJust());
 
-  trit_t *address = iota_sign_address_gen_trits(seed, index, 2);
+  napi_value Result(napi_env env) {
+    napi_value addresses;
+    char address[entangled::kHashTrytes];
 
-  memset_safe((void *)seed, 243, 0, 243);
+    napi_create_array_with_length(env, args_.count, &addresses);
+    for (uint32_t i = 0; i < args_.count; i++) {
+      entangled::tritsToTrytes(&addresses_[i * 243], entangled::kHashTrytes, address);
+      napi_set_element(env, addresses, i, newString(env, address, entangled::kHashTrytes));
+    }
+    return addresses;
+  }
 
-  v8::Local<v8::Array> ret = Nan::New<v8::Array>(243);
-  for (size_t i = 0; i < 243; i++) {
-    ret->Set(Nan::GetCurrentContext(), i, Nan::New(address[i])).FromJust();
-  };
+ private:
+  GenAddressRangeArgs args_;
+  std::vector<trit_t> addresses_;
+};
+
+static napi_value genAddressRangeAsync(napi_env env, napi_callback_info info) {
+  napi_value argv[5];
+  size_t argc = getArgs(env, info, argv);
+  GenAddressRangeArgs args;
+
+  if (argc < 5) {
+    return throwError(env, "Wrong number of arguments");
+  }
+
+  if (!isType(env, argv[0], napi_string) || !isType(env, argv[1], napi_number) ||
+      !isType(env, argv[2], napi_number) || !isType(env, argv[3], napi_number) ||
+      !isType(env, argv[4], napi_function)) {
+    return throwError(env, "Wrong arguments");
+  }
+
+  args.seed = readString(env, argv[0]);
+  args.start = readUint32(env, argv[1]);
+  args.count = readUint32(env, argv[2]);
+  args.security = readUint32(env, argv[3]);
+  if (args.count > kMaxAddressRangeCount) {
+    scrubString(args.seed);
+    return throwError(env, "Too many addresses at once");
+  }
 
-  info.GetReturnValue().Set(ret);
+  queueWorker(env, new GenAddressRangeWorker(args), argv[4], "entangled:genAddressRange",
+              entangled::PRIORITY_INTERACTIVE);
+  scrubString(args.seed);
+  return NULL;
 }
 
-static NAN_METHOD(genSignatureTrytes) {
-  if (info.Length() < 4) {
-    Nan::ThrowError("Wrong number of arguments");
-    return;
+/*
+ * Address batch generation
+ */
+
+class GenAddressBatchWorker : public Worker {
+ public:
+  GenAddressBatchWorker(std::string &seeds, std::vector<uint64_t> &indexes, std::vector<uint8_t> &securities)
+      : addresses_(indexes.size() * entangled::kHashTrytes, '9') {
+    seeds_.swap(seeds);
+    indexes_.swap(indexes);
+    securities_.swap(securities);
+  }
+
+  ~GenAddressBatchWorker() { scrubString(seeds_); }
+
+  void Execute() {
+    if (!entangled::addressBatch(&seeds_[0], indexes_.data(), securities_.data(), indexes_.size(), &addresses_[0],
+                                 &entangled::Scheduler::instance(), entangled::PRIORITY_INTERACTIVE)) {
+      SetErrorMessage(kInvalidSeedMessage, "EINVAL");
+    }
   }
 
-  if (!info[0]->IsString() || !info[1]->IsNumber() || !info[2]->IsNumber() || !info[3]->IsString()) {
-    Nan::ThrowError("Wrong arguments");
-    return;
+  napi_value Result(napi_env env) {
+    napi_value ret;
+    napi_create_buffer_copy(env, addresses_.size(), addresses_.data(), NULL, &ret);
+    return ret;
   }
 
-  char *signature = NULL;
-  std::string seed(*Nan::Utf8String(info[0]));
-  auto cseed = seed.c_str();
-  auto index = static_cast<uint64_t>(Nan::To<unsigned>(info[1]).FromJust());
-  auto security = static_cast<uint64_t>(Nan::To<unsigned>(info[2]).FromJust());
-  std::string bundle(*Nan::Utf8String(info[3]));
-  auto cbundle = bundle.c_str();
+ private:
+  std::string seeds_;
+  std::vector<uint64_t> indexes_;
+  std::vector<uint8_t> securities_;
+  std::string addresses_;
+};
+
+static napi_value genAddressBatchAsync(napi_env env, napi_callback_info info) {
+  napi_value argv[4];
+  size_t argc = getArgs(env, info, argv);
+  bool isBuffer = false, isIndexes = false, isSecurities = false;
+  napi_typedarray_type indexesType, securitiesType;
+  size_t seedsLength = 0, count = 0, securitiesLength = 0;
+  void *seedsData = NULL, *indexesData = NULL, *securitiesData = NULL;
+
+  if (argc < 4) {
+    return throwError(env, "Wrong number of arguments");
+  }
 
-  if ((signature = iota_sign_signature_gen_trytes(cseed, index, security, cbundle)) == NULL) {
-    memset_safe((void *)cseed, 81, 0, 81);
-    Nan::ThrowError("Binding iota_sign_signature_gen_trytes failed");
-    return;
+  napi_is_buffer(env, argv[0], &isBuffer);
+  napi_is_typedarray(env, argv[1], &isIndexes);
+  napi_is_typedarray(env, argv[2], &isSecurities);
+  if (!isBuffer || !isIndexes || !isSecurities || !isType(env, argv[3], napi_function)) {
+    return throwError(env, "Wrong arguments");
   }
 
-  memset_safe((void *)cseed, 81, 0, 81);
+  napi_get_buffer_info(env, argv[0], &seedsData, &seedsLength);
+  napi_get_typedarray_info(env, argv[1], &indexesType, &count, &indexesData, NULL, NULL);
+  napi_get_typedarray_info(env, argv[2], &securitiesType, &securitiesLength, &securitiesData, NULL, NULL);
+  if (indexesType != napi_uint32_array || securitiesType != napi_uint8_array || securitiesLength != count ||
+      seedsLength != count * entangled::kSeedTrytes) {
+    return throwError(env, "Wrong arguments");
+  }
 
-  auto ret = Nan::New(signature).ToLocalChecked();
-  free(signature);
+  // Copied out of JS in one piece, the copy being scrubbed seed by seed as addresses are generated
+  std::string seeds(static_cast<char *>(seedsData), seedsLength);
+  std::vector<uint64_t> indexes(static_cast<uint32_t *>(indexesData), static_cast<uint32_t *>(indexesData) + count);
+  std::vector<uint8_t> securities(static_cast<uint8_t *>(securitiesData),
+                                  static_cast<uint8_t *>(securitiesData) + count);
 
-  info.GetReturnValue().Set(ret);
+  queueWorker(env, new GenAddressBatchWorker(seeds, indexes, securities), argv[3], "entangled:genAddressBatch",
+              entangled::PRIORITY_INTERACTIVE);
+  scrubString(seeds);
+  return NULL;
 }
 
-static NAN_METHOD(genSignatureTrits) {
-  if (info.Length() < 4) {
-    Nan::ThrowError("Wrong number of arguments");
-    return;
+/*
+ * Signature generation in trytes
+ */
+
+struct GenSignatureTrytesArgs {
+  std::string seed;
+  uint64_t index;
+  uint64_t security;
+  std::string bundle;
+};
+
+static bool parseGenSignatureTrytesArgs(napi_env env, size_t argc, napi_value const *argv,
+                                        GenSignatureTrytesArgs &args) {
+  if (argc < 4) {
+    throwError(env, "Wrong number of arguments");
+    return false;
   }
 
-  if (!info[0]->IsArray() || !info[1]->IsNumber() || !info[2]->IsNumber() || !info[3]->IsArray()) {
-    Nan::ThrowError("Wrong arguments");
-    return;
+  if (!isType(env, argv[0], napi_string) || !isType(env, argv[1], napi_number) ||
+      !isType(env, argv[2], napi_number) || !isType(env, argv[3], napi_string)) {
+    throwError(env, "Wrong arguments");
+    return false;
   }
 
-  trit_t seed[243];
-  v8::Local<v8::Array> seed_array = v8::Local<v8::Array>::Cast(info[0]);
-  for (size_t i = 0; i < seed_array->Length(); i++) {
-    seed[i] =
-        seed_array->Get(Nan::GetCurrentContext(), i).ToLocalChecked()->NumberValue(Nan::GetCurrentContext()).FromJust();
+  args.seed = readString(env, argv[0]);
+  args.index = readUint32(env, argv[1]);
+  args.security = readUint32(env, argv[2]);
+  args.bundle = readString(env, argv[3]);
+  return true;
+}
+
+static napi_value genSignatureTrytes(napi_env env, napi_callback_info info) {
+  napi_value argv[4];
+  size_t argc = getArgs(env, info, argv);
+  GenSignatureTrytesArgs args;
+  std::string signature;
+
+  if (!parseGenSignatureTrytesArgs(env, argc, argv, args)) {
+    return NULL;
+  }
+
+  signature.resize(entangled::kIssFragmentTrits / 3 * std::min<size_t>(args.security, entangled::kIssMaxSecurity));
+  bool valid = entangled::issSignatureTrytes(args.seed.data(), args.seed.size(), args.index, args.security,
+                                             args.bundle.c_str(), &signature[0]);
+  scrubString(args.seed);
+
+  if (!valid) {
+    return throwError(env, kInvalidSeedMessage);
+  }
+  return newString(env, signature);
+}
+
+class GenSignatureTrytesWorker : public Worker {
+ public:
+  GenSignatureTrytesWorker(GenSignatureTrytesArgs const &args) : args_(args) {}
+
+  ~GenSignatureTrytesWorker() { scrubString(args_.seed); }
+
+  void Execute() {
+    signature_.resize(entangled::kIssFragmentTrits / 3 * std::min<size_t>(args_.security, entangled::kIssMaxSecurity));
+    bool valid = entangled::issSignatureTrytes(args_.seed.data(), args_.seed.size(), args_.index, args_.security,
+                                               args_.bundle.c_str(), &signature_[0]);
+    scrubString(args_.seed);
+    if (!valid) {
+      SetErrorMessage(kInvalidSeedMessage);
+    }
+  }
+
+  napi_value Result(napi_env env) { return newString(env, signature_); }
+
+ private:
+  GenSignatureTrytesArgs args_;
+  std::string signature_;
+};
+
+static napi_value genSignatureTrytesAsync(napi_env env, napi_callback_info info) {
+  napi_value argv[5];
+  size_t argc = getArgs(env, info, argv);
+  GenSignatureTrytesArgs args;
+
+  if (!parseGenSignatureTrytesArgs(env, argc, argv, args)) {
+    return NULL;
+  }
+
+  if (argc < 5 || !isType(env, argv[4], napi_function)) {
+    scrubString(args.seed);
+    return throwError(env, "Wrong arguments");
   }
-  uint64_t index = static_cast<uint64_t>(Nan::To<unsigned>(info[1]).FromJust());
-  uint64_t security = static_cast<uint64_t>(Nan::To<unsigned>(info[2]).FromJust());
+
+  queueWorker(env, new GenSignatureTrytesWorker(args), argv[4], "entangled:genSignatureTrytes",
+              entangled::PRIORITY_INTERACTIVE);
+  scrubString(args.seed);
+  return NULL;
+}
+
+/*
+ * Signature generation in trits
+ */
+
+struct GenSignatureTritsArgs {
+  trit_t seed[243];
+  uint64_t index;
+  uint64_t security;
   trit_t bundle[243];
-  v8::Local<v8::Array> bundle_array = v8::Local<v8::Array>::Cast(info[3]);
-  for (size_t i = 0; i < bundle_array->Length(); i++) {
-    bundle[i] = bundle_array->Get(Nan::GetCurrentContext(), i)
-                    .ToLocalChecked()
-                    ->NumberValue(Nan::GetCurrentContext())
-                    .FromJust();
+};
+
+static bool parseGenSignatureTritsArgs(napi_env env, size_t argc, napi_value const *argv,
+                                       GenSignatureTritsArgs &args) {
+  if (argc < 4) {
+    throwError(env, "Wrong number of arguments");
+    return false;
   }
 
-  trit_t *signature = iota_sign_signature_gen_trits(seed, index, security, bundle);
+  if (!isArray(env, argv[0]) || !isType(env, argv[1], napi_number) || !isType(env, argv[2], napi_number) ||
+      !isArray(env, argv[3])) {
+    throwError(env, "Wrong arguments");
+    return false;
+  }
 
-  memset_safe((void *)seed, 243, 0, 243);
+  memset(args.seed, 0, sizeof(args.seed));
+  memset(args.bundle, 0, sizeof(args.bundle));
+  readTrits(env, argv[0], args.seed, 243);
+  args.index = readUint32(env, argv[1]);
+  args.security = readUint32(env, argv[2]);
+  readTrits(env, argv[3], args.bundle, 243);
+  return true;
+}
 
-  v8::Local<v8::Array> ret = Nan::New<v8::Array>(6561 * security);
-  for (size_t i = 0; i < 6561 * security; i++) {
-    ret->Set(Nan::GetCurrentContext(), i, Nan::New(signature[i])).FromJust();
-  };
+static napi_value genSignatureTrits(napi_env env, napi_callback_info info) {
+  napi_value argv[4];
+  size_t argc = getArgs(env, info, argv);
+  GenSignatureTritsArgs args;
+
+  if (!parseGenSignatureTritsArgs(env, argc, argv, args)) {
+    return NULL;
+  }
+
+  std::vector<trit_t> signature(entangled::kIssFragmentTrits *
+                                std::min<size_t>(args.security, entangled::kIssMaxSecurity));
+  bool valid = entangled::issSignatureTrits(args.seed, args.index, args.security, args.bundle, signature.data());
+
+  memset_safe((void *)args.seed, 243, 0, 243);
+
+  if (!valid) {
+    return throwError(env, kInvalidSeedMessage);
+  }
+  return newTritsArray(env, signature.data(), signature.size());
+}
+
+class GenSignatureTritsWorker : public Worker {
+ public:
+  GenSignatureTritsWorker(GenSignatureTritsArgs const &args) : args_(args) {}
+
+  ~GenSignatureTritsWorker() { memset_safe((void *)args_.seed, 243, 0, 243); }
+
+  void Execute() {
+    signature_.resize(entangled::kIssFragmentTrits * std::min<size_t>(args_.security, entangled::kIssMaxSecurity));
+    bool valid = entangled::issSignatureTrits(args_.seed, args_.index, args_.security, args_.bundle, signature_.data());
+    memset_safe((void *)args_.seed, 243, 0, 243);
+    if (!valid) {
+      SetErrorMessage(kInvalidSeedMessage);
+    }
+  }
+
+  napi_value Result(napi_env env) { return newTritsArray(env, signature_.data(), signature_.size()); }
 
-  info.GetReturnValue().Set(ret);
+ private:
+  GenSignatureTritsArgs args_;
+  std::vector<trit_t> signature_;
+};
+
+static napi_value genSignatureTritsAsync(napi_env env, napi_callback_info info) {
+  napi_value argv[5];
+  size_t argc = getArgs(env, info, argv);
+  GenSignatureTritsArgs args;
+
+  if (!parseGenSignatureTritsArgs(env, argc, argv, args)) {
+    return NULL;
+  }
+
+  if (argc < 5 || !isType(env, argv[4], napi_function)) {
+    memset_safe((void *)args.seed, 243, 0, 243);
+    return throwError(env, "Wrong arguments");
+  }
+
+  queueWorker(env, new GenSignatureTritsWorker(args), argv[4], "entangled:genSignatureTrits",
+              entangled::PRIORITY_INTERACTIVE);
+  memset_safe((void *)args.seed, 243, 0, 243);
+  return NULL;
 }
 
-static NAN_METHOD(transactionHash) {
-  if (info.Length() < 1) {
-    Nan::ThrowError("Wrong number of arguments");
-    return;
+/*
+ * Transaction hash
+ */
+
+static bool parseTransactionHashArgs(napi_env env, size_t argc, napi_value const *argv, std::string &trytes) {
+  if (argc < 1) {
+    throwError(env, "Wrong number of arguments");
+    return false;
   }
 
-  if (!info[0]->IsString()) {
-    Nan::ThrowError("Wrong arguments");
-    return;
+  if (!isType(env, argv[0], napi_string)) {
+    throwError(env, "Wrong arguments");
+    return false;
   }
 
+  trytes = readString(env, argv[0]);
+  return true;
+}
+
+static napi_value transactionHash(napi_env env, napi_callback_info info) {
+  napi_value argv[1];
+  size_t argc = getArgs(env, info, argv);
+  std::string trytes;
   char *hash = NULL;
-  std::string trytes(*Nan::Utf8String(info[0]));
-  auto ctrytes = trytes.c_str();
 
-  if ((hash = iota_digest(ctrytes)) == NULL) {
-    Nan::ThrowError("Binding iota_digest failed");
-    return;
+  if (!parseTransactionHashArgs(env, argc, argv, trytes)) {
+    return NULL;
+  }
+
+  if ((hash = iota_digest(trytes.c_str())) == NULL) {
+    return throwError(env, "Binding iota_digest failed");
   }
 
-  auto ret = Nan::New(hash).ToLocalChecked();
+  napi_value ret = newString(env, hash);
   free(hash);
+  return ret;
+}
+
+class TransactionHashWorker : public Worker {
+ public:
+  TransactionHashWorker(std::string const &trytes) : trytes_(trytes), hash_(NULL) {}
+
+  ~TransactionHashWorker() { free(hash_); }
+
+  void Execute() {
+    if ((hash_ = iota_digest(trytes_.c_str())) == NULL) {
+      SetErrorMessage("Binding iota_digest failed");
+    }
+  }
 
-  info.GetReturnValue().Set(ret);
+  napi_value Result(napi_env env) { return newString(env, hash_); }
+
+ private:
+  std::string trytes_;
+  char *hash_;
+};
+
+static napi_value transactionHashAsync(napi_env env, napi_callback_info info) {
+  napi_value argv[2];
+  size_t argc = getArgs(env, info, argv);
+  std::string trytes;
+
+  if (!parseTransactionHashArgs(env, argc, argv, trytes)) {
+    return NULL;
+  }
+
+  if (argc < 2 || !isType(env, argv[1], napi_function)) {
+    return throwError(env, "Wrong arguments");
+  }
+
+  queueWorker(env, new TransactionHashWorker(trytes), argv[1], "entangled:transactionHash",
+              entangled::PRIORITY_INTERACTIVE);
+  return NULL;
 }
 
-static NAN_METHOD(bundleMiner) {
-  uint64_t index = 0;
+/*
+ * Batch transaction hashing. Transactions are hashed by the bitsliced kernels, one per lane, rather than one at a time
+ * through iota_digest.
+ */
+
+class TransactionHashesWorker : public Worker {
+ public:
+  TransactionHashesWorker(std::string &trytes, bool weights)
+      : count_(trytes.size() / entangled::kTransactionTrytes),
+        hashes_(count_ * entangled::kHashTrytes, '9'),
+        withWeights_(weights),
+        weights_(weights ? count_ : 0) {
+    trytes_.swap(trytes);
+  }
 
-  if (info.Length() != 8) {
-    Nan::ThrowError("Wrong number of arguments");
-    return;
+  void Execute() {
+    if (!entangled::transactionHashes(trytes_.data(), count_, &hashes_[0], weights_.empty() ? NULL : weights_.data(),
+                                      &entangled::Scheduler::instance(), entangled::PRIORITY_INTERACTIVE)) {
+      SetErrorMessage("Invalid transaction trytes", "EINVAL");
+    }
   }
 
-  if (!info[0]->IsArray() || !info[1]->IsNumber() || !info[2]->IsArray() || !info[3]->IsNumber() ||
-      !info[4]->IsNumber() || !info[5]->IsNumber() || !info[6]->IsNumber() || !info[7]->IsNumber()) {
-    Nan::ThrowError("Wrong arguments");
-    return;
+  napi_value Result(napi_env env) {
+    napi_value hashes;
+
+    napi_create_array_with_length(env, count_, &hashes);
+    for (size_t i = 0; i < count_; i++) {
+      napi_set_element(env, hashes, i, newString(env, &hashes_[i * entangled::kHashTrytes], entangled::kHashTrytes));
+    }
+    if (!withWeights_) {
+      return hashes;
+    }
+
+    // Weights come as a Uint8Array next to the hashes
+    napi_value ret, buffer, weights;
+    void *data = NULL;
+
+    napi_create_arraybuffer(env, weights_.size(), &data, &buffer);
+    if (!weights_.empty()) {
+      memcpy(data, weights_.data(), weights_.size());
+    }
+    napi_create_typedarray(env, napi_uint8_array, weights_.size(), buffer, 0, &weights);
+    napi_create_object(env, &ret);
+    napi_set_named_property(env, ret, "hashes", hashes);
+    napi_set_named_property(env, ret, "weights", weights);
+    return ret;
   }
 
-  byte_t bundleNormalizedMax[81];
-  v8::Local<v8::Array> bundle_array = v8::Local<v8::Array>::Cast(info[0]);
-  for (size_t i = 0; i < bundle_array->Length(); i++) {
-    bundleNormalizedMax[i] = bundle_array->Get(Nan::GetCurrentContext(), i)
-                                 .ToLocalChecked()
-                                 ->NumberValue(Nan::GetCurrentContext())
-                                 .FromJust();
+ private:
+  std::string trytes_;
+  size_t count_;
+  std::string hashes_;
+  bool withWeights_;
+  std::vector<uint8_t> weights_;
+};
+
+static napi_value transactionHashesAsync(napi_env env, napi_callback_info info) {
+  napi_value argv[3];
+  size_t argc = getArgs(env, info, argv);
+  std::string trytes;
+  bool isBuffer = false;
+  bool weights = false;
+
+  if (argc < 3 || !isType(env, argv[1], napi_boolean) || !isType(env, argv[2], napi_function)) {
+    return throwError(env, "Wrong arguments");
+  }
+  napi_get_value_bool(env, argv[1], &weights);
+
+  // Packed trytes, as read from a feed, or an array of transaction trytes
+  napi_is_buffer(env, argv[0], &isBuffer);
+  if (isBuffer) {
+    void *data = NULL;
+    size_t length = 0;
+
+    napi_get_buffer_info(env, argv[0], &data, &length);
+    if (length % entangled::kTransactionTrytes != 0) {
+      return throwError(env, "Buffer length is not a multiple of the transaction length", "EINVAL");
+    }
+    trytes.assign(static_cast<char const *>(data), length);
+  } else if (isArray(env, argv[0])) {
+    uint32_t count = arrayLength(env, argv[0]);
+
+    trytes.reserve(count * entangled::kTransactionTrytes);
+    for (uint32_t i = 0; i < count; i++) {
+      napi_value element;
+      napi_get_element(env, argv[0], i, &element);
+      if (!isType(env, element, napi_string)) {
+        return throwError(env, "Wrong arguments");
+      }
+      std::string tx = readString(env, element);
+      if (tx.size() != entangled::kTransactionTrytes) {
+        return throwError(env, "Invalid transaction trytes", "EINVAL");
+      }
+      trytes += tx;
+    }
+  } else {
+    return throwError(env, "Wrong arguments");
+  }
+
+  queueWorker(env, new TransactionHashesWorker(trytes, weights), argv[2], "entangled:transactionHashes",
+              entangled::PRIORITY_INTERACTIVE);
+  return NULL;
+}
+
+/*
+ * Streaming hashers. Kerl and CurlP81 objects keep their sponge in native memory between calls, so that data can be
+ * absorbed piece by piece, and clone() copies the sponge so that a shared prefix is only absorbed once.
+ */
+
+static char const kInvalidHasherInputMessage[] = "Invalid trits or trytes, or not a multiple of 243 trits";
+
+class Hasher {
+ public:
+  virtual ~Hasher() {}
+
+  virtual void absorb(trit_t const *trits, size_t length) = 0;
+  virtual void squeeze(trit_t *trits, size_t length) = 0;
+  virtual void reset() = 0;
+
+  // Copies the sponge into a hasher of the same class
+  virtual void copyTo(Hasher *other) const = 0;
+
+  virtual napi_ref constructor(Instance const &instance) const = 0;
+};
+
+template <typename Sponge, napi_ref Instance::*Constructor>
+class SpongeHasher : public Hasher {
+ public:
+  // The sponge may have absorbed a seed
+  ~SpongeHasher() { memset_safe((void *)&sponge_, sizeof(sponge_), 0, sizeof(sponge_)); }
+
+  void absorb(trit_t const *trits, size_t length) { sponge_.absorb(trits, length); }
+  void squeeze(trit_t *trits, size_t length) { sponge_.squeeze(trits, length); }
+  void reset() { sponge_.reset(); }
+  void copyTo(Hasher *other) const { static_cast<SpongeHasher *>(other)->sponge_ = sponge_; }
+  napi_ref constructor(Instance const &instance) const { return instance.*Constructor; }
+
+ private:
+  Sponge sponge_;
+};
+
+typedef SpongeHasher<entangled::Kerl, &Instance::kerlConstructor> KerlHasher;
+typedef SpongeHasher<entangled::Curl, &Instance::curlConstructor> CurlHasher;
+
+static void onHasherFinalize(napi_env env, void *data, void *hint) { delete static_cast<Hasher *>(data); }
+
+template <typename T>
+static napi_value newHasher(napi_env env, napi_callback_info info) {
+  napi_value self, target = NULL;
+  T *hasher = new T();
+
+  napi_get_new_target(env, info, &target);
+  napi_get_cb_info(env, info, NULL, NULL, &self, NULL);
+  if (target == NULL || napi_wrap(env, self, hasher, onHasherFinalize, NULL, NULL) != napi_ok) {
+    delete hasher;
+    return throwError(env, "Hashers must be created with new");
+  }
+  return self;
+}
+
+// Unwraps the hasher a method is called on, which must be of the class the method is defined on
+template <size_t N>
+static Hasher *getHasher(napi_env env, napi_callback_info info, napi_value (&argv)[N], size_t &argc,
+                         napi_value &self) {
+  void *data = NULL;
+  napi_value constructor;
+  bool instance = false;
+
+  argc = N;
+  napi_get_cb_info(env, info, &argc, argv, &self, &data);
+  if (napi_get_reference_value(env, *static_cast<napi_ref *>(data), &constructor) != napi_ok ||
+      napi_instanceof(env, self, constructor, &instance) != napi_ok || !instance ||
+      napi_unwrap(env, self, &data) != napi_ok) {
+    throwError(env, "Wrong arguments");
+    return NULL;
+  }
+  return static_cast<Hasher *>(data);
+}
+
+// Reads trits from an Array or an Int8Array, or trytes from a string or a Buffer, as whole 243 trit blocks
+static bool readHasherInput(napi_env env, napi_value value, std::vector<trit_t> &trits) {
+  bool isBuffer = false, isTypedArray = false;
+  napi_typedarray_type type = napi_uint8_array;
+  size_t length = 0;
+  void *data = NULL;
+
+  napi_is_typedarray(env, value, &isTypedArray);
+  if (isTypedArray) {
+    napi_get_typedarray_info(env, value, &type, &length, &data, NULL, NULL);
+  }
+
+  // Checked first, as napi_is_buffer() is true for any typed array on recent Node.js releases
+  if (type == napi_int8_array) {
+    trits.assign(static_cast<trit_t *>(data), static_cast<trit_t *>(data) + length);
+  } else if (type != napi_uint8_array) {
+    return false;
+  } else if (isArray(env, value)) {
+    trits.resize(arrayLength(env, value));
+    readTrits(env, value, trits.data(), trits.size());
+  } else {
+    std::string trytes;
+    napi_is_buffer(env, value, &isBuffer);
+    if (isBuffer) {
+      napi_get_buffer_info(env, value, &data, &length);
+    } else if (isType(env, value, napi_string)) {
+      trytes = readString(env, value);
+      data = (void *)trytes.data();
+      length = trytes.size();
+    } else {
+      return false;
+    }
+    trits.resize(3 * length);
+    return length % entangled::kHashTrytes == 0 &&
+           entangled::trytesToTrits(static_cast<char *>(data), length, trits.data());
+  }
+
+  // Curl-P indexes its truth table with the trits
+  return trits.size() % entangled::kHashTrits == 0 &&
+         std::all_of(trits.begin(), trits.end(), [](trit_t trit) { return trit >= -1 && trit <= 1; });
+}
+
+// Reads the length to squeeze, a positive multiple of unit defaulting to unit
+static bool readSqueezeLength(napi_env env, size_t argc, napi_value const *argv, size_t unit, size_t &length) {
+  length = unit;
+  if (argc < 1 || isType(env, argv[0], napi_undefined)) {
+    return true;
+  }
+
+  if (!isType(env, argv[0], napi_number)) {
+    throwError(env, "Wrong arguments");
+    return false;
+  }
+
+  length = readUint32(env, argv[0]);
+  if (length == 0 || length % unit != 0) {
+    throwError(env, "Squeezed length must be a positive multiple of 243 trits");
+    return false;
+  }
+  return true;
+}
+
+static napi_value hasherAbsorb(napi_env env, napi_callback_info info) {
+  napi_value argv[1], self;
+  size_t argc;
+  Hasher *hasher = getHasher(env, info, argv, argc, self);
+  std::vector<trit_t> trits;
+
+  if (hasher == NULL) {
+    return NULL;
+  }
+
+  if (argc < 1) {
+    return throwError(env, "Wrong number of arguments");
+  }
+
+  if (!readHasherInput(env, argv[0], trits)) {
+    return throwError(env, kInvalidHasherInputMessage);
+  }
+
+  hasher->absorb(trits.data(), trits.size());
+  return self;
+}
+
+static napi_value hasherSqueeze(napi_env env, napi_callback_info info) {
+  napi_value argv[1], self;
+  size_t argc, length;
+  Hasher *hasher = getHasher(env, info, argv, argc, self);
+
+  if (hasher == NULL || !readSqueezeLength(env, argc, argv, entangled::kHashTrits, length)) {
+    return NULL;
+  }
+
+  std::vector<trit_t> trits(length);
+  hasher->squeeze(trits.data(), length);
+  return newTritsArray(env, trits.data(), length);
+}
+
+static napi_value hasherSqueezeTrytes(napi_env env, napi_callback_info info) {
+  napi_value argv[1], self;
+  size_t argc, length;
+  Hasher *hasher = getHasher(env, info, argv, argc, self);
+
+  if (hasher == NULL || !readSqueezeLength(env, argc, argv, entangled::kHashTrytes, length)) {
+    return NULL;
+  }
+
+  std::vector<trit_t> trits(3 * length);
+  std::string trytes(length, '9');
+  hasher->squeeze(trits.data(), trits.size());
+  entangled::tritsToTrytes(trits.data(), length, &trytes[0]);
+  return newString(env, trytes);
+}
+
+static napi_value hasherReset(napi_env env, napi_callback_info info) {
+  napi_value argv[1], self;
+  size_t argc;
+  Hasher *hasher = getHasher(env, info, argv, argc, self);
+
+  if (hasher == NULL) {
+    return NULL;
+  }
+
+  hasher->reset();
+  return self;
+}
+
+static napi_value hasherClone(napi_env env, napi_callback_info info) {
+  napi_value argv[1], self, constructor, ret;
+  size_t argc;
+  Hasher *hasher = getHasher(env, info, argv, argc, self);
+  void *data = NULL;
+
+  if (hasher == NULL) {
+    return NULL;
   }
 
-  uint8_t security = static_cast<uint8_t>(Nan::To<unsigned>(info[1]).FromJust());
-  size_t essenceLength = static_cast<size_t>(Nan::To<unsigned>(info[3]).FromJust());
-  trit_t *essence = (trit_t *)malloc(sizeof(trit_t) * essenceLength);
-  v8::Local<v8::Array> essence_array = v8::Local<v8::Array>::Cast(info[2]);
-  for (size_t i = 0; i < essence_array->Length(); i++) {
-    essence[i] = essence_array->Get(Nan::GetCurrentContext(), i)
-                     .ToLocalChecked()
-                     ->NumberValue(Nan::GetCurrentContext())
-                     .FromJust();
+  napi_get_reference_value(env, hasher->constructor(*getInstance(env)), &constructor);
+  if (napi_new_instance(env, constructor, 0, NULL, &ret) != napi_ok || napi_unwrap(env, ret, &data) != napi_ok) {
+    return NULL;
+  }
+  hasher->copyTo(static_cast<Hasher *>(data));
+  return ret;
+}
+
+// The methods get the reference to their class, only set once the class is defined
+static napi_value defineHasher(napi_env env, char const *name, napi_callback constructor, napi_ref &ref) {
+  napi_property_descriptor methods[] = {
+      METHOD("absorb", hasherAbsorb, &ref),
+      METHOD("squeeze", hasherSqueeze, &ref),
+      METHOD("squeezeTrytes", hasherSqueezeTrytes, &ref),
+      METHOD("reset", hasherReset, &ref),
+      METHOD("clone", hasherClone, &ref),
+  };
+  napi_value ret;
+
+  napi_define_class(env, name, NAPI_AUTO_LENGTH, constructor, NULL, sizeof(methods) / sizeof(methods[0]), methods,
+                    &ret);
+  napi_create_reference(env, ret, 1, &ref);
+  return ret;
+}
+
+/*
+ * Bundle miner
+ */
+
+struct BundleMinerArgs {
+  byte_t bundleNormalizedMax[81];
+  uint8_t security;
+  std::vector<trit_t> essence;
+  uint32_t count;
+  uint8_t nprocs;
+  uint32_t miningThreshold;
+  bool fullySecure;
+};
+
+static bool parseBundleMinerArgs(napi_env env, size_t argc, napi_value const *argv, BundleMinerArgs &args) {
+  if (argc < 8) {
+    throwError(env, "Wrong number of arguments");
+    return false;
   }
-  uint32_t count = static_cast<uint32_t>(Nan::To<unsigned>(info[4]).FromJust());
-  uint8_t nprocs = static_cast<uint8_t>(Nan::To<unsigned>(info[5]).FromJust());
 
-  uint32_t miningThreshold = static_cast<uint32_t>(Nan::To<unsigned>(info[6]).FromJust());
+  if (!isArray(env, argv[0]) || !isType(env, argv[1], napi_number) || !isArray(env, argv[2])) {
+    throwError(env, "Wrong arguments");
+    return false;
+  }
+  for (size_t i = 3; i < 8; i++) {
+    if (!isType(env, argv[i], napi_number)) {
+      throwError(env, "Wrong arguments");
+      return false;
+    }
+  }
 
-  uint8_t fullySecure = static_cast<uint8_t>(Nan::To<unsigned>(info[7]).FromJust());
+  memset(args.bundleNormalizedMax, 0, sizeof(args.bundleNormalizedMax));
+  readInts(env, argv[0], args.bundleNormalizedMax, 81);
+  args.security = static_cast<uint8_t>(readUint32(env, argv[1]));
+  size_t essenceLength = readUint32(env, argv[3]);
+  args.essence.assign(essenceLength, 0);
+  readTrits(env, argv[2], args.essence.data(), essenceLength);
+  args.count = readUint32(env, argv[4]);
+  args.nprocs = static_cast<uint8_t>(readUint32(env, argv[5]));
+  args.miningThreshold = readUint32(env, argv[6]);
+  args.fullySecure = readUint32(env, argv[7]) == 1;
+  return true;
+}
 
+static bool doBundleMiner(BundleMinerArgs &args, uint64_t &index) {
   bundle_miner_ctx_t *ctxs = NULL;
   size_t num_ctxs = 0;
   bool found_optimal_index = false;
 
-  bundle_miner_allocate_ctxs(nprocs, &ctxs, &num_ctxs);
+  bundle_miner_allocate_ctxs(args.nprocs, &ctxs, &num_ctxs);
 
-  if (bundle_miner_mine(bundleNormalizedMax, security, essence, essenceLength, count, miningThreshold,
-                        fullySecure == 1 ? true : false, &index, ctxs, num_ctxs, &found_optimal_index) != RC_OK) {
+  if (bundle_miner_mine(args.bundleNormalizedMax, args.security, args.essence.data(), args.essence.size(), args.count,
+                        args.miningThreshold, args.fullySecure, &index, ctxs, num_ctxs,
+                        &found_optimal_index) != RC_OK) {
     bundle_miner_deallocate_ctxs(&ctxs);
-
-    info.GetReturnValue().Set(-1);
-    free(essence);
-    Nan::ThrowError("Bundle mining failed");
-    return;
+    return false;
   }
 
   bundle_miner_deallocate_ctxs(&ctxs);
+  return true;
+}
+
+static napi_value bundleMiner(napi_env env, napi_callback_info info) {
+  napi_value argv[8], ret;
+  size_t argc = getArgs(env, info, argv);
+  BundleMinerArgs args;
+  uint64_t index = 0;
+
+  if (argc != 8) {
+    return throwError(env, "Wrong number of arguments");
+  }
+
+  if (!parseBundleMinerArgs(env, argc, argv, args)) {
+    return NULL;
+  }
+
+  if (!doBundleMiner(args, index)) {
+    return throwError(env, "Bundle mining failed");
+  }
+
+  napi_create_uint32(env, static_cast<uint32_t>(index), &ret);
+  return ret;
+}
 
-  info.GetReturnValue().Set(static_cast<uint32_t>(index));
-  free(essence);
+class BundleMinerWorker : public Worker {
+ public:
+  BundleMinerWorker(BundleMinerArgs const &args) : args_(args), index_(0) {}
+
+  void Execute() {
+    if (!doBundleMiner(args_, index_)) {
+      SetErrorMessage("Bundle mining failed");
+    }
+  }
+
+  napi_value Result(napi_env env) {
+    napi_value ret;
+    napi_create_uint32(env, static_cast<uint32_t>(index_), &ret);
+    return ret;
+  }
+
+ private:
+  BundleMinerArgs args_;
+  uint64_t index_;
+};
+
+static napi_value bundleMinerAsync(napi_env env, napi_callback_info info) {
+  napi_value argv[9];
+  size_t argc = getArgs(env, info, argv);
+  BundleMinerArgs args;
+
+  if (argc != 9 || !isType(env, argv[8], napi_function)) {
+    return throwError(env, "Wrong number of arguments");
+  }
+
+  if (!parseBundleMinerArgs(env, argc, argv, args)) {
+    return NULL;
+  }
+
+  queueWorker(env, new BundleMinerWorker(args), argv[8], "entangled:bundleMiner", entangled::PRIORITY_BULK);
+  return NULL;
+}
+
+/*
+ * Job ring. JS packs transactionHash and address jobs into a SharedArrayBuffer and kicks the ring once per batch;
+ * it is called back once per batch of completions.
+ */
+
+struct JobRingHandle {
+  std::shared_ptr<entangled::JobRing> ring;
+  std::shared_ptr<Completion> completion;
+  napi_ref memory;
+};
+
+static bool runRingJob(uint8_t *slot) {
+  size_t length = std::min<size_t>(std::max(0, entangled::ringSlotField(slot, entangled::kRingSlotInputLength)),
+                                   entangled::kRingSlotInputBytes);
+  std::string input(reinterpret_cast<char *>(slot + entangled::kRingSlotInput), length);
+  char *output = NULL;
+
+  switch (entangled::ringSlotField(slot, entangled::kRingSlotKind)) {
+    case entangled::RING_JOB_TRANSACTION_HASH:
+      output = iota_digest(input.c_str());
+      break;
+    case entangled::RING_JOB_ADDRESS_TRYTES:
+      output = static_cast<char *>(calloc(entangled::kHashTrytes + 1, 1));
+      if (output != NULL &&
+          !entangled::issAddressTrytes(input.data(), input.size(),
+                                       entangled::ringSlotField(slot, entangled::kRingSlotIndex),
+                                       entangled::ringSlotField(slot, entangled::kRingSlotSecurity), output)) {
+        free(output);
+        output = NULL;
+      }
+      // Seeds do not outlive their job, neither here nor in the shared memory
+      scrubString(input);
+      memset_safe(slot + entangled::kRingSlotInput, length, 0, length);
+      break;
+  }
+
+  if (output == NULL) {
+    return false;
+  }
+  memcpy(slot + entangled::kRingSlotOutput, output, std::min(strlen(output), entangled::kRingSlotOutputBytes));
+  free(output);
+  return true;
+}
+
+static void onJobRingNotify(napi_env env, napi_value callback, void *context, void *data) {
+  if (env != NULL) {
+    napi_value undefined;
+    napi_get_undefined(env, &undefined);
+    napi_call_function(env, undefined, callback, 0, NULL, NULL);
+  }
+}
+
+static void onJobRingFinalize(napi_env env, void *data, void *hint) {
+  std::shared_ptr<JobRingHandle> *handle = static_cast<std::shared_ptr<JobRingHandle> *>(data);
+
+  // Jobs still running write into the shared memory, which may only be released once they are done
+  (*handle)->ring->close();
+  (*handle)->ring->wait();
+  napi_delete_reference(env, (*handle)->memory);
+  delete handle;
+}
+
+static void onJobRingCollected(napi_env env, void *data, void *hint) {
+  std::shared_ptr<JobRingHandle> *handle = static_cast<std::shared_ptr<JobRingHandle> *>(data);
+
+  (*handle)->ring->close();
+  (*handle)->completion->abandon();
+  delete handle;
+}
+
+static JobRingHandle *getJobRing(napi_env env, napi_value value) {
+  void *data = NULL;
+
+  if (!isType(env, value, napi_external) || napi_get_value_external(env, value, &data) != napi_ok) {
+    throwError(env, "Wrong arguments");
+    return NULL;
+  }
+  return static_cast<std::shared_ptr<JobRingHandle> *>(data)->get();
+}
+
+static napi_value jobRingLayout(napi_env env) {
+  napi_value layout;
+
+  napi_create_object(env, &layout);
+  napi_set_named_property(env, layout, "headerBytes", newNumber(env, entangled::kRingHeaderBytes));
+  napi_set_named_property(env, layout, "head", newNumber(env, entangled::kRingHead / 4));
+  napi_set_named_property(env, layout, "tail", newNumber(env, entangled::kRingTail / 4));
+  napi_set_named_property(env, layout, "completed", newNumber(env, entangled::kRingCompleted / 4));
+  napi_set_named_property(env, layout, "notify", newNumber(env, entangled::kRingNotify / 4));
+  napi_set_named_property(env, layout, "slotBytes", newNumber(env, entangled::kRingSlotBytes));
+  napi_set_named_property(env, layout, "state", newNumber(env, entangled::kRingSlotState));
+  napi_set_named_property(env, layout, "kind", newNumber(env, entangled::kRingSlotKind));
+  napi_set_named_property(env, layout, "index", newNumber(env, entangled::kRingSlotIndex));
+  napi_set_named_property(env, layout, "security", newNumber(env, entangled::kRingSlotSecurity));
+  napi_set_named_property(env, layout, "inputLength", newNumber(env, entangled::kRingSlotInputLength));
+  napi_set_named_property(env, layout, "input", newNumber(env, entangled::kRingSlotInput));
+  napi_set_named_property(env, layout, "inputBytes", newNumber(env, entangled::kRingSlotInputBytes));
+  napi_set_named_property(env, layout, "output", newNumber(env, entangled::kRingSlotOutput));
+  napi_set_named_property(env, layout, "outputBytes", newNumber(env, entangled::kRingSlotOutputBytes));
+  napi_set_named_property(env, layout, "transactionHash", newNumber(env, entangled::RING_JOB_TRANSACTION_HASH));
+  napi_set_named_property(env, layout, "addressTrytes", newNumber(env, entangled::RING_JOB_ADDRESS_TRYTES));
+  return layout;
+}
+
+static napi_value createJobRing(napi_env env, napi_callback_info info) {
+  napi_value argv[3], ret;
+  size_t argc = getArgs(env, info, argv);
+  napi_typedarray_type type;
+  size_t length = 0;
+  void *data = NULL;
+  bool isTypedArray = false;
+
+  if (argc < 3) {
+    return throwError(env, "Wrong number of arguments");
+  }
+
+  napi_is_typedarray(env, argv[0], &isTypedArray);
+  if (!isTypedArray || !isType(env, argv[1], napi_number) || !isType(env, argv[2], napi_function)) {
+    return throwError(env, "Wrong arguments");
+  }
+
+  uint32_t slots = readUint32(env, argv[1]);
+  napi_get_typedarray_info(env, argv[0], &type, &length, &data, NULL, NULL);
+  if (type != napi_uint8_array || slots == 0 || (slots & (slots - 1)) != 0 ||
+      length < entangled::kRingHeaderBytes + slots * entangled::kRingSlotBytes ||
+      reinterpret_cast<uintptr_t>(data) % sizeof(int32_t) != 0) {
+    return throwError(env, "Invalid job ring memory");
+  }
+
+  std::shared_ptr<JobRingHandle> handle = std::make_shared<JobRingHandle>();
+  std::shared_ptr<JobRingHandle> *context = new std::shared_ptr<JobRingHandle>(handle);
+  handle->completion =
+      Completion::create(env, argv[2], "entangled:jobRing", 0, context, onJobRingFinalize, onJobRingNotify);
+  if (handle->completion == NULL) {
+    delete context;
+    return throwError(env, "Could not create the completion callback");
+  }
+  // An idle ring does not keep the process alive, JS refs it while jobs are in flight
+  handle->completion->ref(env, false);
+  napi_create_reference(env, argv[0], 1, &handle->memory);
+
+  std::shared_ptr<Completion> completion = handle->completion;
+  handle->ring = std::make_shared<entangled::JobRing>(static_cast<uint8_t *>(data), slots,
+                                                      entangled::PRIORITY_INTERACTIVE, runRingJob,
+                                                      [completion] { completion->post(NULL); });
+
+  napi_create_external(env, new std::shared_ptr<JobRingHandle>(handle), onJobRingCollected, NULL, &ret);
+  return ret;
+}
+
+static napi_value jobRingKick(napi_env env, napi_callback_info info) {
+  napi_value argv[1];
+  JobRingHandle *handle;
+
+  getArgs(env, info, argv);
+  if ((handle = getJobRing(env, argv[0])) != NULL) {
+    handle->ring->kick();
+  }
+  return NULL;
+}
+
+static napi_value jobRingRef(napi_env env, napi_callback_info info) {
+  napi_value argv[2];
+  JobRingHandle *handle;
+  bool ref = false;
+
+  getArgs(env, info, argv);
+  if ((handle = getJobRing(env, argv[0])) != NULL) {
+    napi_get_value_bool(env, argv[1], &ref);
+    handle->completion->ref(env, ref);
+  }
+  return NULL;
+}
+
+static napi_value jobRingClose(napi_env env, napi_callback_info info) {
+  napi_value argv[1];
+  JobRingHandle *handle;
+
+  getArgs(env, info, argv);
+  if ((handle = getJobRing(env, argv[0])) != NULL) {
+    handle->ring->close();
+    handle->completion->abandon();
+  }
+  return NULL;
 }
 
-NAN_MODULE_INIT(Init) {
-  NAN_EXPORT(target, powTrytes);
-  NAN_EXPORT(target, powBundle);
-  NAN_EXPORT(target, genAddressTrytes);
-  NAN_EXPORT(target, genAddressTrits);
-  NAN_EXPORT(target, genSignatureTrytes);
-  NAN_EXPORT(target, genSignatureTrits);
-  NAN_EXPORT(target, transactionHash);
-  NAN_EXPORT(target, bundleMiner);
+/*
+ * Module initialization, once per instance
+ */
+
+static std::atomic<size_t> liveInstances(0);
+
+// Pending jobs are cancelled as their thread-safe functions are finalized. The last instance resets the Proof of Work
+// backend, stopping the I/O thread of a worker backend.
+static void onInstanceFinalize(napi_env env, void *data, void *hint) {
+  std::shared_ptr<Instance> *instance = static_cast<std::shared_ptr<Instance> *>(data);
+
+  napi_delete_reference(env, (*instance)->kerlConstructor);
+  napi_delete_reference(env, (*instance)->curlConstructor);
+  delete instance;
+  if (--liveInstances == 0) {
+    entangled::setPowBackend(std::make_shared<entangled::LocalPowBackend>());
+  }
 }
 
-NODE_MODULE(NODE_GYP_MODULE_NAME, Init)
+NAPI_MODULE_INIT() {
+  std::shared_ptr<Instance> *instance = new std::shared_ptr<Instance>(std::make_shared<Instance>());
+  napi_property_descriptor properties[] = {
+      EXPORT(schedulerStats),
+      EXPORT(setQueueCapacity),
+      EXPORT(setPowDefaults),
+      EXPORT(midstateCacheStats),
+      EXPORT(setMidstateCacheCapacity),
+      EXPORT(powKernels),
+      EXPORT(setPowKernel),
+      EXPORT(setPowBackend),
+      EXPORT(powBenchmarkAsync),
+      EXPORT(cancelJob),
+      EXPORT(jobProgress),
+      EXPORT(powTrytes),
+      EXPORT(powTrytesAsync),
+      EXPORT(powTrytesBatchAsync),
+      EXPORT(powBundle),
+      EXPORT(powBundleAsync),
+      EXPORT(powBundlesAsync),
+      EXPORT(hashcashAsync),
+      EXPORT(genAddressTrytes),
+      EXPORT(genAddressTrytesAsync),
+      EXPORT(genAddressTrits),
+      EXPORT(genAddressTritsAsync),
+      EXPORT(genAddressRangeAsync),
+      EXPORT(genAddressBatchAsync),
+      EXPORT(genSignatureTrytes),
+      EXPORT(genSignatureTrytesAsync),
+      EXPORT(genSignatureTrits),
+      EXPORT(genSignatureTritsAsync),
+      EXPORT(transactionHash),
+      EXPORT(transactionHashAsync),
+      EXPORT(transactionHashesAsync),
+      EXPORT(bundleMiner),
+      EXPORT(bundleMinerAsync),
+      EXPORT(createJobRing),
+      EXPORT(jobRingKick),
+      EXPORT(jobRingRef),
+      EXPORT(jobRingClose),
+      {"jobRingLayout", NULL, NULL, NULL, NULL, jobRingLayout(env), napi_enumerable, NULL},
+      {"Kerl", NULL, NULL, NULL, NULL, defineHasher(env, "Kerl", newHasher<KerlHasher>, (*instance)->kerlConstructor),
+       napi_enumerable, NULL},
+      {"CurlP81", NULL, NULL, NULL, NULL,
+       defineHasher(env, "CurlP81", newHasher<CurlHasher>, (*instance)->curlConstructor), napi_enumerable, NULL},
+  };
+
+  (*instance)->powNextJobId = 1;
+  if (napi_set_instance_data(env, instance, onInstanceFinalize, NULL) != napi_ok) {
+    delete instance;
+    return NULL;
+  }
+  liveInstances++;
+
+  napi_define_properties(env, exports, sizeof(properties) / sizeof(properties[0]), properties);
+  return exports;
+}
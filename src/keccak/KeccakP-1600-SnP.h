@@ -18,7 +18,7 @@ Please refer to SnP-documentation.h for more details.
 #ifndef _KeccakP_1600_SnP_h_
 #define _KeccakP_1600_SnP_h_
 
-#define KeccakP1600_implementation "64-bit reference implementation"
+#define KeccakP1600_implementation "64-bit optimised implementation (lane complementing, all rounds unrolled)"
 #define KeccakP1600_stateSizeInBytes 200
 #define KeccakP1600_stateAlignment 8
 
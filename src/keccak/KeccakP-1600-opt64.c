@@ -0,0 +1,290 @@
+/*
+Implementation by the Keccak Team, namely, Guido Bertoni, Joan Daemen,
+Michaël Peeters, Gilles Van Assche and Ronny Van Keer,
+hereby denoted as "the implementer".
+
+For more information, feedback or questions, please refer to our website:
+https://keccak.team/
+
+To the extent possible under law, the implementer has waived all copyright
+and related or neighboring rights to the source code in this file.
+http://creativecommons.org/publicdomain/zero/1.0/
+
+---
+
+This file implements Keccak-p[1600] in a SnP-compatible way, following the
+optimised 64-bit implementation of the Keccak Code Package:
+- the state is permuted in place, as 25 lanes of 64 bits, without converting
+  it from and to bytes;
+- rounds are fully unrolled, two at a time, theta, rho, pi, chi and iota being
+  merged into a single pass over the lanes kept in local variables;
+- lanes 1, 2, 8, 12, 17 and 20 are kept complemented ("lane complementing",
+  the Bebigokimisa pattern), which turns most of the NOT operations of chi
+  into ANDs and ORs. The byte functions below undo it.
+
+This implementation comes with KeccakP-1600-SnP.h in the same folder.
+*/
+
+#include "brg_endian.h"
+#include <assert.h>
+#include <string.h>
+
+typedef unsigned char UINT8;
+typedef unsigned long long UINT64;
+typedef UINT64 tKeccakLane;
+
+#define maxNrRounds 24
+#define nrLanes 25
+
+static const tKeccakLane KeccakRoundConstants[maxNrRounds] = {
+    0x0000000000000001ULL, 0x0000000000008082ULL, 0x800000000000808aULL,
+    0x8000000080008000ULL, 0x000000000000808bULL, 0x0000000080000001ULL,
+    0x8000000080008081ULL, 0x8000000000008009ULL, 0x000000000000008aULL,
+    0x0000000000000088ULL, 0x0000000080008009ULL, 0x000000008000000aULL,
+    0x000000008000808bULL, 0x800000000000008bULL, 0x8000000000008089ULL,
+    0x8000000000008003ULL, 0x8000000000008002ULL, 0x8000000000000080ULL,
+    0x000000000000800aULL, 0x800000008000000aULL, 0x8000000080008081ULL,
+    0x8000000000008080ULL, 0x0000000080000001ULL, 0x8000000080008008ULL,
+};
+
+/* Lanes stored complemented */
+static const tKeccakLane KeccakComplementedLanes[nrLanes] = {
+    0, ~0ULL, ~0ULL, 0, 0, 0, 0, 0, ~0ULL, 0, 0, 0, ~0ULL,
+    0, 0, 0, 0, ~0ULL, 0, 0, ~0ULL, 0, 0, 0, 0};
+
+#define ROL64(a, offset) ((((tKeccakLane)a) << (offset)) ^ (((tKeccakLane)a) >> (64 - (offset))))
+
+/* ---------------------------------------------------------------- */
+
+void KeccakP1600_Initialize(void *state) {
+  unsigned int i;
+
+  for (i = 0; i < nrLanes; i++)
+    ((tKeccakLane *)state)[i] = KeccakComplementedLanes[i];
+}
+
+/* ---------------------------------------------------------------- */
+
+/* Byte offset of the state in memory, lanes being stored in the platform order */
+#if (PLATFORM_BYTE_ORDER == IS_LITTLE_ENDIAN)
+#define stateByte(offset) (offset)
+#else
+#define stateByte(offset) (((offset) & ~7U) | (7U - ((offset) & 7U)))
+#endif
+
+void KeccakP1600_AddByte(void *state, unsigned char byte, unsigned int offset) {
+  assert(offset < 200);
+  ((unsigned char *)state)[stateByte(offset)] ^= byte;
+}
+
+/* ---------------------------------------------------------------- */
+
+void KeccakP1600_AddBytes(void *state, const unsigned char *data,
+                          unsigned int offset, unsigned int length) {
+  unsigned int i = 0;
+
+  assert(offset < 200);
+  assert(offset + length <= 200);
+#if (PLATFORM_BYTE_ORDER == IS_LITTLE_ENDIAN)
+  /* Whole lanes at once, complementing commuting with XOR */
+  for (; (offset + i) % 8 != 0 && i < length; i++)
+    ((unsigned char *)state)[offset + i] ^= data[i];
+  for (; i + 8 <= length; i += 8) {
+    tKeccakLane lane;
+    memcpy(&lane, data + i, 8);
+    ((tKeccakLane *)state)[(offset + i) / 8] ^= lane;
+  }
+#endif
+  for (; i < length; i++)
+    ((unsigned char *)state)[stateByte(offset + i)] ^= data[i];
+}
+
+/* ---------------------------------------------------------------- */
+
+void KeccakP1600_OverwriteBytes(void *state, const unsigned char *data,
+                                unsigned int offset, unsigned int length) {
+  unsigned int i;
+
+  assert(offset < 200);
+  assert(offset + length <= 200);
+  for (i = 0; i < length; i++)
+    ((unsigned char *)state)[stateByte(offset + i)] =
+        data[i] ^ (UINT8)KeccakComplementedLanes[(offset + i) / 8];
+}
+
+/* ---------------------------------------------------------------- */
+
+void KeccakP1600_OverwriteWithZeroes(void *state, unsigned int byteCount) {
+  unsigned int i;
+
+  assert(byteCount <= 200);
+  for (i = 0; i < byteCount; i++)
+    ((unsigned char *)state)[stateByte(i)] =
+        (UINT8)KeccakComplementedLanes[i / 8];
+}
+
+/* ---------------------------------------------------------------- */
+
+/* One round from the lanes A to the lanes E, with theta's parities C and D
+   and the rotated lanes B */
+#define thetaRhoPiChiIota(i, A, E)                                             \
+  Ca = A##ba ^ A##ga ^ A##ka ^ A##ma ^ A##sa;                                  \
+  Ce = A##be ^ A##ge ^ A##ke ^ A##me ^ A##se;                                  \
+  Ci = A##bi ^ A##gi ^ A##ki ^ A##mi ^ A##si;                                  \
+  Co = A##bo ^ A##go ^ A##ko ^ A##mo ^ A##so;                                  \
+  Cu = A##bu ^ A##gu ^ A##ku ^ A##mu ^ A##su;                                  \
+  Da = Cu ^ ROL64(Ce, 1);                                                      \
+  De = Ca ^ ROL64(Ci, 1);                                                      \
+  Di = Ce ^ ROL64(Co, 1);                                                      \
+  Do = Ci ^ ROL64(Cu, 1);                                                      \
+  Du = Co ^ ROL64(Ca, 1);                                                      \
+                                                                               \
+  Bba = A##ba ^ Da;                                                            \
+  Bbe = ROL64(A##ge ^ De, 44);                                                 \
+  Bbi = ROL64(A##ki ^ Di, 43);                                                 \
+  Bbo = ROL64(A##mo ^ Do, 21);                                                 \
+  Bbu = ROL64(A##su ^ Du, 14);                                                 \
+  E##ba = Bba ^ (Bbe | Bbi) ^ KeccakRoundConstants[i];                         \
+  E##be = Bbe ^ ((~Bbi) | Bbo);                                                \
+  E##bi = Bbi ^ (Bbo & Bbu);                                                   \
+  E##bo = Bbo ^ (Bbu | Bba);                                                   \
+  E##bu = Bbu ^ (Bba & Bbe);                                                   \
+                                                                               \
+  Bga = ROL64(A##bo ^ Do, 28);                                                 \
+  Bge = ROL64(A##gu ^ Du, 20);                                                 \
+  Bgi = ROL64(A##ka ^ Da, 3);                                                  \
+  Bgo = ROL64(A##me ^ De, 45);                                                 \
+  Bgu = ROL64(A##si ^ Di, 61);                                                 \
+  E##ga = Bga ^ (Bge | Bgi);                                                   \
+  E##ge = Bge ^ (Bgi & Bgo);                                                   \
+  E##gi = Bgi ^ (Bgo | (~Bgu));                                                \
+  E##go = Bgo ^ (Bgu | Bga);                                                   \
+  E##gu = Bgu ^ (Bga & Bge);                                                   \
+                                                                               \
+  Bka = ROL64(A##be ^ De, 1);                                                  \
+  Bke = ROL64(A##gi ^ Di, 6);                                                  \
+  Bki = ROL64(A##ko ^ Do, 25);                                                 \
+  Bko = ROL64(A##mu ^ Du, 8);                                                  \
+  Bku = ROL64(A##sa ^ Da, 18);                                                 \
+  E##ka = Bka ^ (Bke | Bki);                                                   \
+  E##ke = Bke ^ (Bki & Bko);                                                   \
+  E##ki = Bki ^ ((~Bko) & Bku);                                                \
+  E##ko = (~Bko) ^ (Bku | Bka);                                                \
+  E##ku = Bku ^ (Bka & Bke);                                                   \
+                                                                               \
+  Bma = ROL64(A##bu ^ Du, 27);                                                 \
+  Bme = ROL64(A##ga ^ Da, 36);                                                 \
+  Bmi = ROL64(A##ke ^ De, 10);                                                 \
+  Bmo = ROL64(A##mi ^ Di, 15);                                                 \
+  Bmu = ROL64(A##so ^ Do, 56);                                                 \
+  E##ma = Bma ^ (Bme & Bmi);                                                   \
+  E##me = Bme ^ (Bmi | Bmo);                                                   \
+  E##mi = Bmi ^ ((~Bmo) | Bmu);                                                \
+  E##mo = (~Bmo) ^ (Bmu & Bma);                                                \
+  E##mu = Bmu ^ (Bma | Bme);                                                   \
+                                                                               \
+  Bsa = ROL64(A##bi ^ Di, 62);                                                 \
+  Bse = ROL64(A##go ^ Do, 55);                                                 \
+  Bsi = ROL64(A##ku ^ Du, 39);                                                 \
+  Bso = ROL64(A##ma ^ Da, 41);                                                 \
+  Bsu = ROL64(A##se ^ De, 2);                                                  \
+  E##sa = Bsa ^ ((~Bse) & Bsi);                                                \
+  E##se = (~Bse) ^ (Bsi | Bso);                                                \
+  E##si = Bsi ^ (Bso & Bsu);                                                   \
+  E##so = Bso ^ (Bsu | Bsa);                                                   \
+  E##su = Bsu ^ (Bsa & Bse);
+
+#define copyLanes(A, E)                                                        \
+  A##ba = E##ba; A##be = E##be; A##bi = E##bi; A##bo = E##bo; A##bu = E##bu;   \
+  A##ga = E##ga; A##ge = E##ge; A##gi = E##gi; A##go = E##go; A##gu = E##gu;   \
+  A##ka = E##ka; A##ke = E##ke; A##ki = E##ki; A##ko = E##ko; A##ku = E##ku;   \
+  A##ma = E##ma; A##me = E##me; A##mi = E##mi; A##mo = E##mo; A##mu = E##mu;   \
+  A##sa = E##sa; A##se = E##se; A##si = E##si; A##so = E##so; A##su = E##su;
+
+#define copyFromState(A, state)                                                \
+  A##ba = state[0]; A##be = state[1]; A##bi = state[2]; A##bo = state[3];      \
+  A##bu = state[4]; A##ga = state[5]; A##ge = state[6]; A##gi = state[7];      \
+  A##go = state[8]; A##gu = state[9]; A##ka = state[10]; A##ke = state[11];    \
+  A##ki = state[12]; A##ko = state[13]; A##ku = state[14]; A##ma = state[15];  \
+  A##me = state[16]; A##mi = state[17]; A##mo = state[18]; A##mu = state[19];  \
+  A##sa = state[20]; A##se = state[21]; A##si = state[22]; A##so = state[23];  \
+  A##su = state[24];
+
+#define copyToState(state, A)                                                  \
+  state[0] = A##ba; state[1] = A##be; state[2] = A##bi; state[3] = A##bo;      \
+  state[4] = A##bu; state[5] = A##ga; state[6] = A##ge; state[7] = A##gi;      \
+  state[8] = A##go; state[9] = A##gu; state[10] = A##ka; state[11] = A##ke;    \
+  state[12] = A##ki; state[13] = A##ko; state[14] = A##ku; state[15] = A##ma;  \
+  state[16] = A##me; state[17] = A##mi; state[18] = A##mo; state[19] = A##mu;  \
+  state[20] = A##sa; state[21] = A##se; state[22] = A##si; state[23] = A##so;  \
+  state[24] = A##su;
+
+/* Runs the rounds of index first to 23 on the lanes of a state */
+static void KeccakP1600_Rounds(tKeccakLane *state, unsigned int first) {
+  tKeccakLane Aba, Abe, Abi, Abo, Abu, Aga, Age, Agi, Ago, Agu;
+  tKeccakLane Aka, Ake, Aki, Ako, Aku, Ama, Ame, Ami, Amo, Amu;
+  tKeccakLane Asa, Ase, Asi, Aso, Asu;
+  tKeccakLane Bba, Bbe, Bbi, Bbo, Bbu, Bga, Bge, Bgi, Bgo, Bgu;
+  tKeccakLane Bka, Bke, Bki, Bko, Bku, Bma, Bme, Bmi, Bmo, Bmu;
+  tKeccakLane Bsa, Bse, Bsi, Bso, Bsu;
+  tKeccakLane Ca, Ce, Ci, Co, Cu, Da, De, Di, Do, Du;
+  tKeccakLane Eba, Ebe, Ebi, Ebo, Ebu, Ega, Ege, Egi, Ego, Egu;
+  tKeccakLane Eka, Eke, Eki, Eko, Eku, Ema, Eme, Emi, Emo, Emu;
+  tKeccakLane Esa, Ese, Esi, Eso, Esu;
+  unsigned int i = first;
+
+  copyFromState(A, state)
+  /* An odd number of rounds starts with a single one */
+  if ((maxNrRounds - first) % 2 != 0) {
+    thetaRhoPiChiIota(i, A, E)
+    copyLanes(A, E)
+    i++;
+  }
+  for (; i < maxNrRounds; i += 2) {
+    thetaRhoPiChiIota(i, A, E)
+    thetaRhoPiChiIota(i + 1, E, A)
+  }
+  copyToState(state, A)
+}
+
+void KeccakP1600_Permute_Nrounds(void *state, unsigned int nrounds) {
+  assert(nrounds <= maxNrRounds);
+  KeccakP1600_Rounds((tKeccakLane *)state, maxNrRounds - nrounds);
+}
+
+void KeccakP1600_Permute_12rounds(void *state) {
+  KeccakP1600_Rounds((tKeccakLane *)state, maxNrRounds - 12);
+}
+
+void KeccakP1600_Permute_24rounds(void *state) {
+  KeccakP1600_Rounds((tKeccakLane *)state, 0);
+}
+
+/* ---------------------------------------------------------------- */
+
+void KeccakP1600_ExtractBytes(const void *state, unsigned char *data,
+                              unsigned int offset, unsigned int length) {
+  unsigned int i;
+
+  assert(offset < 200);
+  assert(offset + length <= 200);
+  for (i = 0; i < length; i++)
+    data[i] = ((const unsigned char *)state)[stateByte(offset + i)] ^
+              (UINT8)KeccakComplementedLanes[(offset + i) / 8];
+}
+
+/* ---------------------------------------------------------------- */
+
+void KeccakP1600_ExtractAndAddBytes(const void *state,
+                                    const unsigned char *input,
+                                    unsigned char *output, unsigned int offset,
+                                    unsigned int length) {
+  unsigned int i;
+
+  assert(offset < 200);
+  assert(offset + length <= 200);
+  for (i = 0; i < length; i++)
+    output[i] = input[i] ^
+                ((const unsigned char *)state)[stateByte(offset + i)] ^
+                (UINT8)KeccakComplementedLanes[(offset + i) / 8];
+}
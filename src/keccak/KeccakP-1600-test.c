@@ -0,0 +1,207 @@
+/*
+ * Copyright (c) 2020 IOTA Stiftung
+ * https://github.com/iotaledger/entangled-node
+ *
+ * Refer to the LICENSE file for licensing information
+ */
+
+/*
+Checks the Keccak-p[1600] implementation built into the addon against the
+reference one, through every function of KeccakP-1600-SnP.h, then times both.
+The reference implementation is included below with its functions renamed.
+
+Usage: keccak_test [permutations]
+Exits with status 1 if the implementations differ.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define KeccakP1600_Initialize KeccakP1600Reference_Initialize
+#define KeccakP1600_AddByte KeccakP1600Reference_AddByte
+#define KeccakP1600_AddBytes KeccakP1600Reference_AddBytes
+#define KeccakP1600_OverwriteBytes KeccakP1600Reference_OverwriteBytes
+#define KeccakP1600_OverwriteWithZeroes KeccakP1600Reference_OverwriteWithZeroes
+#define KeccakP1600_Permute_Nrounds KeccakP1600Reference_Permute_Nrounds
+#define KeccakP1600_Permute_12rounds KeccakP1600Reference_Permute_12rounds
+#define KeccakP1600_Permute_24rounds KeccakP1600Reference_Permute_24rounds
+#define KeccakP1600_ExtractBytes KeccakP1600Reference_ExtractBytes
+#define KeccakP1600_ExtractAndAddBytes KeccakP1600Reference_ExtractAndAddBytes
+#define KeccakP1600OnWords KeccakP1600Reference_OnWords
+#define KeccakP1600Round KeccakP1600Reference_Round
+#define KeccakP1600_DisplayRoundConstants                                      \
+  KeccakP1600Reference_DisplayRoundConstants
+#define KeccakP1600_DisplayRhoOffsets KeccakP1600Reference_DisplayRhoOffsets
+
+#include "KeccakP-1600-reference.c"
+
+#undef KeccakP1600_Initialize
+#undef KeccakP1600_AddByte
+#undef KeccakP1600_AddBytes
+#undef KeccakP1600_OverwriteBytes
+#undef KeccakP1600_OverwriteWithZeroes
+#undef KeccakP1600_Permute_Nrounds
+#undef KeccakP1600_Permute_12rounds
+#undef KeccakP1600_Permute_24rounds
+#undef KeccakP1600_ExtractBytes
+#undef KeccakP1600_ExtractAndAddBytes
+
+#include "KeccakP-1600-SnP.h"
+
+#define stateSize KeccakP1600_stateSizeInBytes
+
+typedef struct {
+  UINT64 reference[stateSize / 8];
+  UINT64 optimised[stateSize / 8];
+} states_t;
+
+static unsigned int failures = 0;
+
+static void randomBytes(unsigned char *bytes, unsigned int length) {
+  unsigned int i;
+
+  for (i = 0; i < length; i++)
+    bytes[i] = (unsigned char)(rand() >> 7);
+}
+
+/* Compares the states as seen through ExtractBytes() */
+static void check(const states_t *states, const char *what,
+                  unsigned int parameter) {
+  unsigned char reference[stateSize], optimised[stateSize];
+
+  KeccakP1600Reference_ExtractBytes(states->reference, reference, 0,
+                                    stateSize);
+  KeccakP1600_ExtractBytes(states->optimised, optimised, 0, stateSize);
+  if (memcmp(reference, optimised, stateSize) != 0) {
+    if (failures++ < 10)
+      fprintf(stderr, "Mismatch after %s (%u)\n", what, parameter);
+  }
+}
+
+static void randomState(states_t *states) {
+  unsigned char bytes[stateSize];
+
+  randomBytes(bytes, stateSize);
+  KeccakP1600Reference_OverwriteBytes(states->reference, bytes, 0, stateSize);
+  KeccakP1600_OverwriteBytes(states->optimised, bytes, 0, stateSize);
+}
+
+static void testPermutations(void) {
+  states_t states;
+  unsigned int rounds;
+
+  KeccakP1600Reference_Initialize(states.reference);
+  KeccakP1600_Initialize(states.optimised);
+  check(&states, "Initialize", 0);
+  KeccakP1600Reference_Permute_24rounds(states.reference);
+  KeccakP1600_Permute_24rounds(states.optimised);
+  check(&states, "Permute_24rounds", 0);
+
+  for (rounds = 0; rounds <= 24; rounds++) {
+    randomState(&states);
+    KeccakP1600Reference_Permute_Nrounds(states.reference, rounds);
+    KeccakP1600_Permute_Nrounds(states.optimised, rounds);
+    check(&states, "Permute_Nrounds", rounds);
+  }
+  randomState(&states);
+  KeccakP1600Reference_Permute_12rounds(states.reference);
+  KeccakP1600_Permute_12rounds(states.optimised);
+  check(&states, "Permute_12rounds", 0);
+}
+
+static void testBytes(void) {
+  states_t states;
+  unsigned char data[stateSize], reference[stateSize], optimised[stateSize];
+  unsigned int offset, length;
+
+  for (offset = 0; offset < stateSize; offset++) {
+    for (length = 0; offset + length <= stateSize; length += 1 + length / 4) {
+      randomState(&states);
+      randomBytes(data, length);
+      KeccakP1600Reference_AddBytes(states.reference, data, offset, length);
+      KeccakP1600_AddBytes(states.optimised, data, offset, length);
+      check(&states, "AddBytes", offset);
+
+      randomBytes(data, length);
+      KeccakP1600Reference_OverwriteBytes(states.reference, data, offset,
+                                          length);
+      KeccakP1600_OverwriteBytes(states.optimised, data, offset, length);
+      check(&states, "OverwriteBytes", offset);
+
+      randomBytes(data, length);
+      KeccakP1600Reference_ExtractAndAddBytes(states.reference, data,
+                                              reference, offset, length);
+      KeccakP1600_ExtractAndAddBytes(states.optimised, data, optimised,
+                                     offset, length);
+      if (memcmp(reference, optimised, length) != 0 && failures++ < 10)
+        fprintf(stderr, "Mismatch after ExtractAndAddBytes (%u)\n", offset);
+
+      KeccakP1600Reference_ExtractBytes(states.reference, reference, offset,
+                                        length);
+      KeccakP1600_ExtractBytes(states.optimised, optimised, offset, length);
+      if (memcmp(reference, optimised, length) != 0 && failures++ < 10)
+        fprintf(stderr, "Mismatch after ExtractBytes (%u)\n", offset);
+    }
+
+    randomState(&states);
+    KeccakP1600Reference_AddByte(states.reference, (unsigned char)offset,
+                                 offset);
+    KeccakP1600_AddByte(states.optimised, (unsigned char)offset, offset);
+    check(&states, "AddByte", offset);
+  }
+
+  for (length = 0; length <= stateSize; length++) {
+    randomState(&states);
+    KeccakP1600Reference_OverwriteWithZeroes(states.reference, length);
+    KeccakP1600_OverwriteWithZeroes(states.optimised, length);
+    check(&states, "OverwriteWithZeroes", length);
+  }
+}
+
+static double nanoseconds(clock_t start, unsigned long permutations) {
+  return (double)(clock() - start) * 1e9 / CLOCKS_PER_SEC / permutations;
+}
+
+static void benchmark(unsigned long permutations) {
+  states_t states;
+  clock_t start;
+  unsigned long i;
+  double reference, optimised;
+
+  KeccakP1600Reference_Initialize(states.reference);
+  KeccakP1600_Initialize(states.optimised);
+
+  start = clock();
+  for (i = 0; i < permutations; i++)
+    KeccakP1600Reference_Permute_24rounds(states.reference);
+  reference = nanoseconds(start, permutations);
+
+  start = clock();
+  for (i = 0; i < permutations; i++)
+    KeccakP1600_Permute_24rounds(states.optimised);
+  optimised = nanoseconds(start, permutations);
+
+  check(&states, "benchmark", 0);
+  printf("Keccak-p[1600] 24 rounds, %lu permutations\n", permutations);
+  printf("  reference: %.1f ns\n", reference);
+  printf("  %s: %.1f ns, %.2fx\n", KeccakP1600_implementation, optimised,
+         reference / optimised);
+}
+
+int main(int argc, char **argv) {
+  unsigned long permutations = argc > 1 ? strtoul(argv[1], NULL, 10) : 100000;
+
+  srand(1600);
+  testPermutations();
+  testBytes();
+  if (permutations > 0)
+    benchmark(permutations);
+  if (failures > 0) {
+    fprintf(stderr, "%u mismatches\n", failures);
+    return 1;
+  }
+  printf("Implementations match\n");
+  return 0;
+}
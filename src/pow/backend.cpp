@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) 2020 IOTA Stiftung
+ * https://github.com/iotaledger/entangled-node
+ *
+ * Refer to the LICENSE file for licensing information
+ */
+
+#include <condition_variable>
+
+#include "pow/backend.h"
+
+namespace entangled {
+
+static std::mutex backendMutex;
+static std::shared_ptr<PowBackend> backend = std::make_shared<LocalPowBackend>();
+
+bool LocalPowBackend::submit(pow_request_t const &request, Callback done, std::shared_ptr<Control> &progress) {
+  std::shared_ptr<PowFlight> flight;
+  // The flight is only known once joined, and done may run before join returns
+  auto joined = std::make_shared<std::shared_ptr<PowFlight>>();
+  auto mutex = std::make_shared<std::mutex>();
+  std::unique_lock<std::mutex> lock(*mutex);
+  auto control = request.control;
+  auto complete = [done, joined, mutex, control](pow_status_t status) {
+    std::lock_guard<std::mutex> lock(*mutex);
+    control->setBackend("local");
+    done(status, (*joined)->task());
+  };
+
+  if (!PowFlight::join(request.key, request.task, request.control, request.scheduler, request.priority,
+                       request.slots, complete, flight)) {
+    return false;
+  }
+  *joined = flight;
+  progress = flight->control();
+  return true;
+}
+
+void setPowBackend(std::shared_ptr<PowBackend> backend_) {
+  std::shared_ptr<PowBackend> previous;
+
+  // Released out of the lock, a backend joining its threads once destroyed
+  {
+    std::lock_guard<std::mutex> lock(backendMutex);
+    previous.swap(backend);
+    backend = backend_;
+  }
+}
+
+std::shared_ptr<PowBackend> powBackend() {
+  std::lock_guard<std::mutex> lock(backendMutex);
+  return backend;
+}
+
+pow_status_t runPowRequest(std::string const &key, std::shared_ptr<PowTask> &task, std::shared_ptr<Control> control,
+                           priority_t priority) {
+  std::mutex mutex;
+  std::condition_variable cond;
+  bool done = false;
+  pow_status_t result = POW_SEARCHING;
+  pow_settings_t settings = powDefaults();
+  Scheduler *scheduler = Scheduler::pool(settings.placement);
+  std::shared_ptr<Control> progress;
+  auto complete = [&](pow_status_t status, std::shared_ptr<PowTask> completed) {
+    std::lock_guard<std::mutex> lock(mutex);
+    result = status;
+    task = completed;
+    done = true;
+    cond.notify_all();
+  };
+
+  if (scheduler == NULL ||
+      !powBackend()->submit({key, task, control, scheduler, priority, settings.threads}, complete, progress)) {
+    return POW_REJECTED;
+  }
+
+  std::unique_lock<std::mutex> lock(mutex);
+  cond.wait(lock, [&done] { return done; });
+  return result;
+}
+
+}  // namespace entangled
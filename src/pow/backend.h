@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2020 IOTA Stiftung
+ * https://github.com/iotaledger/entangled-node
+ *
+ * Refer to the LICENSE file for licensing information
+ */
+
+#ifndef __POW_BACKEND_H__
+#define __POW_BACKEND_H__
+
+#include <memory>
+#include <string>
+
+#include "pow/flight.h"
+
+namespace entangled {
+
+/**
+ * A Proof of Work request, as submitted to a backend
+ */
+typedef struct {
+  // PowFlight key of the request
+  std::string key;
+  std::shared_ptr<PowTask> task;
+  // The caller control
+  std::shared_ptr<Control> control;
+  // Pool, priority and maximum number of threads of the request when it runs in process
+  Scheduler *scheduler;
+  priority_t priority;
+  size_t slots;
+} pow_request_t;
+
+/**
+ * Where Proof of Work requests run
+ */
+class PowBackend : public std::enable_shared_from_this<PowBackend> {
+ public:
+  /**
+   * Called once the caller is done, with the request result or the reason it stopped, and the task holding the
+   * result. The attempts and threads of the request, and the backend it ran on, are then recorded in the caller
+   * control.
+   */
+  typedef std::function<void(pow_status_t, std::shared_ptr<PowTask>)> Callback;
+
+  virtual ~PowBackend() {}
+
+  virtual char const *name() const = 0;
+
+  /**
+   * Submits a request
+   *
+   * @param request The request
+   * @param done Called from any thread once the caller is done
+   * @param progress Set to a control accumulating the attempts of the request while it runs
+   *
+   * @return false if the request was rejected, done then never being called
+   */
+  virtual bool submit(pow_request_t const &request, Callback done, std::shared_ptr<Control> &progress) = 0;
+};
+
+/**
+ * Runs requests on the scheduler of this process, identical requests in flight sharing one search
+ */
+class LocalPowBackend : public PowBackend {
+ public:
+  char const *name() const { return "local"; }
+
+  bool submit(pow_request_t const &request, Callback done, std::shared_ptr<Control> &progress);
+};
+
+/**
+ * Sets the backend of the requests submitted from now on, process-wide
+ */
+void setPowBackend(std::shared_ptr<PowBackend> backend);
+
+/**
+ * Returns the backend of new requests, a LocalPowBackend unless set otherwise
+ */
+std::shared_ptr<PowBackend> powBackend();
+
+/**
+ * Runs a request on the current backend with the default settings and waits for the caller to be done
+ *
+ * @param key The PowFlight key of the request
+ * @param task The task, set to the task holding the result on output
+ * @param control The caller control
+ * @param priority The scheduler priority of the request
+ *
+ * @return POW_FOUND, the reason the caller control stopped or POW_REJECTED
+ */
+pow_status_t runPowRequest(std::string const &key, std::shared_ptr<PowTask> &task, std::shared_ptr<Control> control,
+                           priority_t priority);
+
+}  // namespace entangled
+
+#endif  // __POW_BACKEND_H__
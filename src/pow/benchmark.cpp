@@ -0,0 +1,24 @@
+/*
+ * Copyright (c) 2020 IOTA Stiftung
+ * https://github.com/iotaledger/entangled-node
+ *
+ * Refer to the LICENSE file for licensing information
+ */
+
+#include "pow/benchmark.h"
+
+namespace entangled {
+
+pow_status_t BenchmarkPowTask::next(std::shared_ptr<Search> &search) {
+  trit_t block[kHashTrits] = {0};
+
+  if (started_) {
+    // Only reached if a hash of weight 243 was found
+    return POW_FOUND;
+  }
+  started_ = true;
+  search = std::make_shared<Search>(block, kHashTrits, static_cast<uint8_t>(kHashTrits), kernel_);
+  return POW_SEARCHING;
+}
+
+}  // namespace entangled
@@ -0,0 +1,32 @@
+/*
+ * Copyright (c) 2020 IOTA Stiftung
+ * https://github.com/iotaledger/entangled-node
+ *
+ * Refer to the LICENSE file for licensing information
+ */
+
+#ifndef __POW_BENCHMARK_H__
+#define __POW_BENCHMARK_H__
+
+#include "pow/job.h"
+
+namespace entangled {
+
+/**
+ * Search that never completes, for measuring the hashrate of a kernel. It runs until its job is cancelled or times
+ * out, its control then holding the number of nonces tried.
+ */
+class BenchmarkPowTask : public PowTask {
+ public:
+  explicit BenchmarkPowTask(pow_kernel_t kernel) : kernel_(kernel), started_(false) {}
+
+  pow_status_t next(std::shared_ptr<Search> &search);
+
+ private:
+  pow_kernel_t kernel_;
+  bool started_;
+};
+
+}  // namespace entangled
+
+#endif  // __POW_BENCHMARK_H__
@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) 2020 IOTA Stiftung
+ * https://github.com/iotaledger/entangled-node
+ *
+ * Refer to the LICENSE file for licensing information
+ */
+
+#include <stdint.h>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <immintrin.h>
+#include <intrin.h>
+#define CPU_X86
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#include <cpuid.h>
+#define CPU_X86
+#endif
+
+#include "pow/cpu.h"
+
+namespace entangled {
+
+#if defined(CPU_X86)
+static void cpuid(uint32_t leaf, uint32_t subleaf, uint32_t regs[4]) {
+#if defined(_MSC_VER)
+  int values[4];
+  __cpuidex(values, static_cast<int>(leaf), static_cast<int>(subleaf));
+  for (int i = 0; i < 4; i++) {
+    regs[i] = static_cast<uint32_t>(values[i]);
+  }
+#else
+  __cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+}
+
+// Register states enabled by the operating system
+static uint64_t xgetbv() {
+#if defined(_MSC_VER)
+  return _xgetbv(0);
+#else
+  uint32_t low, high;
+  __asm__ volatile("xgetbv" : "=a"(low), "=d"(high) : "c"(0));
+  return (static_cast<uint64_t>(high) << 32) | low;
+#endif
+}
+
+static cpu_features_t detect() {
+  cpu_features_t features = {false, false, false};
+  uint32_t regs[4];
+
+  cpuid(0, 0, regs);
+  uint32_t maxLeaf = regs[0];
+  if (maxLeaf < 1) {
+    return features;
+  }
+
+  cpuid(1, 0, regs);
+  features.sse2 = (regs[3] >> 26) & 1;
+  bool osxsave = (regs[2] >> 27) & 1;
+  bool avx = (regs[2] >> 28) & 1;
+  if (!osxsave || !avx || maxLeaf < 7) {
+    return features;
+  }
+
+  uint64_t xcr0 = xgetbv();
+  cpuid(7, 0, regs);
+  // XMM and YMM, then opmask and ZMM states
+  features.avx2 = (xcr0 & 0x6) == 0x6 && ((regs[1] >> 5) & 1);
+  features.avx512f = (xcr0 & 0xe6) == 0xe6 && ((regs[1] >> 16) & 1);
+  return features;
+}
+#else
+static cpu_features_t detect() { return {false, false, false}; }
+#endif
+
+cpu_features_t const &cpuFeatures() {
+  static cpu_features_t const features = detect();
+  return features;
+}
+
+}  // namespace entangled
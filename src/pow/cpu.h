@@ -0,0 +1,27 @@
+/*
+ * Copyright (c) 2020 IOTA Stiftung
+ * https://github.com/iotaledger/entangled-node
+ *
+ * Refer to the LICENSE file for licensing information
+ */
+
+#ifndef __POW_CPU_H__
+#define __POW_CPU_H__
+
+namespace entangled {
+
+typedef struct {
+  bool sse2;
+  bool avx2;
+  bool avx512f;
+} cpu_features_t;
+
+/**
+ * Returns the vector instruction sets usable on this CPU, the operating system saving their registers. Detected
+ * once with cpuid, all false on other architectures.
+ */
+cpu_features_t const &cpuFeatures();
+
+}  // namespace entangled
+
+#endif  // __POW_CPU_H__
@@ -0,0 +1,46 @@
+/*
+ * Copyright (c) 2020 IOTA Stiftung
+ * https://github.com/iotaledger/entangled-node
+ *
+ * Refer to the LICENSE file for licensing information
+ */
+
+#include <string.h>
+
+#include "pow/curl.h"
+
+namespace entangled {
+
+static trit_t const kTruthTable[11] = {1, 0, -1, 2, 1, -1, 0, 2, -1, 1, 0};
+
+void Curl::reset() { memset(state_, 0, sizeof(state_)); }
+
+void Curl::absorb(trit_t const *trits, size_t length) {
+  for (size_t i = 0; i < length; i += kHashTrits) {
+    memcpy(state_, trits + i, kHashTrits * sizeof(trit_t));
+    transform();
+  }
+}
+
+void Curl::squeeze(trit_t *trits, size_t length) {
+  for (size_t i = 0; i < length; i += kHashTrits) {
+    memcpy(trits + i, state_, kHashTrits * sizeof(trit_t));
+    transform();
+  }
+}
+
+void Curl::transform() {
+  trit_t scratchpad[kStateTrits];
+  size_t index = 0;
+
+  for (size_t round = 0; round < kCurlRounds; round++) {
+    memcpy(scratchpad, state_, sizeof(state_));
+    for (size_t i = 0; i < kStateTrits; i++) {
+      size_t prev = index;
+      index = index < 365 ? index + 364 : index - 365;
+      state_[i] = kTruthTable[scratchpad[prev] + scratchpad[index] * 4 + 5];
+    }
+  }
+}
+
+}  // namespace entangled
@@ -0,0 +1,54 @@
+/*
+ * Copyright (c) 2020 IOTA Stiftung
+ * https://github.com/iotaledger/entangled-node
+ *
+ * Refer to the LICENSE file for licensing information
+ */
+
+#ifndef __POW_CURL_H__
+#define __POW_CURL_H__
+
+#include "pow/trinary.h"
+
+namespace entangled {
+
+static size_t const kCurlRounds = 81;
+
+/**
+ * Scalar Curl-P-81 sponge. The search kernels bitslice the same transform across lanes, this one is used to build
+ * their midstate and to hash results.
+ */
+class Curl {
+ public:
+  Curl() { reset(); }
+
+  void reset();
+
+  /**
+   * Absorbs whole 243 trit blocks
+   *
+   * @param trits The trits
+   * @param length The number of trits, a multiple of 243
+   */
+  void absorb(trit_t const *trits, size_t length);
+
+  /**
+   * Squeezes whole 243 trit blocks
+   *
+   * @param trits The output trits
+   * @param length The number of trits, a multiple of 243
+   */
+  void squeeze(trit_t *trits, size_t length);
+
+  void transform();
+
+  trit_t *state() { return state_; }
+  trit_t const *state() const { return state_; }
+
+ private:
+  trit_t state_[kStateTrits];
+};
+
+}  // namespace entangled
+
+#endif  // __POW_CURL_H__
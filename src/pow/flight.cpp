@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) 2020 IOTA Stiftung
+ * https://github.com/iotaledger/entangled-node
+ *
+ * Refer to the LICENSE file for licensing information
+ */
+
+#include <unordered_map>
+
+#include "pow/flight.h"
+
+namespace entangled {
+
+// A single lock guards the table and every flight, so that joining and detaching never race with each other
+static std::mutex flightsMutex;
+static std::unordered_map<std::string, std::shared_ptr<PowFlight>> flights;
+
+bool PowFlight::join(std::string const &key, std::shared_ptr<PowTask> task, std::shared_ptr<Control> control,
+                     Scheduler *scheduler, priority_t priority, size_t slots, Callback done,
+                     std::shared_ptr<PowFlight> &flight) {
+  std::unique_lock<std::mutex> lock(flightsMutex);
+
+  auto existing = flights.find(key);
+  if (existing != flights.end()) {
+    flight = existing->second;
+    flight->subscribers_.push_back({control, done});
+    return true;
+  }
+
+  flight = std::shared_ptr<PowFlight>(new PowFlight(key, task));
+  flight->subscribers_.push_back({control, done});
+  flights[key] = flight;
+
+  auto self = flight;
+  auto job = std::make_shared<PowJob>(flight, flight->control_, scheduler, priority, slots,
+                                      [self](pow_status_t status) { self->complete(status); });
+  if (!job->start()) {
+    flights.erase(key);
+    flight.reset();
+    return false;
+  }
+  return true;
+}
+
+pow_status_t PowFlight::poll() {
+  std::vector<std::pair<subscriber_t, pow_status_t>> detached;
+  bool abandoned = false;
+
+  {
+    std::lock_guard<std::mutex> lock(flightsMutex);
+
+    for (auto subscriber = subscribers_.begin(); subscriber != subscribers_.end();) {
+      pow_status_t status = subscriber->control->check();
+      if (status == POW_SEARCHING) {
+        subscriber++;
+        continue;
+      }
+      detached.push_back(std::make_pair(*subscriber, status));
+      subscriber = subscribers_.erase(subscriber);
+    }
+
+    if (subscribers_.empty()) {
+      auto registered = flights.find(key_);
+      if (registered != flights.end() && registered->second.get() == this) {
+        flights.erase(registered);
+      }
+      abandoned = true;
+    }
+  }
+
+  for (auto &subscriber : detached) {
+    subscriber.first.control->addAttempts(control_->attempts());
+    subscriber.first.control->recordThreads(control_->threads());
+    subscriber.first.control->finish();
+    subscriber.first.done(subscriber.second);
+  }
+  return abandoned ? POW_CANCELLED : POW_SEARCHING;
+}
+
+void PowFlight::complete(pow_status_t status) {
+  std::vector<subscriber_t> subscribers;
+
+  {
+    std::lock_guard<std::mutex> lock(flightsMutex);
+
+    auto registered = flights.find(key_);
+    if (registered != flights.end() && registered->second.get() == this) {
+      flights.erase(registered);
+    }
+    subscribers.swap(subscribers_);
+  }
+
+  for (auto &subscriber : subscribers) {
+    subscriber.control->addAttempts(control_->attempts());
+    subscriber.control->recordThreads(control_->threads());
+    subscriber.control->finish();
+    subscriber.done(status);
+  }
+}
+
+}  // namespace entangled
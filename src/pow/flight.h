@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2020 IOTA Stiftung
+ * https://github.com/iotaledger/entangled-node
+ *
+ * Refer to the LICENSE file for licensing information
+ */
+
+#ifndef __POW_FLIGHT_H__
+#define __POW_FLIGHT_H__
+
+#include <string>
+#include <vector>
+
+#include "pow/job.h"
+
+namespace entangled {
+
+/**
+ * Single-flight Proof of Work: identical requests in flight share one PowJob and receive the same result. Every
+ * caller keeps its own control, so that cancelling one of them or reaching its deadline only detaches it, and the
+ * search stops once nobody waits for it anymore.
+ */
+class PowFlight : public PowTask {
+ public:
+  typedef std::function<void(pow_status_t)> Callback;
+
+  /**
+   * Joins the flight running the same request, or starts a new one
+   *
+   * @param key Canonical description of the request, identical requests having identical keys
+   * @param task The task to run if no such flight is in progress
+   * @param control The caller control
+   * @param scheduler The pool a new flight runs on
+   * @param priority The scheduler priority of a new flight
+   * @param slots The maximum number of threads working on a new flight at once, 0 for all pool threads
+   * @param done Called from a pool thread once the caller is done, with the flight result or the reason its own
+   * control stopped. The attempts and threads of the flight so far are then added to the caller control.
+   * @param flight The flight joined
+   *
+   * @return false if the scheduler rejected a new flight
+   */
+  static bool join(std::string const &key, std::shared_ptr<PowTask> task, std::shared_ptr<Control> control,
+                   Scheduler *scheduler, priority_t priority, size_t slots, Callback done,
+                   std::shared_ptr<PowFlight> &flight);
+
+  /**
+   * Returns the task run by the flight, whose result is shared by every caller
+   */
+  std::shared_ptr<PowTask> task() const { return task_; }
+
+  /**
+   * Returns the control of the shared job, which accumulates the attempts of the flight
+   */
+  std::shared_ptr<Control> control() const { return control_; }
+
+  pow_status_t next(std::shared_ptr<Search> &search) { return task_->next(search); }
+
+  pow_status_t poll();
+
+ private:
+  typedef struct {
+    std::shared_ptr<Control> control;
+    Callback done;
+  } subscriber_t;
+
+  PowFlight(std::string const &key, std::shared_ptr<PowTask> task)
+      : key_(key), task_(task), control_(std::make_shared<Control>()) {}
+
+  void complete(pow_status_t status);
+
+  std::string key_;
+  std::shared_ptr<PowTask> task_;
+  std::shared_ptr<Control> control_;
+  std::vector<subscriber_t> subscribers_;
+};
+
+}  // namespace entangled
+
+#endif  // __POW_FLIGHT_H__
@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) 2020 IOTA Stiftung
+ * https://github.com/iotaledger/entangled-node
+ *
+ * Refer to the LICENSE file for licensing information
+ */
+
+#include <algorithm>
+
+#include "pow/hash_batch.h"
+#include "pow/hash_kernel.h"
+
+namespace entangled {
+
+uint8_t const *tryteLaneMasks() {
+  static struct masks_t {
+    masks_t() {
+      memset(values, kInvalidTryte, sizeof(values));
+      for (int value = -13; value <= 13; value++) {
+        uint8_t mask = 0;
+        int rest = value;
+        for (size_t k = 0; k < 3; k++) {
+          int trit = ((rest % 3) + 4) % 3 - 1;
+          rest = (rest - trit) / 3;
+          mask |= static_cast<uint8_t>((trit != 1) << k);
+          mask |= static_cast<uint8_t>((trit != -1) << (3 + k));
+        }
+        values[static_cast<unsigned char>(kTryteAlphabet[value < 0 ? value + 27 : value])] = mask;
+      }
+    }
+    uint8_t values[256];
+  } const masks;
+
+  return masks.values;
+}
+
+static bool hashLanes(pow_kernel_t kernel, char const *trytes, size_t count, char *hashes, uint8_t *weights) {
+  switch (kernel) {
+#if defined(PTRIT_SSE2)
+    case POW_KERNEL_SSE2:
+      return hashTransactionLanes<PtritSse2>(trytes, count, hashes, weights);
+#endif
+#if defined(ENTANGLED_POW_AVX2)
+    case POW_KERNEL_AVX2:
+      return hashTransactionLanesAvx2(trytes, count, hashes, weights);
+#endif
+#if defined(ENTANGLED_POW_AVX512)
+    case POW_KERNEL_AVX512:
+      return hashTransactionLanesAvx512(trytes, count, hashes, weights);
+#endif
+    default:
+      return hashTransactionLanes<Ptrit64>(trytes, count, hashes, weights);
+  }
+}
+
+bool transactionHashes(char const *trytes, size_t count, char *hashes, uint8_t *weights, Scheduler *scheduler,
+                       priority_t priority, pow_kernel_t kernel) {
+  size_t lanes = powKernelLanes(kernel);
+
+  return Scheduler::runPasses(
+      scheduler, (count + lanes - 1) / lanes,
+      [=](size_t pass) {
+        size_t first = pass * lanes;
+        return hashLanes(kernel, trytes + first * kTransactionTrytes, std::min(lanes, count - first),
+                         hashes + first * kHashTrytes, weights != NULL ? weights + first : NULL);
+      },
+      priority);
+}
+
+}  // namespace entangled
@@ -0,0 +1,38 @@
+/*
+ * Copyright (c) 2020 IOTA Stiftung
+ * https://github.com/iotaledger/entangled-node
+ *
+ * Refer to the LICENSE file for licensing information
+ */
+
+#ifndef __POW_HASH_BATCH_H__
+#define __POW_HASH_BATCH_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "pow/search.h"
+#include "scheduler/scheduler.h"
+
+namespace entangled {
+
+/**
+ * Computes the Curl-P-81 hashes of many transactions, bitsliced across the lanes of a kernel so that every pass
+ * hashes 64 to 512 of them. Passes are spread over the threads of a pool, the calling thread taking part.
+ *
+ * @param trytes The transactions trytes, count * kTransactionTrytes long
+ * @param count The number of transactions
+ * @param hashes The output hashes trytes, count * kHashTrytes long
+ * @param weights The output number of trailing zero trits of every hash, or NULL
+ * @param scheduler The pool helping, or NULL to hash on the calling thread only
+ * @param priority The scheduler priority of the helping tasks
+ * @param kernel The kernel, it must be supported
+ *
+ * @return false if a transaction holds a character other than a tryte
+ */
+bool transactionHashes(char const *trytes, size_t count, char *hashes, uint8_t *weights, Scheduler *scheduler,
+                       priority_t priority, pow_kernel_t kernel = powKernel());
+
+}  // namespace entangled
+
+#endif  // __POW_HASH_BATCH_H__
@@ -0,0 +1,123 @@
+/*
+ * Copyright (c) 2020 IOTA Stiftung
+ * https://github.com/iotaledger/entangled-node
+ *
+ * Refer to the LICENSE file for licensing information
+ */
+
+#ifndef __POW_HASH_KERNEL_H__
+#define __POW_HASH_KERNEL_H__
+
+#include <string.h>
+
+#include "pow/ptrit.h"
+#include "pow/transaction.h"
+
+/*
+ * Transaction hashing kernel, one transaction per lane. Like the search kernel, translation units built for a wider
+ * instruction set include this header after selecting it.
+ */
+
+namespace entangled {
+
+// Lane masks of the trits of a tryte: low bits of trits 0 to 2, then high bits, or kInvalidTryte
+static uint8_t const kInvalidTryte = 0x80;
+
+/**
+ * Returns the lane masks of every character, see kInvalidTryte
+ */
+uint8_t const *tryteLaneMasks();
+
+// Hashes of up to 128, 256 or 512 transactions, built for wider instruction sets in their own translation units
+bool hashTransactionLanesAvx2(char const *trytes, size_t count, char *hashes, uint8_t *weights);
+bool hashTransactionLanesAvx512(char const *trytes, size_t count, char *hashes, uint8_t *weights);
+
+/**
+ * Computes the Curl-P-81 hashes of up to P::kLanes transactions at once, one per lane
+ *
+ * @param trytes The transactions trytes, count * kTransactionTrytes long
+ * @param count The number of transactions, at most P::kLanes
+ * @param hashes The output hashes trytes, count * kHashTrytes long
+ * @param weights The output number of trailing zero trits of every hash, or NULL
+ *
+ * @return false if a transaction holds a character other than a tryte
+ */
+template <class P>
+bool hashTransactionLanes(char const *trytes, size_t count, char *hashes, uint8_t *weights) {
+  typedef typename P::word word;
+  static size_t const kChunks = P::kLanes / 64;
+  LaneBuffer<P> buffer(4 * kStateTrits + 2 * kHashTrits);
+  word *low = buffer.get(), *high = low + kStateTrits;
+  word *scratchLow = high + kStateTrits, *scratchHigh = scratchLow + kStateTrits;
+  // 64 lane chunks of the low then high words of every trit of a block
+  uint64_t *lanes = reinterpret_cast<uint64_t *>(scratchHigh + kStateTrits);
+  uint8_t const *masks = tryteLaneMasks();
+  uint8_t invalid = 0;
+
+  for (size_t i = 0; i < kStateTrits; i++) {
+    ptritBroadcast<P>(0, low[i], high[i]);
+  }
+
+  for (size_t block = 0; block < kTransactionTrytes; block += kHashTrytes) {
+    // Lanes past count hash whatever is left in their bits, their hashes being ignored
+    memset(lanes, 0, 2 * kHashTrits * sizeof(word));
+    for (size_t lane = 0; lane < count; lane++) {
+      char const *tx = trytes + lane * kTransactionTrytes + block;
+      uint64_t *chunk = &lanes[lane / 64];
+      size_t shift = lane % 64;
+
+      for (size_t j = 0; j < kHashTrytes; j++) {
+        uint8_t mask = masks[static_cast<unsigned char>(tx[j])];
+        uint64_t *trit = chunk + 6 * j * kChunks;
+        invalid |= mask;
+        trit[0] |= static_cast<uint64_t>(mask & 1) << shift;
+        trit[kChunks] |= static_cast<uint64_t>((mask >> 3) & 1) << shift;
+        trit[2 * kChunks] |= static_cast<uint64_t>((mask >> 1) & 1) << shift;
+        trit[3 * kChunks] |= static_cast<uint64_t>((mask >> 4) & 1) << shift;
+        trit[4 * kChunks] |= static_cast<uint64_t>((mask >> 2) & 1) << shift;
+        trit[5 * kChunks] |= static_cast<uint64_t>((mask >> 5) & 1) << shift;
+      }
+    }
+    for (size_t i = 0; i < kHashTrits; i++) {
+      low[i] = P::load(&lanes[2 * i * kChunks]);
+      high[i] = P::load(&lanes[(2 * i + 1) * kChunks]);
+    }
+    ptritTransform<P>(low, high, scratchLow, scratchHigh);
+  }
+  if ((invalid & kInvalidTryte) != 0) {
+    return false;
+  }
+
+  for (size_t i = 0; i < kHashTrits; i++) {
+    P::store(low[i], &lanes[2 * i * kChunks]);
+    P::store(high[i], &lanes[(2 * i + 1) * kChunks]);
+  }
+  for (size_t lane = 0; lane < count; lane++) {
+    uint64_t const *chunk = &lanes[lane / 64];
+    size_t shift = lane % 64;
+    char *hash = hashes + lane * kHashTrytes;
+    size_t weight = 0;
+    bool zeros = true;
+
+    for (size_t j = kHashTrytes; j-- > 0;) {
+      int value = 0;
+      for (size_t k = 3; k-- > 0;) {
+        uint64_t const *trit = chunk + 2 * (3 * j + k) * kChunks;
+        bool l = (trit[0] >> shift) & 1, h = (trit[kChunks] >> shift) & 1;
+        int t = l == h ? 0 : (l ? -1 : 1);
+        zeros = zeros && t == 0;
+        weight += zeros;
+        value = 3 * value + t;
+      }
+      hash[j] = kTryteAlphabet[value < 0 ? value + 27 : value];
+    }
+    if (weights != NULL) {
+      weights[lane] = static_cast<uint8_t>(weight);
+    }
+  }
+  return true;
+}
+
+}  // namespace entangled
+
+#endif  // __POW_HASH_KERNEL_H__
@@ -0,0 +1,45 @@
+/*
+ * Copyright (c) 2020 IOTA Stiftung
+ * https://github.com/iotaledger/entangled-node
+ *
+ * Refer to the LICENSE file for licensing information
+ */
+
+#include "pow/hashcash.h"
+
+namespace entangled {
+
+pow_status_t HashcashPowTask::next(std::shared_ptr<Search> &search) {
+  if (search) {
+    nonce_.resize(nonceTrits_);
+    search->nonce(nonce_.data());
+    hash_.resize(kHashTrits);
+    search->hash(hash_.data());
+    search.reset();
+    return POW_FOUND;
+  }
+
+  if (!Search::validNonce(trits_.size(), nonceOffset_, nonceTrits_)) {
+    return POW_INVALID_INPUT;
+  }
+  for (trit_t trit : trits_) {
+    if (trit < -1 || trit > 1) {
+      return POW_INVALID_INPUT;
+    }
+  }
+  search = std::make_shared<Search>(trits_.data(), trits_.size(), nonceOffset_, nonceTrits_, mwm_);
+  return POW_SEARCHING;
+}
+
+std::string hashcashPowKey(std::vector<trit_t> const &trits, size_t nonceOffset, size_t nonceTrits, uint8_t mwm) {
+  std::string key = "hashcash:" + std::to_string(mwm) + ":" + std::to_string(nonceOffset) + ":" +
+                    std::to_string(nonceTrits) + ":";
+
+  key.reserve(key.size() + trits.size());
+  for (trit_t trit : trits) {
+    key += static_cast<char>('1' + trit);
+  }
+  return key;
+}
+
+}  // namespace entangled
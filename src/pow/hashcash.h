@@ -0,0 +1,61 @@
+/*
+ * Copyright (c) 2020 IOTA Stiftung
+ * https://github.com/iotaledger/entangled-node
+ *
+ * Refer to the LICENSE file for licensing information
+ */
+
+#ifndef __POW_HASHCASH_H__
+#define __POW_HASHCASH_H__
+
+#include <string>
+#include <vector>
+
+#include "pow/job.h"
+
+namespace entangled {
+
+/**
+ * Curl-P-81 hashcash on an arbitrary trit buffer: searches a nonce, anywhere in the buffer, giving its hash a
+ * minimum weight
+ */
+class HashcashPowTask : public PowTask {
+ public:
+  /**
+   * @param trits The trits, a multiple of 243 long
+   * @param nonceOffset The offset of the nonce
+   * @param nonceTrits The number of nonce trits, see Search::validNonce()
+   * @param mwm The minimum weight magnitude
+   */
+  HashcashPowTask(std::vector<trit_t> const &trits, size_t nonceOffset, size_t nonceTrits, uint8_t mwm)
+      : trits_(trits), nonceOffset_(nonceOffset), nonceTrits_(nonceTrits), mwm_(mwm) {}
+
+  pow_status_t next(std::shared_ptr<Search> &search);
+
+  /**
+   * Returns the nonce trits once the task is complete
+   */
+  std::vector<trit_t> const &nonce() const { return nonce_; }
+
+  /**
+   * Returns the hash of the buffer with its nonce once the task is complete
+   */
+  std::vector<trit_t> const &hash() const { return hash_; }
+
+ private:
+  std::vector<trit_t> trits_;
+  size_t nonceOffset_;
+  size_t nonceTrits_;
+  uint8_t mwm_;
+  std::vector<trit_t> nonce_;
+  std::vector<trit_t> hash_;
+};
+
+/**
+ * Returns the PowFlight key of a hashcash request
+ */
+std::string hashcashPowKey(std::vector<trit_t> const &trits, size_t nonceOffset, size_t nonceTrits, uint8_t mwm);
+
+}  // namespace entangled
+
+#endif  // __POW_HASHCASH_H__
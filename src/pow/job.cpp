@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) 2020 IOTA Stiftung
+ * https://github.com/iotaledger/entangled-node
+ *
+ * Refer to the LICENSE file for licensing information
+ */
+
+#include <condition_variable>
+
+#include "pow/job.h"
+
+namespace entangled {
+
+static std::chrono::milliseconds const kSliceDuration(10);
+
+static std::mutex defaultsMutex;
+static pow_settings_t defaults = {0, Placement()};
+
+void setPowDefaults(pow_settings_t const &settings) {
+  std::lock_guard<std::mutex> lock(defaultsMutex);
+  defaults = settings;
+}
+
+pow_settings_t powDefaults() {
+  std::lock_guard<std::mutex> lock(defaultsMutex);
+  return defaults;
+}
+
+PowJob::PowJob(std::shared_ptr<PowTask> task, std::shared_ptr<Control> control, Scheduler *scheduler,
+               priority_t priority, size_t slots, Callback done)
+    : task_(task),
+      control_(control),
+      scheduler_(scheduler),
+      priority_(priority),
+      slots_(slots),
+      done_(done),
+      running_(0) {
+  size_t threads = scheduler_->threads();
+
+  if (slots_ == 0 || slots_ > threads) {
+    slots_ = threads;
+  }
+}
+
+bool PowJob::start() {
+  auto self = shared_from_this();
+
+  return scheduler_->submit(priority_, [self] {
+    std::lock_guard<std::mutex> lock(self->mutex_);
+    self->advance(POW_FOUND);
+  });
+}
+
+// Called with mutex_ held, once the current search, if any, ended with the given status
+void PowJob::advance(pow_status_t status) {
+  if (status == POW_FOUND) {
+    status = task_->next(search_);
+  }
+
+  if (status != POW_SEARCHING) {
+    search_.reset();
+    control_->finish();
+    done_(status);
+    return;
+  }
+
+  auto self = shared_from_this();
+  auto search = search_;
+  for (size_t i = 0; i < slots_; i++) {
+    scheduler_->resubmit(priority_, [self, search] { self->slice(search); });
+  }
+}
+
+void PowJob::slice(std::shared_ptr<Search> search) {
+  control_->recordThreads(running_.fetch_add(1, std::memory_order_relaxed) + 1);
+  pow_status_t status = search->work(*control_, Control::clock::now() + kSliceDuration);
+  running_.fetch_sub(1, std::memory_order_relaxed);
+
+  if (status == POW_SEARCHING) {
+    if (task_->poll() != POW_SEARCHING) {
+      control_->cancel();
+    }
+    // The slices still running the last iterations of the range move the job forward
+    if (search->drained()) {
+      return;
+    }
+    auto self = shared_from_this();
+    scheduler_->resubmit(priority_, [self, search] { self->slice(search); });
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  // Only the first slice to see the end of a search moves the job forward
+  if (search_ == search) {
+    advance(status);
+  }
+}
+
+pow_status_t runPowTask(std::shared_ptr<PowTask> task, std::shared_ptr<Control> control, Scheduler *scheduler,
+                        priority_t priority, size_t slots) {
+  std::mutex mutex;
+  std::condition_variable cond;
+  bool done = false;
+  pow_status_t result = POW_SEARCHING;
+
+  auto job = std::make_shared<PowJob>(task, control, scheduler, priority, slots, [&](pow_status_t status) {
+    std::lock_guard<std::mutex> lock(mutex);
+    result = status;
+    done = true;
+    cond.notify_all();
+  });
+
+  if (!job->start()) {
+    return POW_REJECTED;
+  }
+
+  std::unique_lock<std::mutex> lock(mutex);
+  cond.wait(lock, [&done] { return done; });
+  return result;
+}
+
+}  // namespace entangled
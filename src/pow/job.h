@@ -0,0 +1,140 @@
+/*
+ * Copyright (c) 2020 IOTA Stiftung
+ * https://github.com/iotaledger/entangled-node
+ *
+ * Refer to the LICENSE file for licensing information
+ */
+
+#ifndef __POW_JOB_H__
+#define __POW_JOB_H__
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "pow/search.h"
+#include "scheduler/scheduler.h"
+
+namespace entangled {
+
+/**
+ * A Proof of Work computation made of one or more consecutive searches
+ */
+class PowTask {
+ public:
+  virtual ~PowTask() {}
+
+  /**
+   * Consumes the result of the search that just completed, if any, and prepares the next one
+   *
+   * @param search The completed search on input, the next search to run on output
+   *
+   * @return POW_SEARCHING if there is a next search, POW_FOUND once the task is complete or POW_INVALID_INPUT
+   */
+  virtual pow_status_t next(std::shared_ptr<Search> &search) = 0;
+
+  /**
+   * Called by every thread between two slices of a search
+   *
+   * @return POW_SEARCHING to go on, otherwise the job is cancelled
+   */
+  virtual pow_status_t poll() { return POW_SEARCHING; }
+
+  /**
+   * Serializes the request for an out-of-process backend, see decodePowTask()
+   *
+   * @return false if the task only runs in process
+   */
+  virtual bool encode(std::string &request) const {
+    (void)request;
+    return false;
+  }
+
+  /**
+   * Serializes the result of the completed task
+   */
+  virtual void encodeResult(std::string &result) const { (void)result; }
+
+  /**
+   * Takes the result of the same task completed out of process
+   *
+   * @return false if the result is malformed
+   */
+  virtual bool decodeResult(std::string const &result) {
+    (void)result;
+    return false;
+  }
+};
+
+/**
+ * How a Proof of Work job uses the machine
+ */
+typedef struct {
+  // Maximum number of threads working on the job at once, 0 for every thread of its pool
+  size_t threads;
+  // Pool the job runs on
+  Placement placement;
+} pow_settings_t;
+
+/**
+ * Sets the settings of jobs not overriding them, process-wide
+ */
+void setPowDefaults(pow_settings_t const &settings);
+
+pow_settings_t powDefaults();
+
+/**
+ * Runs a PowTask on the scheduler. Each search is split into time slices run by up to `slots` pool threads at once,
+ * every slice resubmitting itself until the search ends, so that more urgent tasks get a thread in between.
+ */
+class PowJob : public std::enable_shared_from_this<PowJob> {
+ public:
+  typedef std::function<void(pow_status_t)> Callback;
+
+  /**
+   * @param task The task
+   * @param control The job control
+   * @param scheduler The pool the job runs on
+   * @param priority The scheduler priority of the slices
+   * @param slots The maximum number of threads working on the job at once, 0 for all pool threads
+   * @param done Called from a pool thread once the job is complete
+   */
+  PowJob(std::shared_ptr<PowTask> task, std::shared_ptr<Control> control, Scheduler *scheduler, priority_t priority,
+         size_t slots, Callback done);
+
+  /**
+   * Submits the job to the scheduler
+   *
+   * @return false if the scheduler rejected it
+   */
+  bool start();
+
+ private:
+  void advance(pow_status_t status);
+  void slice(std::shared_ptr<Search> search);
+
+  std::shared_ptr<PowTask> task_;
+  std::shared_ptr<Control> control_;
+  Scheduler *scheduler_;
+  priority_t priority_;
+  size_t slots_;
+  Callback done_;
+  // Slices running at once
+  std::atomic<size_t> running_;
+  std::mutex mutex_;
+  std::shared_ptr<Search> search_;
+};
+
+/**
+ * Runs a PowTask on the scheduler and waits for its completion
+ *
+ * @return POW_FOUND, the reason the job stopped or POW_REJECTED
+ */
+pow_status_t runPowTask(std::shared_ptr<PowTask> task, std::shared_ptr<Control> control, Scheduler *scheduler,
+                        priority_t priority, size_t slots);
+
+}  // namespace entangled
+
+#endif  // __POW_JOB_H__
@@ -0,0 +1,72 @@
+/*
+ * Copyright (c) 2020 IOTA Stiftung
+ * https://github.com/iotaledger/entangled-node
+ *
+ * Refer to the LICENSE file for licensing information
+ */
+
+#include <string.h>
+
+#include "pow/curl.h"
+#include "pow/midstate.h"
+
+namespace entangled {
+
+// About 3 MB of prefixes and states
+static size_t const kDefaultCapacity = 1024;
+
+MidstateCache &MidstateCache::instance() {
+  // Never destroyed, like the scheduler it serves
+  static MidstateCache *cache = new MidstateCache(kDefaultCapacity);
+  return *cache;
+}
+
+void MidstateCache::midstate(std::string const &prefix, trit_t *state) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto entry = index_.find(prefix);
+    if (entry != index_.end()) {
+      entries_.splice(entries_.begin(), entries_, entry->second);
+      memcpy(state, entry->second->second.data(), kStateTrits * sizeof(trit_t));
+      hits_++;
+      return;
+    }
+    misses_++;
+  }
+
+  // Absorbed outside of the lock, a concurrent miss on the same prefix computes the same state
+  std::vector<trit_t> trits(3 * prefix.size());
+  Curl curl;
+  trytesToTrits(prefix.data(), prefix.size(), trits.data());
+  curl.absorb(trits.data(), trits.size());
+  memcpy(state, curl.state(), kStateTrits * sizeof(trit_t));
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (capacity_ == 0 || index_.find(prefix) != index_.end()) {
+    return;
+  }
+  entries_.emplace_front(prefix, std::vector<trit_t>(state, state + kStateTrits));
+  index_[prefix] = entries_.begin();
+  evict();
+}
+
+void MidstateCache::setCapacity(size_t capacity) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  capacity_ = capacity;
+  evict();
+}
+
+midstate_cache_stats_t MidstateCache::stats() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  midstate_cache_stats_t stats = {entries_.size(), capacity_, hits_, misses_};
+  return stats;
+}
+
+void MidstateCache::evict() {
+  while (entries_.size() > capacity_) {
+    index_.erase(entries_.back().first);
+    entries_.pop_back();
+  }
+}
+
+}  // namespace entangled
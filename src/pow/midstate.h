@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) 2020 IOTA Stiftung
+ * https://github.com/iotaledger/entangled-node
+ *
+ * Refer to the LICENSE file for licensing information
+ */
+
+#ifndef __POW_MIDSTATE_H__
+#define __POW_MIDSTATE_H__
+
+#include <stdint.h>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "pow/trinary.h"
+
+namespace entangled {
+
+typedef struct {
+  size_t entries;
+  size_t capacity;
+  uint64_t hits;
+  uint64_t misses;
+} midstate_cache_stats_t;
+
+/**
+ * Process-wide LRU cache of the Curl-P-81 state after absorbing the invariant prefix of a transaction, everything
+ * before its trunk. Attaching a transaction again, to another trunk and branch, then only absorbs its last blocks.
+ */
+class MidstateCache {
+ public:
+  static MidstateCache &instance();
+
+  /**
+   * Computes the Curl state after absorbing a prefix, from the cache if possible
+   *
+   * @param prefix The prefix trytes, a multiple of 81 long
+   * @param state The kStateTrits output state
+   */
+  void midstate(std::string const &prefix, trit_t *state);
+
+  /**
+   * Sets the maximum number of states kept, 0 disabling the cache
+   */
+  void setCapacity(size_t capacity);
+
+  midstate_cache_stats_t stats();
+
+ private:
+  typedef std::pair<std::string, std::vector<trit_t>> entry_t;
+
+  explicit MidstateCache(size_t capacity) : capacity_(capacity), hits_(0), misses_(0) {}
+
+  // Called with mutex_ held
+  void evict();
+
+  std::mutex mutex_;
+  std::list<entry_t> entries_;
+  std::unordered_map<std::string, std::list<entry_t>::iterator> index_;
+  size_t capacity_;
+  uint64_t hits_;
+  uint64_t misses_;
+};
+
+}  // namespace entangled
+
+#endif  // __POW_MIDSTATE_H__
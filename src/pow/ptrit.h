@@ -0,0 +1,147 @@
+/*
+ * Copyright (c) 2020 IOTA Stiftung
+ * https://github.com/iotaledger/entangled-node
+ *
+ * Refer to the LICENSE file for licensing information
+ */
+
+#ifndef __POW_PTRIT_H__
+#define __POW_PTRIT_H__
+
+#include <stdint.h>
+#include <memory>
+
+#if defined(PTRIT_SSE2)
+#include <emmintrin.h>
+#endif
+
+#include "pow/trinary.h"
+
+namespace entangled {
+
+/*
+ * Bitsliced trits: every bit of a word is an independent lane, a trit being the pair (low, high) of words with
+ * -1 = (1, 0), 0 = (1, 1) and 1 = (0, 1). The lane types below are the backends the kernels are instantiated on.
+ */
+
+struct Ptrit64 {
+  typedef uint64_t word;
+  static size_t const kLanes = 64;
+
+  static word zero() { return 0; }
+  static word ones() { return ~static_cast<uint64_t>(0); }
+  static word band(word a, word b) { return a & b; }
+  static word bor(word a, word b) { return a | b; }
+  static word bxor(word a, word b) { return a ^ b; }
+  static word bnot(word a) { return ~a; }
+  static word bandnot(word a, word b) { return ~a & b; }
+  static word load(uint64_t const *chunks) { return chunks[0]; }
+  static void store(word a, uint64_t *chunks) { chunks[0] = a; }
+};
+
+#if defined(PTRIT_SSE2)
+struct PtritSse2 {
+  typedef __m128i word;
+  static size_t const kLanes = 128;
+
+  static word zero() { return _mm_setzero_si128(); }
+  static word ones() { return _mm_set1_epi32(-1); }
+  static word band(word a, word b) { return _mm_and_si128(a, b); }
+  static word bor(word a, word b) { return _mm_or_si128(a, b); }
+  static word bxor(word a, word b) { return _mm_xor_si128(a, b); }
+  static word bnot(word a) { return _mm_xor_si128(a, ones()); }
+  static word bandnot(word a, word b) { return _mm_andnot_si128(a, b); }
+  static word load(uint64_t const *chunks) { return _mm_loadu_si128(reinterpret_cast<__m128i const *>(chunks)); }
+  static void store(word a, uint64_t *chunks) { _mm_storeu_si128(reinterpret_cast<__m128i *>(chunks), a); }
+};
+#endif
+
+/**
+ * Heap storage for lane words, aligned for the widest vector type. Kernel state is too large for the stacks of
+ * secondary threads on some platforms.
+ */
+template <class P>
+class LaneBuffer {
+ public:
+  typedef typename P::word word;
+
+  explicit LaneBuffer(size_t count) : storage_(new unsigned char[count * sizeof(word) + kAlignment]) {
+    uintptr_t address = reinterpret_cast<uintptr_t>(storage_.get());
+    words_ = reinterpret_cast<word *>((address + kAlignment - 1) & ~static_cast<uintptr_t>(kAlignment - 1));
+  }
+
+  word *get() { return words_; }
+
+ private:
+  static size_t const kAlignment = 64;
+
+  std::unique_ptr<unsigned char[]> storage_;
+  word *words_;
+};
+
+/**
+ * Bitsliced Curl-P-81 transform over every lane of a state
+ *
+ * @param low The low words of the 729 state trits
+ * @param high The high words of the 729 state trits
+ * @param scratchLow Scratch space for 729 words
+ * @param scratchHigh Scratch space for 729 words
+ */
+template <class P>
+inline void ptritTransform(typename P::word *low, typename P::word *high, typename P::word *scratchLow,
+                           typename P::word *scratchHigh) {
+  typedef typename P::word word;
+  word *fromLow = low, *fromHigh = high, *toLow = scratchLow, *toHigh = scratchHigh;
+
+  for (size_t round = 0; round < 81; round++) {
+    size_t index = 0;
+    for (size_t i = 0; i < kStateTrits; i++) {
+      size_t prev = index;
+      index = index < 365 ? index + 364 : index - 365;
+      word alpha = fromLow[prev];
+      word beta = fromHigh[prev];
+      word gamma = fromHigh[index];
+      word delta = P::bandnot(P::bandnot(alpha, gamma), P::bxor(fromLow[index], beta));
+      toLow[i] = P::bnot(delta);
+      toHigh[i] = P::bor(P::bxor(alpha, gamma), delta);
+    }
+    word *tmp = fromLow;
+    fromLow = toLow;
+    toLow = tmp;
+    tmp = fromHigh;
+    fromHigh = toHigh;
+    toHigh = tmp;
+  }
+
+  // An odd number of rounds leaves the result in the scratch buffers
+  for (size_t i = 0; i < kStateTrits; i++) {
+    low[i] = fromLow[i];
+    high[i] = fromHigh[i];
+  }
+}
+
+/**
+ * Sets a trit on every lane of a bitsliced state
+ */
+template <class P>
+inline void ptritBroadcast(trit_t trit, typename P::word &low, typename P::word &high) {
+  low = trit != 1 ? P::ones() : P::zero();
+  high = trit != -1 ? P::ones() : P::zero();
+}
+
+/**
+ * Reads the trit of a single lane of a bitsliced state
+ */
+template <class P>
+inline trit_t ptritGet(typename P::word const &low, typename P::word const &high, size_t lane) {
+  uint64_t lowChunks[P::kLanes / 64], highChunks[P::kLanes / 64];
+  P::store(low, lowChunks);
+  P::store(high, highChunks);
+  bool l = (lowChunks[lane / 64] >> (lane % 64)) & 1;
+  bool h = (highChunks[lane / 64] >> (lane % 64)) & 1;
+  return static_cast<trit_t>(l == h ? 0 : (l ? -1 : 1));
+}
+
+}  // namespace entangled
+
+#endif  // __POW_PTRIT_H__
@@ -0,0 +1,303 @@
+/*
+ * Copyright (c) 2020 IOTA Stiftung
+ * https://github.com/iotaledger/entangled-node
+ *
+ * Refer to the LICENSE file for licensing information
+ */
+
+#include <string.h>
+#include <algorithm>
+
+#include "pow/cpu.h"
+#include "pow/curl.h"
+#include "pow/search_kernel.h"
+
+namespace entangled {
+
+char const *powStatusMessage(pow_status_t status) {
+  switch (status) {
+    case POW_SEARCHING:
+      return "Proof of Work in progress";
+    case POW_FOUND:
+      return "Proof of Work found";
+    case POW_CANCELLED:
+      return "Proof of Work cancelled";
+    case POW_TIMED_OUT:
+      return "Proof of Work deadline exceeded";
+    case POW_INVALID_INPUT:
+      return "Invalid Proof of Work input";
+    case POW_REJECTED:
+      return "Scheduler queue is full";
+    case POW_EXHAUSTED:
+      return "Proof of Work not found in the nonce range";
+    case POW_UNAVAILABLE:
+      return "Proof of Work worker unavailable";
+  }
+  return "Unknown Proof of Work status";
+}
+
+static std::atomic<int> selectedKernel(-1);
+
+char const *powKernelName(pow_kernel_t kernel) {
+  switch (kernel) {
+    case POW_KERNEL_PTRIT64:
+      return "ptrit64";
+    case POW_KERNEL_SSE2:
+      return "sse2";
+    case POW_KERNEL_AVX2:
+      return "avx2";
+    case POW_KERNEL_AVX512:
+      return "avx512";
+    default:
+      return "unknown";
+  }
+}
+
+bool powKernelFromName(char const *name, pow_kernel_t &kernel) {
+  for (int i = 0; i < POW_KERNEL_COUNT; i++) {
+    if (strcmp(name, powKernelName(static_cast<pow_kernel_t>(i))) == 0) {
+      kernel = static_cast<pow_kernel_t>(i);
+      return true;
+    }
+  }
+  return false;
+}
+
+bool powKernelSupported(pow_kernel_t kernel) {
+  cpu_features_t const &cpu = cpuFeatures();
+
+  switch (kernel) {
+    case POW_KERNEL_PTRIT64:
+      return true;
+#if defined(PTRIT_SSE2)
+    case POW_KERNEL_SSE2:
+      return cpu.sse2;
+#endif
+#if defined(ENTANGLED_POW_AVX2)
+    case POW_KERNEL_AVX2:
+      return cpu.avx2;
+#endif
+#if defined(ENTANGLED_POW_AVX512)
+    case POW_KERNEL_AVX512:
+      return cpu.avx512f;
+#endif
+    default:
+      return false;
+  }
+}
+
+void partitionRange(uint64_t index, uint64_t count, uint64_t &start, uint64_t &end) {
+  start = kCounterValues * index / count;
+  end = kCounterValues * (index + 1) / count;
+}
+
+size_t powKernelLanes(pow_kernel_t kernel) {
+  switch (kernel) {
+    case POW_KERNEL_SSE2:
+      return 128;
+    case POW_KERNEL_AVX2:
+      return 256;
+    case POW_KERNEL_AVX512:
+      return 512;
+    default:
+      return 64;
+  }
+}
+
+void setPowKernel(pow_kernel_t kernel) { selectedKernel.store(kernel, std::memory_order_relaxed); }
+
+pow_kernel_t powKernel() {
+  // Chosen once from cpuid, unless set otherwise
+  static pow_kernel_t const widest = [] {
+    int kernel = POW_KERNEL_COUNT - 1;
+    while (kernel > 0 && !powKernelSupported(static_cast<pow_kernel_t>(kernel))) {
+      kernel--;
+    }
+    return static_cast<pow_kernel_t>(kernel);
+  }();
+  int kernel = selectedKernel.load(std::memory_order_relaxed);
+
+  return kernel >= 0 ? static_cast<pow_kernel_t>(kernel) : widest;
+}
+
+static trit_t const kInitialState[kStateTrits] = {0};
+
+Search::Search(trit_t const *trits, size_t length, uint8_t mwm, pow_kernel_t kernel)
+    : Search(kInitialState, trits, length, mwm, kernel) {}
+
+// Values of an iteration counter of some trits, kCounterValues for the 27 trits of a transaction nonce
+static uint64_t counterValues(size_t trits) {
+  uint64_t values = 1;
+
+  for (size_t i = 0; i < trits; i++) {
+    values *= 3;
+  }
+  return values;
+}
+
+Search::Search(trit_t const *state, trit_t const *trits, size_t length, uint8_t mwm, pow_kernel_t kernel)
+    : Search(state, trits, length, length - kNonceTrits, kNonceTrits, mwm, kernel) {}
+
+Search::Search(trit_t const *trits, size_t length, size_t nonceOffset, size_t nonceTrits, uint8_t mwm,
+               pow_kernel_t kernel)
+    : Search(kInitialState, trits, length, nonceOffset, nonceTrits, mwm, kernel) {}
+
+Search::Search(trit_t const *state, trit_t const *trits, size_t length, size_t nonceOffset, size_t nonceTrits,
+               uint8_t mwm, pow_kernel_t kernel)
+    : Search(1, state, trits + nonceOffset / kHashTrits * kHashTrits, mwm, kernel) {
+  size_t block = nonceOffset / kHashTrits * kHashTrits;
+  Curl curl;
+
+  memcpy(curl.state(), state, kStateTrits * sizeof(trit_t));
+  curl.absorb(trits, block);
+  memcpy(&midstates_[kHashTrits], curl.state() + kHashTrits, (kStateTrits - kHashTrits) * sizeof(trit_t));
+
+  nonceOffset_ = nonceOffset - block;
+  nonceTrits_ = nonceTrits;
+  counterTrits_ = std::min(kCounterTrits, nonceTrits - kLaneTrits);
+  end_ = counterValues(counterTrits_);
+  tail_.assign(trits + block + kHashTrits, trits + length);
+}
+
+bool Search::validNonce(size_t length, size_t nonceOffset, size_t nonceTrits) {
+  return length % kHashTrits == 0 && nonceTrits >= kMinNonceTrits && nonceOffset + nonceTrits <= length &&
+         nonceOffset / kHashTrits == (nonceOffset + nonceTrits - 1) / kHashTrits;
+}
+
+Search::Search(size_t groups, trit_t const *states, trit_t const *blocks, uint8_t mwm, pow_kernel_t kernel)
+    : groups_(groups),
+      mwm_(mwm),
+      kernel_(kernel),
+      nonceOffset_(kNonceOffset),
+      nonceTrits_(kNonceTrits),
+      counterTrits_(kCounterTrits),
+      midstates_(groups * kStateTrits),
+      results_(groups * kHashTrits),
+      next_(0),
+      end_(kCounterValues),
+      completed_(0),
+      status_(POW_SEARCHING),
+      solved_(groups, false),
+      solvedCount_(0),
+      laidOut_(static_cast<size_t>(-1)) {
+  for (size_t group = 0; group < groups; group++) {
+    trit_t *midstate = &midstates_[group * kStateTrits];
+
+    memcpy(midstate, states + group * kStateTrits, kStateTrits * sizeof(trit_t));
+    memcpy(midstate, blocks + group * kHashTrits, kHashTrits * sizeof(trit_t));
+  }
+}
+
+void Search::setRange(uint64_t start, uint64_t end) {
+  end_ = std::min(end, counterValues(counterTrits_));
+  next_.store(std::min(start, end_), std::memory_order_relaxed);
+  completed_.store(std::min(start, end_), std::memory_order_relaxed);
+  if (start >= end_) {
+    status_.store(POW_EXHAUSTED, std::memory_order_relaxed);
+  }
+}
+
+pow_status_t Search::work(Control &control, Control::clock::time_point until) {
+  if (mwm_ > kHashTrits || groups_ == 0 || groups_ > std::max<size_t>(1, maxGroups(kernel_))) {
+    return POW_INVALID_INPUT;
+  }
+  switch (kernel_) {
+#if defined(PTRIT_SSE2)
+    case POW_KERNEL_SSE2:
+      return work<PtritSse2>(control, until);
+#endif
+#if defined(ENTANGLED_POW_AVX2)
+    case POW_KERNEL_AVX2:
+      return workAvx2(control, until);
+#endif
+#if defined(ENTANGLED_POW_AVX512)
+    case POW_KERNEL_AVX512:
+      return workAvx512(control, until);
+#endif
+    default:
+      return work<Ptrit64>(control, until);
+  }
+}
+
+void Search::layout() {
+  size_t chunks = powKernelLanes(kernel_) / 64;
+  std::vector<uint64_t> masks;
+
+  laidOut_ = solvedCount_.load(std::memory_order_relaxed);
+  active_.clear();
+  for (size_t group = 0; group < groups_; group++) {
+    if (!solved_[group]) {
+      active_.push_back(group);
+    }
+  }
+  lanes_.assign(2 * kStateTrits * chunks, 0);
+  if (active_.empty()) {
+    return;
+  }
+
+  // Lane i works on active_[i % count], each trit being the union of the lanes of the groups it is set in
+  size_t count = active_.size();
+  masks.assign(count * chunks, 0);
+  for (size_t lane = 0; lane < 64 * chunks; lane++) {
+    masks[(lane % count) * chunks + lane / 64] |= static_cast<uint64_t>(1) << (lane % 64);
+  }
+  for (size_t k = 0; k < count; k++) {
+    trit_t const *midstate = &midstates_[active_[k] * kStateTrits];
+    uint64_t const *mask = &masks[k * chunks];
+    for (size_t i = 0; i < kStateTrits; i++) {
+      uint64_t *low = &lanes_[2 * i * chunks], *high = low + chunks;
+      uint64_t lowSet = midstate[i] != 1 ? ~static_cast<uint64_t>(0) : 0;
+      uint64_t highSet = midstate[i] != -1 ? ~static_cast<uint64_t>(0) : 0;
+      for (size_t c = 0; c < chunks; c++) {
+        low[c] |= mask[c] & lowSet;
+        high[c] |= mask[c] & highSet;
+      }
+    }
+  }
+
+  // Every lane starts from its own index within its group, written in the first nonce trits
+  for (size_t lane = 0; lane < 64 * chunks; lane++) {
+    size_t digit = lane / count;
+    for (size_t t = 0; t < kLaneTrits; t++) {
+      uint64_t *low = &lanes_[2 * (nonceOffset_ + t) * chunks], *high = low + chunks;
+      uint64_t bit = static_cast<uint64_t>(1) << (lane % 64);
+      trit_t trit = static_cast<trit_t>(digit % 3) - 1;
+      low[lane / 64] = trit != 1 ? low[lane / 64] | bit : low[lane / 64] & ~bit;
+      high[lane / 64] = trit != -1 ? high[lane / 64] | bit : high[lane / 64] & ~bit;
+      digit /= 3;
+    }
+  }
+}
+
+void Search::found(size_t group, trit_t const *nonceBlock) {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  if (solved_[group] || status_.load(std::memory_order_relaxed) != POW_SEARCHING) {
+    return;
+  }
+  memcpy(&results_[group * kHashTrits], nonceBlock, kHashTrits * sizeof(trit_t));
+  solved_[group] = true;
+
+  size_t solved = solvedCount_.load(std::memory_order_relaxed) + 1;
+  solvedCount_.store(solved, std::memory_order_relaxed);
+  if (solved == groups_) {
+    int expected = POW_SEARCHING;
+    status_.compare_exchange_strong(expected, POW_FOUND, std::memory_order_acq_rel);
+  }
+}
+
+void Search::nonce(trit_t *nonce, size_t group) const {
+  memcpy(nonce, &results_[group * kHashTrits + nonceOffset_], nonceTrits_ * sizeof(trit_t));
+}
+
+void Search::hash(trit_t *hash, size_t group) const {
+  Curl curl;
+
+  memcpy(curl.state(), &midstates_[group * kStateTrits], kStateTrits * sizeof(trit_t));
+  memcpy(curl.state(), &results_[group * kHashTrits], kHashTrits * sizeof(trit_t));
+  curl.transform();
+  curl.absorb(tail_.data(), tail_.size());
+  memcpy(hash, curl.state(), kHashTrits * sizeof(trit_t));
+}
+
+}  // namespace entangled
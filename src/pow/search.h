@@ -0,0 +1,362 @@
+/*
+ * Copyright (c) 2020 IOTA Stiftung
+ * https://github.com/iotaledger/entangled-node
+ *
+ * Refer to the LICENSE file for licensing information
+ */
+
+#ifndef __POW_SEARCH_H__
+#define __POW_SEARCH_H__
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+
+#include "pow/trinary.h"
+
+namespace entangled {
+
+static size_t const kNonceTrits = 81;
+
+// Values of the iteration counter written in the nonce, 3^27, each of them covering the nonces of every lane
+static uint64_t const kCounterValues = 7625597484987ULL;
+
+// Maximum number of partitions of the counter values
+static uint64_t const kMaxPartitions = 1 << 20;
+
+/**
+ * Returns the counter range of a partition of the nonce space, see Search::setRange()
+ *
+ * @param index The partition index, below count
+ * @param count The number of partitions, at most kMaxPartitions
+ * @param start The first counter value of the partition
+ * @param end The counter value after the last one of the partition
+ */
+void partitionRange(uint64_t index, uint64_t count, uint64_t &start, uint64_t &end);
+
+typedef enum {
+  POW_SEARCHING = 0,
+  POW_FOUND,
+  POW_CANCELLED,
+  POW_TIMED_OUT,
+  POW_INVALID_INPUT,
+  POW_REJECTED,
+  POW_EXHAUSTED,
+  POW_UNAVAILABLE,
+} pow_status_t;
+
+/**
+ * Returns a human readable description of a search status
+ */
+char const *powStatusMessage(pow_status_t status);
+
+/**
+ * Lane types the search kernel can run on, see ptrit.h
+ */
+typedef enum {
+  POW_KERNEL_PTRIT64 = 0,
+  POW_KERNEL_SSE2,
+  POW_KERNEL_AVX2,
+  POW_KERNEL_AVX512,
+  POW_KERNEL_COUNT,
+} pow_kernel_t;
+
+/**
+ * Returns the name of a kernel, as used by the JS API
+ */
+char const *powKernelName(pow_kernel_t kernel);
+
+/**
+ * Parses a kernel name
+ *
+ * @return false if the name is unknown
+ */
+bool powKernelFromName(char const *name, pow_kernel_t &kernel);
+
+/**
+ * Returns whether a kernel was built in and runs on this CPU and operating system
+ */
+bool powKernelSupported(pow_kernel_t kernel);
+
+/**
+ * Returns the number of lanes of a kernel, the nonces it tries per transform
+ */
+size_t powKernelLanes(pow_kernel_t kernel);
+
+/**
+ * Sets the kernel of the searches created from now on, process-wide. It must be supported.
+ */
+void setPowKernel(pow_kernel_t kernel);
+
+/**
+ * Returns the kernel of new searches, the widest supported one unless set otherwise
+ */
+pow_kernel_t powKernel();
+
+/**
+ * Caller side handle on a running Proof of Work job, possibly made of several searches. It can be cancelled or
+ * given a deadline from any thread, and accumulates the number of nonces tried, the number of threads that searched
+ * at once and the backend the job ran on.
+ */
+class Control {
+ public:
+  typedef std::chrono::steady_clock clock;
+
+  Control()
+      : cancelled_(false),
+        hasDeadline_(false),
+        attempts_(0),
+        threads_(0),
+        backend_(NULL),
+        finished_(false),
+        start_(clock::now()) {}
+
+  void cancel() { cancelled_.store(true, std::memory_order_relaxed); }
+
+  /**
+   * Makes every search of the job stop after timeoutMs milliseconds from now
+   */
+  void setTimeout(uint64_t timeoutMs) {
+    deadline_ = clock::now() + std::chrono::milliseconds(timeoutMs);
+    hasDeadline_ = true;
+  }
+
+  /**
+   * Returns POW_SEARCHING as long as the job may proceed, otherwise the reason it must stop
+   */
+  pow_status_t check() const {
+    if (cancelled_.load(std::memory_order_relaxed)) {
+      return POW_CANCELLED;
+    }
+    if (hasDeadline_ && clock::now() >= deadline_) {
+      return POW_TIMED_OUT;
+    }
+    return POW_SEARCHING;
+  }
+
+  void addAttempts(uint64_t attempts) { attempts_.fetch_add(attempts, std::memory_order_relaxed); }
+  uint64_t attempts() const { return attempts_.load(std::memory_order_relaxed); }
+
+  /**
+   * Records that a number of threads searched at once, threads() being the largest such number
+   */
+  void recordThreads(size_t threads) {
+    size_t current = threads_.load(std::memory_order_relaxed);
+    while (threads > current && !threads_.compare_exchange_weak(current, threads, std::memory_order_relaxed)) {
+    }
+  }
+  size_t threads() const { return threads_.load(std::memory_order_relaxed); }
+
+  /**
+   * Records the name of the backend the job ran on, see PowBackend::name()
+   */
+  void setBackend(char const *backend) { backend_.store(backend, std::memory_order_relaxed); }
+  char const *backend() const { return backend_.load(std::memory_order_relaxed); }
+
+  double elapsedMs() const {
+    return std::chrono::duration<double, std::milli>(clock::now() - start_).count();
+  }
+
+  /**
+   * Marks the job as complete and wakes up waitFinished()
+   */
+  void finish() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    finished_ = true;
+    cond_.notify_all();
+  }
+
+  /**
+   * Waits for finish() for at most timeoutMs milliseconds
+   *
+   * @return true if the job is complete
+   */
+  bool waitFinished(uint64_t timeoutMs) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    return cond_.wait_for(lock, std::chrono::milliseconds(timeoutMs), [this] { return finished_; });
+  }
+
+ private:
+  std::atomic<bool> cancelled_;
+  bool hasDeadline_;
+  clock::time_point deadline_;
+  std::atomic<uint64_t> attempts_;
+  std::atomic<size_t> threads_;
+  std::atomic<char const *> backend_;
+  std::mutex mutex_;
+  std::condition_variable cond_;
+  bool finished_;
+  clock::time_point start_;
+};
+
+// Lanes a lane-packed search gives each of its buffers at least
+static size_t const kMinGroupLanes = 8;
+
+// Nonce trits a search needs at least: the lane index, then at least one iteration counter trit
+static size_t const kMinNonceTrits = 9;
+
+/**
+ * Nonce search over a trit buffer whose nonce lies within one 243 trit block, by default the last 81 trits of its
+ * last block as in a transaction. Lanes of the bitsliced kernel try different values of the first nonce trits, while
+ * an iteration counter written right after them is shared between threads. The blocks after the nonce block, if any,
+ * are absorbed by every lane.
+ *
+ * A search may also pack several independent buffers, called groups, into the lanes of one kernel: each group is
+ * solved as soon as one of its lanes meets the weight, and its lanes are then spread over the groups left.
+ */
+class Search {
+ public:
+  /**
+   * @param trits The trits, a multiple of 243 long
+   * @param length The number of trits
+   * @param mwm The minimum weight magnitude
+   * @param kernel The kernel the search runs on, it must be supported
+   */
+  Search(trit_t const *trits, size_t length, uint8_t mwm, pow_kernel_t kernel = powKernel());
+
+  /**
+   * Search over a buffer whose first blocks were already absorbed
+   *
+   * @param state The kStateTrits Curl state after absorbing the first blocks
+   * @param trits The remaining trits, a multiple of 243 long
+   * @param length The number of remaining trits
+   * @param mwm The minimum weight magnitude
+   * @param kernel The kernel the search runs on, it must be supported
+   */
+  Search(trit_t const *state, trit_t const *trits, size_t length, uint8_t mwm, pow_kernel_t kernel = powKernel());
+
+  /**
+   * Hashcash search over a buffer whose nonce lies anywhere, see validNonce()
+   *
+   * @param trits The trits, a multiple of 243 long
+   * @param length The number of trits
+   * @param nonceOffset The offset of the nonce
+   * @param nonceTrits The number of nonce trits
+   * @param mwm The minimum weight magnitude
+   * @param kernel The kernel the search runs on, it must be supported
+   */
+  Search(trit_t const *trits, size_t length, size_t nonceOffset, size_t nonceTrits, uint8_t mwm,
+         pow_kernel_t kernel = powKernel());
+
+  /**
+   * Returns whether a search can place a nonce in a buffer: at least kMinNonceTrits long and within one block of a
+   * buffer a multiple of 243 trits long
+   */
+  static bool validNonce(size_t length, size_t nonceOffset, size_t nonceTrits);
+
+  /**
+   * Lane-packed search over several buffers whose blocks but the last were already absorbed
+   *
+   * @param groups The number of buffers, at most maxGroups(kernel)
+   * @param states The kStateTrits Curl state of each buffer after absorbing its blocks but the last
+   * @param blocks The last 243 trits of each buffer
+   * @param mwm The minimum weight magnitude, shared by every buffer
+   * @param kernel The kernel the search runs on, it must be supported
+   */
+  Search(size_t groups, trit_t const *states, trit_t const *blocks, uint8_t mwm, pow_kernel_t kernel = powKernel());
+
+  /**
+   * Returns the number of buffers a search on a kernel may pack
+   */
+  static size_t maxGroups(pow_kernel_t kernel) { return powKernelLanes(kernel) / kMinGroupLanes; }
+
+  /**
+   * Restricts the search to a range of iteration counters, before any work. Searches over disjoint ranges try
+   * disjoint nonces, whatever their kernels, so that several processes can share a job.
+   *
+   * @param start The first counter value
+   * @param end The counter value after the last one, at most kCounterValues or 3^counter trits for a shorter nonce
+   */
+  void setRange(uint64_t start, uint64_t end);
+
+  /**
+   * Searches on the calling thread until the search ends or the time slice expires. Any number of threads may
+   * work on the same search concurrently.
+   *
+   * @param control The job control
+   * @param until The end of the time slice
+   *
+   * @return POW_SEARCHING if the slice expired or the search is drained(), otherwise POW_FOUND once every group is
+   * solved, POW_EXHAUSTED once every counter of the range was tried or the reason the search stopped
+   */
+  pow_status_t work(Control &control, Control::clock::time_point until);
+
+  pow_status_t status() const { return static_cast<pow_status_t>(status_.load(std::memory_order_acquire)); }
+
+  /**
+   * Returns whether every counter of the range was handed out, the threads running the last iterations ending the
+   * search. Threads whose slice expires past that point are not needed any more.
+   */
+  bool drained() const { return next_.load(std::memory_order_relaxed) >= end_; }
+
+  size_t groups() const { return groups_; }
+
+  /**
+   * Copies the nonce found for a group, kNonceTrits long unless set otherwise
+   */
+  void nonce(trit_t *nonce, size_t group = 0) const;
+
+  /**
+   * Computes the Curl-P-81 hash of the buffer of a group with the nonce found
+   */
+  void hash(trit_t *hash, size_t group = 0) const;
+
+ private:
+  template <class P>
+  pow_status_t work(Control &control, Control::clock::time_point until);
+
+  // Kernels built for wider instruction sets in their own translation units
+  pow_status_t workAvx2(Control &control, Control::clock::time_point until);
+  pow_status_t workAvx512(Control &control, Control::clock::time_point until);
+
+  /**
+   * Copies the lane state of the groups not solved yet into the kernel words
+   *
+   * @param low The low words of the lane state
+   * @param high The high words of the lane state
+   * @param active The groups not solved yet, lane i working on active[i % active.size()]
+   */
+  template <class P>
+  void load(typename P::word *low, typename P::word *high, std::vector<size_t> &active);
+
+  // Spreads the lanes over the groups not solved yet, with mutex_ held
+  void layout();
+
+  Search(trit_t const *state, trit_t const *trits, size_t length, size_t nonceOffset, size_t nonceTrits, uint8_t mwm,
+         pow_kernel_t kernel);
+
+  void found(size_t group, trit_t const *nonceBlock);
+
+  size_t groups_;
+  uint8_t mwm_;
+  pow_kernel_t kernel_;
+  // Offset of the nonce within its block, number of nonce trits and of counter trits within them
+  size_t nonceOffset_;
+  size_t nonceTrits_;
+  size_t counterTrits_;
+  // Per group: the Curl state with the nonce block in place of its first 243 trits, and the nonce block found
+  std::vector<trit_t> midstates_;
+  std::vector<trit_t> results_;
+  // Blocks absorbed after the nonce block
+  std::vector<trit_t> tail_;
+  std::atomic<uint64_t> next_;
+  uint64_t end_;
+  // Iterations done, the search being exhausted once they cover the range
+  std::atomic<uint64_t> completed_;
+  std::atomic<int> status_;
+  // Guards the results and solved flags, written once per group
+  std::mutex mutex_;
+  std::vector<bool> solved_;
+  std::atomic<size_t> solvedCount_;
+  // Lane state shared by the threads: 64 lane chunks of the low then high words of every state trit, and the groups
+  // the lanes work on, as of laidOut_ groups solved
+  std::vector<uint64_t> lanes_;
+  std::vector<size_t> active_;
+  size_t laidOut_;
+};
+
+}  // namespace entangled
+
+#endif  // __POW_SEARCH_H__
@@ -0,0 +1,63 @@
+/*
+ * Copyright (c) 2020 IOTA Stiftung
+ * https://github.com/iotaledger/entangled-node
+ *
+ * Refer to the LICENSE file for licensing information
+ */
+
+#if defined(ENTANGLED_POW_AVX2)
+
+// Everything but the kernel is included first, so that only the kernel is compiled for AVX2
+#include <immintrin.h>
+#include <stdint.h>
+#include <string.h>
+#include <memory>
+#include <thread>
+
+#include "pow/search.h"
+#include "pow/transaction.h"
+
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("avx2"))), apply_to = function)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("avx2")
+#endif
+
+#include "pow/hash_kernel.h"
+#include "pow/search_kernel.h"
+
+namespace entangled {
+
+struct PtritAvx2 {
+  typedef __m256i word;
+  static size_t const kLanes = 256;
+
+  static word zero() { return _mm256_setzero_si256(); }
+  static word ones() { return _mm256_set1_epi32(-1); }
+  static word band(word a, word b) { return _mm256_and_si256(a, b); }
+  static word bor(word a, word b) { return _mm256_or_si256(a, b); }
+  static word bxor(word a, word b) { return _mm256_xor_si256(a, b); }
+  static word bnot(word a) { return _mm256_xor_si256(a, ones()); }
+  static word bandnot(word a, word b) { return _mm256_andnot_si256(a, b); }
+  static word load(uint64_t const *chunks) { return _mm256_loadu_si256(reinterpret_cast<__m256i const *>(chunks)); }
+  static void store(word a, uint64_t *chunks) { _mm256_storeu_si256(reinterpret_cast<__m256i *>(chunks), a); }
+};
+
+pow_status_t Search::workAvx2(Control &control, Control::clock::time_point until) {
+  return work<PtritAvx2>(control, until);
+}
+
+bool hashTransactionLanesAvx2(char const *trytes, size_t count, char *hashes, uint8_t *weights) {
+  return hashTransactionLanes<PtritAvx2>(trytes, count, hashes, weights);
+}
+
+}  // namespace entangled
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
+
+#endif  // ENTANGLED_POW_AVX2
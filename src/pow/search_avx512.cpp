@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) 2020 IOTA Stiftung
+ * https://github.com/iotaledger/entangled-node
+ *
+ * Refer to the LICENSE file for licensing information
+ */
+
+#if defined(ENTANGLED_POW_AVX512)
+
+// Everything but the kernel is included first, so that only the kernel is compiled for AVX-512
+#include <immintrin.h>
+#include <stdint.h>
+#include <string.h>
+#include <memory>
+#include <thread>
+
+#include "pow/search.h"
+#include "pow/transaction.h"
+
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("avx512f"))), apply_to = function)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("avx512f")
+#endif
+
+#include "pow/hash_kernel.h"
+#include "pow/search_kernel.h"
+
+namespace entangled {
+
+struct PtritAvx512 {
+  typedef __m512i word;
+  static size_t const kLanes = 512;
+
+  static word zero() { return _mm512_setzero_si512(); }
+  static word ones() { return _mm512_set1_epi32(-1); }
+  static word band(word a, word b) { return _mm512_and_si512(a, b); }
+  static word bor(word a, word b) { return _mm512_or_si512(a, b); }
+  static word bxor(word a, word b) { return _mm512_xor_si512(a, b); }
+  // Truth tables of ~c and ~a & b for vpternlog
+  static word bnot(word a) { return _mm512_ternarylogic_epi64(a, a, a, 0x55); }
+  static word bandnot(word a, word b) { return _mm512_ternarylogic_epi64(a, b, b, 0x0c); }
+  static word load(uint64_t const *chunks) { return _mm512_loadu_si512(chunks); }
+  static void store(word a, uint64_t *chunks) { _mm512_storeu_si512(chunks, a); }
+};
+
+pow_status_t Search::workAvx512(Control &control, Control::clock::time_point until) {
+  return work<PtritAvx512>(control, until);
+}
+
+bool hashTransactionLanesAvx512(char const *trytes, size_t count, char *hashes, uint8_t *weights) {
+  return hashTransactionLanes<PtritAvx512>(trytes, count, hashes, weights);
+}
+
+}  // namespace entangled
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
+
+#endif  // ENTANGLED_POW_AVX512
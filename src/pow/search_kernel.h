@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) 2020 IOTA Stiftung
+ * https://github.com/iotaledger/entangled-node
+ *
+ * Refer to the LICENSE file for licensing information
+ */
+
+#ifndef __POW_SEARCH_KERNEL_H__
+#define __POW_SEARCH_KERNEL_H__
+
+#include <string.h>
+#include <vector>
+
+#include "pow/ptrit.h"
+#include "pow/search.h"
+
+/*
+ * Search kernel, instantiated once per lane type. Translation units built for a wider instruction set include this
+ * header after selecting it, so that only the kernel is compiled for it.
+ */
+
+namespace entangled {
+
+// Layout of the nonce within its block: lane index, then iteration counter. A transaction nonce ends its last block.
+static size_t const kNonceOffset = kHashTrits - kNonceTrits;
+static size_t const kLaneTrits = 6;
+static size_t const kCounterTrits = 27;
+
+static_assert(kLaneTrits < kMinNonceTrits, "A nonce must hold the lane index and an iteration counter");
+
+template <class P>
+void Search::load(typename P::word *low, typename P::word *high, std::vector<size_t> &active) {
+  static size_t const kChunks = P::kLanes / 64;
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  if (laidOut_ != solvedCount_.load(std::memory_order_relaxed)) {
+    layout();
+  }
+  for (size_t i = 0; i < kStateTrits; i++) {
+    low[i] = P::load(&lanes_[2 * i * kChunks]);
+    high[i] = P::load(&lanes_[(2 * i + 1) * kChunks]);
+  }
+  active = active_;
+}
+
+template <class P>
+pow_status_t Search::work(Control &control, Control::clock::time_point until) {
+  typedef typename P::word word;
+  LaneBuffer<P> buffer(6 * kStateTrits);
+  word *low = buffer.get(), *high = low + kStateTrits;
+  word *stateLow = high + kStateTrits, *stateHigh = stateLow + kStateTrits;
+  word *scratchLow = stateHigh + kStateTrits, *scratchHigh = scratchLow + kStateTrits;
+  trit_t nonceBlock[kHashTrits];
+  std::vector<size_t> active;
+  size_t solved = solvedCount_.load(std::memory_order_relaxed);
+  size_t counterOffset = nonceOffset_ + kLaneTrits;
+
+  load<P>(low, high, active);
+
+  // Blocks after the nonce block are the same for every lane
+  LaneBuffer<P> tailBuffer(2 * tail_.size());
+  word *tailLow = tailBuffer.get(), *tailHigh = tailLow + tail_.size();
+  for (size_t i = 0; i < tail_.size(); i++) {
+    ptritBroadcast<P>(tail_[i], tailLow[i], tailHigh[i]);
+  }
+
+  while (status_.load(std::memory_order_relaxed) == POW_SEARCHING) {
+    pow_status_t status = control.check();
+    if (status != POW_SEARCHING) {
+      int expected = POW_SEARCHING;
+      status_.compare_exchange_strong(expected, status);
+      break;
+    }
+    if (Control::clock::now() >= until) {
+      return POW_SEARCHING;
+    }
+    // Lanes of solved groups move on to the others
+    if (solvedCount_.load(std::memory_order_relaxed) != solved) {
+      solved = solvedCount_.load(std::memory_order_relaxed);
+      load<P>(low, high, active);
+      if (active.empty()) {
+        continue;
+      }
+    }
+
+    uint64_t iteration = next_.fetch_add(1, std::memory_order_relaxed);
+    if (iteration >= end_) {
+      // The last iterations of the range are still running on other threads, this one is not requeued
+      break;
+    }
+    for (size_t i = 0; i < counterTrits_; i++) {
+      ptritBroadcast<P>(static_cast<trit_t>(iteration % 3) - 1, low[counterOffset + i], high[counterOffset + i]);
+      iteration /= 3;
+    }
+
+    memcpy(stateLow, low, kStateTrits * sizeof(word));
+    memcpy(stateHigh, high, kStateTrits * sizeof(word));
+    ptritTransform<P>(stateLow, stateHigh, scratchLow, scratchHigh);
+    for (size_t i = 0; i < tail_.size(); i += kHashTrits) {
+      memcpy(stateLow, tailLow + i, kHashTrits * sizeof(word));
+      memcpy(stateHigh, tailHigh + i, kHashTrits * sizeof(word));
+      ptritTransform<P>(stateLow, stateHigh, scratchLow, scratchHigh);
+    }
+    control.addAttempts(P::kLanes);
+
+    word mask = P::ones();
+    for (size_t i = kHashTrits - mwm_; i < kHashTrits; i++) {
+      mask = P::bandnot(P::bxor(stateLow[i], stateHigh[i]), mask);
+    }
+
+    uint64_t chunks[P::kLanes / 64];
+    P::store(mask, chunks);
+    for (size_t c = 0; c < P::kLanes / 64; c++) {
+      for (size_t lane = c * 64; chunks[c] != 0; lane++) {
+        if ((chunks[c] & 1) != 0) {
+          for (size_t i = 0; i < kHashTrits; i++) {
+            nonceBlock[i] = ptritGet<P>(low[i], high[i], lane);
+          }
+          found(active[lane % active.size()], nonceBlock);
+        }
+        chunks[c] >>= 1;
+      }
+    }
+
+    if (completed_.fetch_add(1, std::memory_order_acq_rel) + 1 == end_) {
+      int expected = POW_SEARCHING;
+      status_.compare_exchange_strong(expected, POW_EXHAUSTED);
+    }
+  }
+
+  return status();
+}
+
+}  // namespace entangled
+
+#endif  // __POW_SEARCH_KERNEL_H__
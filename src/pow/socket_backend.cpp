@@ -0,0 +1,368 @@
+/*
+ * Copyright (c) 2020 IOTA Stiftung
+ * https://github.com/iotaledger/entangled-node
+ *
+ * Refer to the LICENSE file for licensing information
+ */
+
+#ifndef _WIN32
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <algorithm>
+
+#include "pow/socket_backend.h"
+
+namespace entangled {
+
+static size_t const kMaxFrameSize = 64 << 20;
+static int const kPollIntervalMs = 50;
+
+#ifdef MSG_NOSIGNAL
+static int const kSendFlags = MSG_NOSIGNAL;
+#else
+static int const kSendFlags = 0;
+#endif
+
+bool encodeFrame(std::string const &frame, std::string &encoded) {
+  uint32_t length = static_cast<uint32_t>(frame.size());
+
+  if (frame.size() > kMaxFrameSize) {
+    return false;
+  }
+  encoded.assign({static_cast<char>(length >> 24), static_cast<char>(length >> 16), static_cast<char>(length >> 8),
+                  static_cast<char>(length)});
+  encoded += frame;
+  return true;
+}
+
+int writeSome(int fd, std::string const &data, size_t &written) {
+  while (written < data.size()) {
+    ssize_t sent = send(fd, data.data() + written, data.size() - written, kSendFlags);
+    if (sent < 0 && errno == EINTR) {
+      continue;
+    }
+    if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+      return 0;
+    }
+    if (sent <= 0) {
+      return -1;
+    }
+    written += static_cast<size_t>(sent);
+  }
+  return 1;
+}
+
+int readSome(int fd, std::string &buffer, std::string &frame) {
+  char chunk[4096];
+
+  for (;;) {
+    if (buffer.size() >= 4) {
+      unsigned char const *header = reinterpret_cast<unsigned char const *>(buffer.data());
+      size_t length = (static_cast<size_t>(header[0]) << 24) | (static_cast<size_t>(header[1]) << 16) |
+                      (static_cast<size_t>(header[2]) << 8) | header[3];
+      if (length > kMaxFrameSize) {
+        return -1;
+      }
+      // Stops at the end of the frame, the peer closing its connection right after
+      if (buffer.size() >= 4 + length) {
+        frame = buffer.substr(4, length);
+        return 1;
+      }
+    }
+
+    ssize_t received = recv(fd, chunk, sizeof(chunk), 0);
+    if (received < 0 && errno == EINTR) {
+      continue;
+    }
+    if (received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+      return 0;
+    }
+    if (received <= 0) {
+      return -1;
+    }
+    buffer.append(chunk, static_cast<size_t>(received));
+  }
+}
+
+bool setNonBlocking(int fd) {
+  int flags = fcntl(fd, F_GETFL, 0);
+  return flags >= 0 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
+PollWaker::PollWaker() {
+  if (pipe(fds_) != 0) {
+    fds_[0] = fds_[1] = -1;
+  } else if (!setNonBlocking(fds_[0]) || !setNonBlocking(fds_[1])) {
+    close(fds_[0]);
+    close(fds_[1]);
+    fds_[0] = fds_[1] = -1;
+  }
+}
+
+PollWaker::~PollWaker() {
+  if (fds_[0] >= 0) {
+    close(fds_[0]);
+    close(fds_[1]);
+  }
+}
+
+void PollWaker::wake() {
+  char byte = 0;
+
+  // A full pipe already wakes the loop
+  if (fds_[1] >= 0 && write(fds_[1], &byte, 1) < 0) {
+    return;
+  }
+}
+
+void PollWaker::drain() {
+  char bytes[64];
+
+  while (fds_[0] >= 0 && read(fds_[0], bytes, sizeof(bytes)) > 0) {
+  }
+}
+
+// Connects without blocking, a worker whose backlog is full being unavailable
+static int connectSocket(std::string const &path) {
+  struct sockaddr_un address;
+
+  if (path.size() >= sizeof(address.sun_path)) {
+    return -1;
+  }
+  memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  memcpy(address.sun_path, path.c_str(), path.size());
+
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0) {
+    return -1;
+  }
+#ifdef SO_NOSIGPIPE
+  int one = 1;
+  setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#endif
+  if (!setNonBlocking(fd) ||
+      (connect(fd, reinterpret_cast<struct sockaddr *>(&address), sizeof(address)) != 0 && errno != EINPROGRESS)) {
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+// A request and the state of its exchange with the worker, owned by the I/O thread once submitted
+struct SocketPowBackend::Exchange {
+  pow_request_t request;
+  Callback done;
+  // The encoded request frame and the number of its bytes written
+  std::string frame;
+  size_t written;
+  // The reply bytes read
+  std::string buffer;
+  size_t attempt;
+  int fd;
+  Control::clock::time_point retryAt;
+  bool finished;
+};
+
+SocketPowBackend::SocketPowBackend(std::string const &path, size_t retries, uint64_t retryDelayMs,
+                                   std::shared_ptr<PowBackend> fallback)
+    : path_(path), retries_(retries), retryDelayMs_(retryDelayMs), fallback_(fallback), stopping_(false) {
+  thread_ = std::thread([this] { run(); });
+}
+
+SocketPowBackend::~SocketPowBackend() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  waker_.wake();
+  thread_.join();
+}
+
+pow_status_t SocketPowBackend::parseReply(std::string const &reply, PowTask &task, Control &control) const {
+  char *end = NULL;
+  long status = strtol(reply.c_str(), &end, 10);
+  // A worker never replies before its search ends, and rejects requests when overloaded only
+  if (*end != ' ' || status <= POW_SEARCHING || status > POW_UNAVAILABLE || status == POW_REJECTED) {
+    return POW_UNAVAILABLE;
+  }
+  uint64_t attempts = strtoull(end + 1, &end, 10);
+  if (*end != ' ') {
+    return POW_UNAVAILABLE;
+  }
+  size_t threads = strtoul(end + 1, &end, 10);
+  control.addAttempts(attempts);
+  control.recordThreads(threads);
+  control.setBackend(name());
+  if (status != POW_FOUND) {
+    return static_cast<pow_status_t>(status);
+  }
+  if (*end != ' ' || !task.decodeResult(reply.substr(end + 1 - reply.c_str()))) {
+    return POW_UNAVAILABLE;
+  }
+  return POW_FOUND;
+}
+
+void SocketPowBackend::finish(Exchange &exchange, pow_status_t status) {
+  pow_request_t const &request = exchange.request;
+
+  if (exchange.fd >= 0) {
+    close(exchange.fd);
+    exchange.fd = -1;
+  }
+  exchange.finished = true;
+
+  if (status == POW_UNAVAILABLE && fallback_) {
+    std::shared_ptr<Control> progress;
+    if (fallback_->submit(request, exchange.done, progress)) {
+      return;
+    }
+    status = POW_REJECTED;
+  }
+  request.control->finish();
+  exchange.done(status, request.task);
+}
+
+void SocketPowBackend::retry(Exchange &exchange) {
+  if (exchange.fd >= 0) {
+    close(exchange.fd);
+    exchange.fd = -1;
+  }
+  if (++exchange.attempt > retries_) {
+    finish(exchange, POW_UNAVAILABLE);
+    return;
+  }
+  exchange.written = 0;
+  exchange.buffer.clear();
+  exchange.retryAt = Control::clock::now() + std::chrono::milliseconds(retryDelayMs_ * exchange.attempt);
+}
+
+void SocketPowBackend::open(Exchange &exchange) {
+  if ((exchange.fd = connectSocket(path_)) < 0) {
+    retry(exchange);
+  }
+}
+
+void SocketPowBackend::step(Exchange &exchange) {
+  std::string reply;
+
+  if (exchange.written < exchange.frame.size()) {
+    if (writeSome(exchange.fd, exchange.frame, exchange.written) < 0) {
+      retry(exchange);
+    }
+    return;
+  }
+
+  int read = readSome(exchange.fd, exchange.buffer, reply);
+  if (read < 0) {
+    retry(exchange);
+  } else if (read > 0) {
+    pow_status_t status = parseReply(reply, *exchange.request.task, *exchange.request.control);
+    status == POW_UNAVAILABLE ? retry(exchange) : finish(exchange, status);
+  }
+}
+
+void SocketPowBackend::run() {
+  std::vector<std::unique_ptr<Exchange>> exchanges;
+  std::vector<struct pollfd> pfds;
+  std::vector<Exchange *> polled;
+
+  for (;;) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      for (auto &exchange : submitted_) {
+        exchanges.push_back(std::move(exchange));
+      }
+      submitted_.clear();
+      if (stopping_) {
+        break;
+      }
+    }
+
+    // Giving up on a request closes its connection, which cancels it on the worker
+    auto now = Control::clock::now();
+    int timeout = kPollIntervalMs;
+    pfds.assign(1, {waker_.fd(), POLLIN, 0});
+    polled.clear();
+    for (auto &exchange : exchanges) {
+      pow_status_t status = exchange->request.control->check();
+      if (status != POW_SEARCHING) {
+        finish(*exchange, status);
+      } else if (exchange->fd < 0 && now >= exchange->retryAt) {
+        open(*exchange);
+      }
+
+      if (exchange->finished) {
+        continue;
+      }
+      if (exchange->fd >= 0) {
+        short events = exchange->written < exchange->frame.size() ? POLLOUT : POLLIN;
+        pfds.push_back({exchange->fd, events, 0});
+        polled.push_back(exchange.get());
+      } else {
+        auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(exchange->retryAt - now).count() + 1;
+        timeout = std::min<int>(timeout, static_cast<int>(wait));
+      }
+    }
+
+    if (poll(pfds.data(), pfds.size(), timeout) > 0) {
+      if (pfds[0].revents != 0) {
+        waker_.drain();
+      }
+      for (size_t i = 0; i < polled.size(); i++) {
+        if (pfds[i + 1].revents != 0) {
+          step(*polled[i]);
+        }
+      }
+    }
+
+    exchanges.erase(std::remove_if(exchanges.begin(), exchanges.end(),
+                                   [](std::unique_ptr<Exchange> const &exchange) { return exchange->finished; }),
+                    exchanges.end());
+  }
+
+  for (auto &exchange : exchanges) {
+    pow_status_t status = exchange->request.control->check();
+    finish(*exchange, status != POW_SEARCHING ? status : POW_UNAVAILABLE);
+  }
+}
+
+bool SocketPowBackend::submit(pow_request_t const &request, Callback done, std::shared_ptr<Control> &progress) {
+  std::string encoded;
+  std::unique_ptr<Exchange> exchange(new Exchange());
+
+  if (!request.task->encode(encoded) || !encodeFrame(encoded, exchange->frame)) {
+    if (!fallback_) {
+      return false;
+    }
+    return fallback_->submit(request, done, progress);
+  }
+
+  // The worker reports its attempts once done only
+  progress = std::make_shared<Control>();
+
+  exchange->request = request;
+  exchange->done = done;
+  exchange->written = 0;
+  exchange->attempt = 0;
+  exchange->fd = -1;
+  exchange->retryAt = Control::clock::now();
+  exchange->finished = false;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    submitted_.push_back(std::move(exchange));
+  }
+  waker_.wake();
+  return true;
+}
+
+}  // namespace entangled
+
+#endif  // _WIN32
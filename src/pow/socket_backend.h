@@ -0,0 +1,145 @@
+/*
+ * Copyright (c) 2020 IOTA Stiftung
+ * https://github.com/iotaledger/entangled-node
+ *
+ * Refer to the LICENSE file for licensing information
+ */
+
+#ifndef __POW_SOCKET_BACKEND_H__
+#define __POW_SOCKET_BACKEND_H__
+
+#include <stdint.h>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "pow/backend.h"
+
+/*
+ * Out-of-process Proof of Work over a Unix domain socket. Every request opens a connection to a worker process
+ * running the same core, see src/worker, and exchanges two frames on it: the request serialized by PowTask::encode(),
+ * then the reply "<status> <attempts> <threads>[ <result>]". Closing the connection cancels the request on the worker.
+ * Both ends serve all their connections from a single poll() loop.
+ */
+
+namespace entangled {
+
+/**
+ * Encodes a frame: its length as 4 big-endian bytes, then its bytes
+ *
+ * @param frame The frame
+ * @param encoded The encoded frame
+ *
+ * @return false if the frame is too large
+ */
+bool encodeFrame(std::string const &frame, std::string &encoded);
+
+/**
+ * Writes what a non-blocking connection takes of some bytes
+ *
+ * @param fd The connection
+ * @param data The bytes
+ * @param written The number of bytes written so far, updated
+ *
+ * @return -1 if the connection failed, 1 once every byte is written, 0 otherwise
+ */
+int writeSome(int fd, std::string const &data, size_t &written);
+
+/**
+ * Reads what a non-blocking connection has of an encoded frame
+ *
+ * @param fd The connection
+ * @param buffer The bytes of the frame read so far, updated
+ * @param frame The frame, once complete
+ *
+ * @return -1 if the connection failed, closed or the frame is too large, 1 once the frame is complete, 0 otherwise
+ */
+int readSome(int fd, std::string &buffer, std::string &frame);
+
+/**
+ * Sets a file descriptor non-blocking
+ *
+ * @return false if it failed
+ */
+bool setNonBlocking(int fd);
+
+/**
+ * Self-pipe waking a poll() loop from other threads. If the pipe cannot be created, its descriptor is -1, which
+ * poll() skips, and the loop only wakes on its own timeout.
+ */
+class PollWaker {
+ public:
+  PollWaker();
+  ~PollWaker();
+
+  int fd() const { return fds_[0]; }
+
+  void wake();
+
+  // Empties the pipe once poll() reported it readable
+  void drain();
+
+ private:
+  int fds_[2];
+};
+
+/**
+ * Runs the requests that can be serialized on a worker process, others in process. A request whose worker cannot be
+ * reached is retried, then runs on the fallback backend if any. All requests are exchanged by a single I/O thread,
+ * stopped and joined with the backend.
+ */
+class SocketPowBackend : public PowBackend {
+ public:
+  /**
+   * @param path The path of the worker socket
+   * @param retries The number of retries of a request whose worker cannot be reached
+   * @param retryDelayMs The delay before the first retry, growing linearly with the next ones
+   * @param fallback The backend running requests the worker cannot take or be reached for, or NULL to fail them
+   */
+  SocketPowBackend(std::string const &path, size_t retries, uint64_t retryDelayMs,
+                   std::shared_ptr<PowBackend> fallback);
+
+  // Requests still exchanged move to the fallback, closing their connection cancels them on the worker
+  ~SocketPowBackend();
+
+  char const *name() const { return "socket"; }
+
+  bool submit(pow_request_t const &request, Callback done, std::shared_ptr<Control> &progress);
+
+ private:
+  struct Exchange;
+
+  // Polls the connections of every request until the backend is destroyed
+  void run();
+
+  // Connects a request to the worker
+  void open(Exchange &exchange);
+
+  // Writes a request or reads its reply once its connection is ready
+  void step(Exchange &exchange);
+
+  // Closes the connection of a request that failed, then schedules its next attempt or gives up
+  void retry(Exchange &exchange);
+
+  // Calls back a request, or submits it to the fallback if the worker could not run it
+  void finish(Exchange &exchange, pow_status_t status);
+
+  // Parses the reply of the worker, POW_UNAVAILABLE if it is malformed or the worker could not run the request
+  pow_status_t parseReply(std::string const &reply, PowTask &task, Control &control) const;
+
+  std::string path_;
+  size_t retries_;
+  uint64_t retryDelayMs_;
+  std::shared_ptr<PowBackend> fallback_;
+  std::mutex mutex_;
+  std::vector<std::unique_ptr<Exchange>> submitted_;
+  bool stopping_;
+  PollWaker waker_;
+  std::thread thread_;
+};
+
+}  // namespace entangled
+
+#endif  // __POW_SOCKET_BACKEND_H__
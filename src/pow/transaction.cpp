@@ -0,0 +1,340 @@
+/*
+ * Copyright (c) 2020 IOTA Stiftung
+ * https://github.com/iotaledger/entangled-node
+ *
+ * Refer to the LICENSE file for licensing information
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+
+#include "pow/curl.h"
+#include "pow/midstate.h"
+#include "pow/transaction.h"
+
+namespace entangled {
+
+static int64_t const kAttachmentTimestampUpper = 3812798742493LL;
+
+static bool validTrytes(std::string const &trytes, size_t length) {
+  if (trytes.size() != length) {
+    return false;
+  }
+  for (char c : trytes) {
+    if (c != '9' && (c < 'A' || c > 'Z')) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Requests and results are serialized as fields separated by spaces, trytes never containing any
+static std::vector<std::string> splitFields(std::string const &text) {
+  std::vector<std::string> fields;
+  size_t start = 0;
+
+  for (;;) {
+    size_t end = text.find(' ', start);
+    fields.push_back(text.substr(start, end == std::string::npos ? std::string::npos : end - start));
+    if (end == std::string::npos) {
+      return fields;
+    }
+    start = end + 1;
+  }
+}
+
+static bool parseNumber(std::string const &field, uint64_t max, uint64_t &value) {
+  char *end = NULL;
+
+  if (field.empty() || field[0] < '0' || field[0] > '9') {
+    return false;
+  }
+  value = strtoull(field.c_str(), &end, 10);
+  return *end == '\0' && value <= max;
+}
+
+// Number of trailing zero trits of a hash, the weight its Proof of Work achieved
+static uint8_t hashWeight(trit_t const *hash) {
+  uint8_t weight = 0;
+
+  while (weight < kHashTrits && hash[kHashTrits - 1 - weight] == 0) {
+    weight++;
+  }
+  return weight;
+}
+
+static uint8_t transactionWeight(std::string const &trytes) {
+  trit_t trits[kTransactionTrits];
+  trit_t hash[kHashTrits];
+  Curl curl;
+
+  trytesToTrits(trytes.data(), kTransactionTrytes, trits);
+  curl.absorb(trits, kTransactionTrits);
+  curl.squeeze(hash, kHashTrits);
+  return hashWeight(hash);
+}
+
+static void setTimestamp(std::string &trytes, size_t offset, int64_t value) {
+  trit_t trits[3 * kTimestampTrytes];
+
+  longToTrits(value, trits, 3 * kTimestampTrytes);
+  tritsToTrytes(trits, kTimestampTrytes, &trytes[offset]);
+}
+
+// Everything before the trunk is left unchanged by attaching, its state is shared through the midstate cache
+static std::shared_ptr<Search> newTransactionSearch(std::string const &trytes, uint8_t mwm) {
+  trit_t state[kStateTrits];
+  trit_t tail[3 * (kTransactionTrytes - kTrunkOffset)];
+
+  MidstateCache::instance().midstate(trytes.substr(0, kTrunkOffset), state);
+  trytesToTrits(trytes.data() + kTrunkOffset, kTransactionTrytes - kTrunkOffset, tail);
+  return std::make_shared<Search>(state, tail, sizeof(tail) / sizeof(trit_t), mwm);
+}
+
+pow_status_t TrytesPowTask::next(std::shared_ptr<Search> &search) {
+  trit_t nonceTrits[kNonceTrits];
+
+  if (search) {
+    trit_t hash[kHashTrits];
+
+    search->nonce(nonceTrits);
+    nonce_.assign(kNonceTrytes, '9');
+    tritsToTrytes(nonceTrits, kNonceTrytes, &nonce_[0]);
+    search->hash(hash);
+    weight_ = hashWeight(hash);
+    return POW_FOUND;
+  }
+
+  if (!validTrytes(trytes_, kTransactionTrytes)) {
+    return POW_INVALID_INPUT;
+  }
+  search = newTransactionSearch(trytes_, mwm_);
+  search->setRange(start_, end_);
+  return POW_SEARCHING;
+}
+
+bool TrytesPowTask::encode(std::string &request) const {
+  request = "trytes " + std::to_string(mwm_) + " " + std::to_string(start_) + " " + std::to_string(end_) + " " +
+            trytes_;
+  return true;
+}
+
+bool TrytesPowTask::decodeResult(std::string const &result) {
+  if (!validTrytes(result, kNonceTrytes)) {
+    return false;
+  }
+  nonce_ = result;
+  weight_ = transactionWeight(trytes_.substr(0, kNonceOffsetTrytes) + nonce_);
+  return true;
+}
+
+pow_status_t TrytesBatchPowTask::next(std::shared_ptr<Search> &search) {
+  trit_t nonceTrits[kNonceTrits];
+
+  if (search) {
+    for (size_t group = 0; group < search->groups(); group++) {
+      std::string &nonce = nonces_[current_ + group];
+
+      search->nonce(nonceTrits, group);
+      nonce.assign(kNonceTrytes, '9');
+      tritsToTrytes(nonceTrits, kNonceTrytes, &nonce[0]);
+    }
+    current_ += search->groups();
+  } else {
+    if (trytes_.empty()) {
+      return POW_INVALID_INPUT;
+    }
+    for (auto const &trytes : trytes_) {
+      if (!validTrytes(trytes, kTransactionTrytes)) {
+        return POW_INVALID_INPUT;
+      }
+    }
+    nonces_.resize(trytes_.size());
+  }
+
+  if (current_ == trytes_.size()) {
+    search.reset();
+    return POW_FOUND;
+  }
+
+  pow_kernel_t kernel = powKernel();
+  size_t groups = std::min(trytes_.size() - current_, std::max<size_t>(1, Search::maxGroups(kernel)));
+  std::vector<trit_t> states(groups * kStateTrits);
+  std::vector<trit_t> blocks(groups * kHashTrits);
+
+  for (size_t group = 0; group < groups; group++) {
+    std::string const &trytes = trytes_[current_ + group];
+    trit_t *state = &states[group * kStateTrits];
+    trit_t tail[3 * (kTransactionTrytes - kTrunkOffset)];
+    Curl curl;
+
+    MidstateCache::instance().midstate(trytes.substr(0, kTrunkOffset), state);
+    trytesToTrits(trytes.data() + kTrunkOffset, kTransactionTrytes - kTrunkOffset, tail);
+    memcpy(curl.state(), state, kStateTrits * sizeof(trit_t));
+    curl.absorb(tail, sizeof(tail) / sizeof(trit_t) - kHashTrits);
+    memcpy(state, curl.state(), kStateTrits * sizeof(trit_t));
+    memcpy(&blocks[group * kHashTrits], tail + sizeof(tail) / sizeof(trit_t) - kHashTrits, kHashTrits * sizeof(trit_t));
+  }
+  search = std::make_shared<Search>(groups, states.data(), blocks.data(), mwm_, kernel);
+  return POW_SEARCHING;
+}
+
+pow_status_t BundlePowTask::next(std::shared_ptr<Search> &search) {
+  trit_t trits[kNonceTrits > kHashTrits ? kNonceTrits : kHashTrits];
+
+  if (search) {
+    std::string &tx = txs_[current_];
+
+    search->nonce(trits);
+    tritsToTrytes(trits, kNonceTrytes, &tx[kNonceOffsetTrytes]);
+    search->hash(trits);
+    weight_ = std::min(weight_, hashWeight(trits));
+    prev_.assign(kHashTrytes, '9');
+    tritsToTrytes(trits, kHashTrytes, &prev_[0]);
+  } else {
+    if (txs_.empty() || !validTrytes(trunk_, kHashTrytes) || !validTrytes(branch_, kHashTrytes)) {
+      return POW_INVALID_INPUT;
+    }
+    for (auto const &tx : txs_) {
+      if (!validTrytes(tx, kTransactionTrytes)) {
+        return POW_INVALID_INPUT;
+      }
+    }
+  }
+
+  // The tail of the bundle approves the head, so transactions are attached from the last one
+  if (current_ == 0) {
+    search.reset();
+    return POW_FOUND;
+  }
+  current_--;
+
+  std::string &tx = txs_[current_];
+  if (current_ == txs_.size() - 1) {
+    tx.replace(kTrunkOffset, kHashTrytes, trunk_);
+    tx.replace(kBranchOffset, kHashTrytes, branch_);
+  } else {
+    tx.replace(kTrunkOffset, kHashTrytes, prev_);
+    tx.replace(kBranchOffset, kHashTrytes, trunk_);
+  }
+
+  int64_t now =
+      std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch())
+          .count();
+  setTimestamp(tx, kAttachmentTimestampOffset, now);
+  setTimestamp(tx, kAttachmentTimestampLowerOffset, 0);
+  setTimestamp(tx, kAttachmentTimestampUpperOffset, kAttachmentTimestampUpper);
+
+  search = newTransactionSearch(tx, mwm_);
+  return POW_SEARCHING;
+}
+
+bool BundlePowTask::encode(std::string &request) const {
+  request = "bundle " + std::to_string(mwm_) + " " + trunk_ + " " + branch_;
+  request.reserve(request.size() + txs_.size() * (kTransactionTrytes + 1));
+  for (auto const &tx : txs_) {
+    request += " " + tx;
+  }
+  return true;
+}
+
+void BundlePowTask::encodeResult(std::string &result) const {
+  result.clear();
+  result.reserve(txs_.size() * (kTransactionTrytes + 1));
+  for (auto const &tx : txs_) {
+    result += (result.empty() ? "" : " ") + tx;
+  }
+}
+
+bool BundlePowTask::decodeResult(std::string const &result) {
+  std::vector<std::string> txs = splitFields(result);
+
+  if (txs.size() != txs_.size()) {
+    return false;
+  }
+  for (auto const &tx : txs) {
+    if (!validTrytes(tx, kTransactionTrytes)) {
+      return false;
+    }
+  }
+  txs_.swap(txs);
+  for (auto const &tx : txs_) {
+    weight_ = std::min(weight_, transactionWeight(tx));
+  }
+  return true;
+}
+
+std::shared_ptr<PowTask> decodePowTask(std::string const &request) {
+  std::vector<std::string> fields = splitFields(request);
+  uint64_t mwm, start, end;
+
+  if (fields.size() < 2 || !parseNumber(fields[1], kHashTrits, mwm)) {
+    return NULL;
+  }
+  if (fields[0] == "trytes" && fields.size() == 5 && parseNumber(fields[2], kCounterValues, start) &&
+      parseNumber(fields[3], kCounterValues, end)) {
+    return std::make_shared<TrytesPowTask>(fields[4], static_cast<uint8_t>(mwm), start, end);
+  }
+  if (fields[0] == "bundle" && fields.size() >= 5) {
+    std::vector<std::string> txs(fields.begin() + 4, fields.end());
+    return std::make_shared<BundlePowTask>(txs, fields[2], fields[3], static_cast<uint8_t>(mwm));
+  }
+  return NULL;
+}
+
+// Keys hold the whole request rather than a hash of it, so that distinct requests can never share a flight
+std::string trytesPowKey(std::string const &trytes, uint8_t mwm, uint64_t start, uint64_t end) {
+  std::string range;
+
+  if (start != 0 || end != kCounterValues) {
+    range = std::to_string(start) + "-" + std::to_string(end) + ":";
+  }
+  return "trytes:" + std::to_string(mwm) + ":" + range + trytes;
+}
+
+std::string trytesBatchPowKey(std::vector<std::string> const &trytes, uint8_t mwm) {
+  std::string key = "batch:" + std::to_string(mwm);
+
+  key.reserve(key.size() + trytes.size() * (kTransactionTrytes + 1));
+  for (auto const &tx : trytes) {
+    key += ":" + tx;
+  }
+  return key;
+}
+
+std::string bundlePowKey(std::vector<std::string> const &txs, std::string const &trunk, std::string const &branch,
+                         uint8_t mwm) {
+  std::string key = "bundle:" + std::to_string(mwm) + ":" + trunk + ":" + branch;
+
+  key.reserve(key.size() + txs.size() * (kTransactionTrytes + 1));
+  for (auto const &tx : txs) {
+    key += ":" + tx;
+  }
+  return key;
+}
+
+pow_status_t powTrytes(std::string const &trytes, uint8_t mwm, std::shared_ptr<Control> control,
+                       std::string &nonce) {
+  std::shared_ptr<PowTask> task = std::make_shared<TrytesPowTask>(trytes, mwm);
+
+  pow_status_t status = runPowRequest(trytesPowKey(trytes, mwm), task, control, PRIORITY_NORMAL);
+  if (status == POW_FOUND) {
+    nonce = std::static_pointer_cast<TrytesPowTask>(task)->nonce();
+  }
+  return status;
+}
+
+pow_status_t powBundle(std::vector<std::string> &txs, std::string const &trunk, std::string const &branch,
+                       uint8_t mwm, std::shared_ptr<Control> control) {
+  std::shared_ptr<PowTask> task = std::make_shared<BundlePowTask>(txs, trunk, branch, mwm);
+
+  pow_status_t status = runPowRequest(bundlePowKey(txs, trunk, branch, mwm), task, control, PRIORITY_NORMAL);
+  if (status == POW_FOUND) {
+    txs = std::static_pointer_cast<BundlePowTask>(task)->txs();
+  }
+  return status;
+}
+
+}  // namespace entangled
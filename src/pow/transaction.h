@@ -0,0 +1,191 @@
+/*
+ * Copyright (c) 2020 IOTA Stiftung
+ * https://github.com/iotaledger/entangled-node
+ *
+ * Refer to the LICENSE file for licensing information
+ */
+
+#ifndef __POW_TRANSACTION_H__
+#define __POW_TRANSACTION_H__
+
+#include <string>
+#include <vector>
+
+#include "pow/backend.h"
+
+namespace entangled {
+
+// Serialized transaction layout, in trytes
+static size_t const kTransactionTrytes = 2673;
+static size_t const kNonceTrytes = 27;
+static size_t const kTrunkOffset = 2430;
+static size_t const kBranchOffset = 2511;
+static size_t const kAttachmentTimestampOffset = 2619;
+static size_t const kAttachmentTimestampLowerOffset = 2628;
+static size_t const kAttachmentTimestampUpperOffset = 2637;
+static size_t const kNonceOffsetTrytes = 2646;
+static size_t const kTimestampTrytes = 9;
+
+static size_t const kTransactionTrits = 3 * kTransactionTrytes;
+
+/**
+ * Proof of Work on transaction trytes, producing its nonce
+ */
+class TrytesPowTask : public PowTask {
+ public:
+  /**
+   * @param trytes The transaction trytes
+   * @param mwm The minimum weight magnitude
+   * @param start The first iteration counter searched, see Search::setRange()
+   * @param end The iteration counter after the last one searched
+   */
+  TrytesPowTask(std::string const &trytes, uint8_t mwm, uint64_t start = 0, uint64_t end = kCounterValues)
+      : trytes_(trytes), mwm_(mwm), start_(start), end_(end), weight_(0) {}
+
+  pow_status_t next(std::shared_ptr<Search> &search);
+
+  bool encode(std::string &request) const;
+  void encodeResult(std::string &result) const { result = nonce_; }
+  bool decodeResult(std::string const &result);
+
+  /**
+   * Returns the nonce trytes once the task is complete
+   */
+  std::string const &nonce() const { return nonce_; }
+
+  /**
+   * Returns the number of trailing zero trits of the transaction hash once the task is complete
+   */
+  uint8_t weight() const { return weight_; }
+
+ private:
+  std::string trytes_;
+  uint8_t mwm_;
+  uint64_t start_;
+  uint64_t end_;
+  std::string nonce_;
+  uint8_t weight_;
+};
+
+/**
+ * Proof of Work on independent transaction trytes, packing up to Search::maxGroups() of them into the lanes of each
+ * search. At low weight this saves most of the setup and thread wake-ups of one search per transaction.
+ */
+class TrytesBatchPowTask : public PowTask {
+ public:
+  /**
+   * @param trytes The transactions trytes
+   * @param mwm The minimum weight magnitude
+   */
+  TrytesBatchPowTask(std::vector<std::string> const &trytes, uint8_t mwm)
+      : trytes_(trytes), mwm_(mwm), current_(0) {}
+
+  pow_status_t next(std::shared_ptr<Search> &search);
+
+  /**
+   * Returns the nonce trytes of every transaction once the task is complete
+   */
+  std::vector<std::string> const &nonces() const { return nonces_; }
+
+ private:
+  std::vector<std::string> trytes_;
+  uint8_t mwm_;
+  size_t current_;
+  std::vector<std::string> nonces_;
+};
+
+/**
+ * Proof of Work on a bundle, attaching it to trunk and branch
+ */
+class BundlePowTask : public PowTask {
+ public:
+  /**
+   * @param txs The transactions trytes, in bundle order
+   * @param trunk The trunk transaction hash trytes
+   * @param branch The branch transaction hash trytes
+   * @param mwm The minimum weight magnitude
+   */
+  BundlePowTask(std::vector<std::string> const &txs, std::string const &trunk, std::string const &branch,
+                uint8_t mwm)
+      : txs_(txs), trunk_(trunk), branch_(branch), mwm_(mwm), current_(txs.size()), weight_(kHashTrits) {}
+
+  pow_status_t next(std::shared_ptr<Search> &search);
+
+  bool encode(std::string &request) const;
+  void encodeResult(std::string &result) const;
+  bool decodeResult(std::string const &result);
+
+  /**
+   * Returns the attached transactions trytes once the task is complete
+   */
+  std::vector<std::string> const &txs() const { return txs_; }
+
+  /**
+   * Returns the smallest number of trailing zero trits of the transaction hashes once the task is complete
+   */
+  uint8_t weight() const { return weight_; }
+
+ private:
+  std::vector<std::string> txs_;
+  std::string trunk_;
+  std::string branch_;
+  uint8_t mwm_;
+  size_t current_;
+  std::string prev_;
+  uint8_t weight_;
+};
+
+/**
+ * Reads a request serialized by PowTask::encode(), for running it out of the process it was made in
+ *
+ * @return The task, or NULL if the request is malformed
+ */
+std::shared_ptr<PowTask> decodePowTask(std::string const &request);
+
+/**
+ * Returns the PowFlight key of a Proof of Work request on transaction trytes, over a range of iteration counters
+ */
+std::string trytesPowKey(std::string const &trytes, uint8_t mwm, uint64_t start = 0, uint64_t end = kCounterValues);
+
+/**
+ * Returns the PowFlight key of a Proof of Work request on a batch of transaction trytes
+ */
+std::string trytesBatchPowKey(std::vector<std::string> const &trytes, uint8_t mwm);
+
+/**
+ * Returns the PowFlight key of a Proof of Work request on a bundle
+ */
+std::string bundlePowKey(std::vector<std::string> const &txs, std::string const &trunk, std::string const &branch,
+                         uint8_t mwm);
+
+/**
+ * Does Proof of Work on transaction trytes, blocking until done. An identical request in flight is joined.
+ *
+ * @param trytes The transaction trytes
+ * @param mwm The minimum weight magnitude
+ * @param control The job control
+ * @param nonce The nonce found, in trytes
+ *
+ * @return POW_FOUND or the reason the job stopped
+ */
+pow_status_t powTrytes(std::string const &trytes, uint8_t mwm, std::shared_ptr<Control> control,
+                       std::string &nonce);
+
+/**
+ * Does Proof of Work on a bundle, blocking until done. Transactions are updated in place. An identical request in
+ * flight is joined.
+ *
+ * @param txs The transactions trytes, in bundle order
+ * @param trunk The trunk transaction hash trytes
+ * @param branch The branch transaction hash trytes
+ * @param mwm The minimum weight magnitude
+ * @param control The job control
+ *
+ * @return POW_FOUND or the reason the job stopped
+ */
+pow_status_t powBundle(std::vector<std::string> &txs, std::string const &trunk, std::string const &branch,
+                       uint8_t mwm, std::shared_ptr<Control> control);
+
+}  // namespace entangled
+
+#endif  // __POW_TRANSACTION_H__
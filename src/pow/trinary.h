@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) 2020 IOTA Stiftung
+ * https://github.com/iotaledger/entangled-node
+ *
+ * Refer to the LICENSE file for licensing information
+ */
+
+#ifndef __POW_TRINARY_H__
+#define __POW_TRINARY_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace entangled {
+
+typedef int8_t trit_t;
+
+static size_t const kHashTrits = 243;
+static size_t const kHashTrytes = kHashTrits / 3;
+static size_t const kStateTrits = 3 * kHashTrits;
+
+static char const kTryteAlphabet[] = "9ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+
+/**
+ * Converts trytes to trits
+ *
+ * @param trytes The trytes
+ * @param numTrytes The number of trytes to convert
+ * @param trits The output trits, 3 * numTrytes long
+ *
+ * @return false if a character is not a tryte
+ */
+inline bool trytesToTrits(char const *trytes, size_t numTrytes, trit_t *trits) {
+  for (size_t i = 0; i < numTrytes; i++) {
+    int value = 0;
+    char c = trytes[i];
+
+    if (c == '9') {
+      value = 0;
+    } else if (c >= 'A' && c <= 'M') {
+      value = c - 'A' + 1;
+    } else if (c >= 'N' && c <= 'Z') {
+      value = c - 'N' - 13;
+    } else {
+      return false;
+    }
+
+    for (size_t j = 0; j < 3; j++) {
+      int rem = ((value % 3) + 3) % 3;
+      if (rem == 2) {
+        rem = -1;
+      }
+      trits[3 * i + j] = static_cast<trit_t>(rem);
+      value = (value - rem) / 3;
+    }
+  }
+  return true;
+}
+
+/**
+ * Converts trits to trytes
+ *
+ * @param trits The trits, 3 * numTrytes long
+ * @param numTrytes The number of trytes to produce
+ * @param trytes The output trytes
+ */
+inline void tritsToTrytes(trit_t const *trits, size_t numTrytes, char *trytes) {
+  for (size_t i = 0; i < numTrytes; i++) {
+    int value = trits[3 * i] + 3 * trits[3 * i + 1] + 9 * trits[3 * i + 2];
+    trytes[i] = kTryteAlphabet[value >= 0 ? value : 27 + value];
+  }
+}
+
+/**
+ * Encodes an integer in balanced ternary, least significant trit first
+ *
+ * @param value The value
+ * @param trits The output trits
+ * @param length The number of trits to write
+ */
+inline void longToTrits(int64_t value, trit_t *trits, size_t length) {
+  bool negative = value < 0;
+  uint64_t abs = negative ? 0 - static_cast<uint64_t>(value) : static_cast<uint64_t>(value);
+
+  for (size_t i = 0; i < length; i++) {
+    int rem = static_cast<int>(abs % 3);
+    abs /= 3;
+    if (rem == 2) {
+      rem = -1;
+      abs++;
+    }
+    trits[i] = static_cast<trit_t>(negative ? -rem : rem);
+  }
+}
+
+/**
+ * Counts the trailing zero trits of a hash, i.e. its weight magnitude
+ *
+ * @param hash The hash trits
+ * @param length The hash length
+ */
+inline size_t trailingZeros(trit_t const *hash, size_t length) {
+  size_t zeros = 0;
+  while (zeros < length && hash[length - 1 - zeros] == 0) {
+    zeros++;
+  }
+  return zeros;
+}
+
+}  // namespace entangled
+
+#endif  // __POW_TRINARY_H__
@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2020 IOTA Stiftung
+ * https://github.com/iotaledger/entangled-node
+ *
+ * Refer to the LICENSE file for licensing information
+ */
+
+#include "ring/job_ring.h"
+
+namespace entangled {
+
+static_assert(sizeof(std::atomic<int32_t>) == sizeof(int32_t), "Shared counters must be plain int32");
+
+JobRing::JobRing(uint8_t *memory, uint32_t slots, priority_t priority, Handler handler, Notify notify)
+    : memory_(memory),
+      slots_(slots),
+      priority_(priority),
+      handler_(handler),
+      notify_(notify),
+      active_(0),
+      closed_(false) {}
+
+void JobRing::kick() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  size_t threads = Scheduler::instance().threads();
+
+  // Drainers are bounded by the pool size, so they bypass admission control like Proof of Work slices
+  while (!closed_ && active_ < threads && pending() > active_) {
+    auto self = shared_from_this();
+    active_++;
+    Scheduler::instance().resubmit(priority_, [self] { self->drain(); });
+  }
+}
+
+void JobRing::close() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  closed_ = true;
+}
+
+void JobRing::wait() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  idle_.wait(lock, [this] { return active_ == 0; });
+}
+
+bool JobRing::claim(uint32_t &index) {
+  std::atomic<int32_t> &tail = counter(kRingTail);
+  int32_t current = tail.load(std::memory_order_acquire);
+
+  do {
+    if (closed_ || current == counter(kRingHead).load(std::memory_order_acquire)) {
+      return false;
+    }
+  } while (!tail.compare_exchange_weak(current, static_cast<int32_t>(static_cast<uint32_t>(current) + 1),
+                                       std::memory_order_acq_rel));
+
+  index = static_cast<uint32_t>(current);
+  return true;
+}
+
+void JobRing::drain() {
+  uint32_t index;
+
+  do {
+    while (claim(index)) {
+      bool ok = handler_(slot(index));
+
+      state(index).store(ok ? RING_SLOT_DONE : RING_SLOT_FAILED, std::memory_order_release);
+      counter(kRingCompleted).fetch_add(1, std::memory_order_acq_rel);
+      // The producer clears the flag before collecting results, so one notification covers a whole batch
+      if (counter(kRingNotify).exchange(1, std::memory_order_acq_rel) == 0) {
+        notify_();
+      }
+    }
+  } while (!leave());
+}
+
+// Returns false if jobs were submitted after the last claim, the drainer then keeps going
+bool JobRing::leave() {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  if (!closed_ && pending() > 0) {
+    return false;
+  }
+  if (--active_ == 0) {
+    idle_.notify_all();
+  }
+  return true;
+}
+
+}  // namespace entangled
@@ -0,0 +1,145 @@
+/*
+ * Copyright (c) 2020 IOTA Stiftung
+ * https://github.com/iotaledger/entangled-node
+ *
+ * Refer to the LICENSE file for licensing information
+ */
+
+#ifndef __RING_JOB_RING_H__
+#define __RING_JOB_RING_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+#include "scheduler/scheduler.h"
+
+namespace entangled {
+
+/*
+ * Layout of the shared memory, in bytes. A header of int32 counters is followed by a power of two number of job
+ * slots. The producer writes a job into the slot of its head index, marks it submitted and then bumps the head;
+ * native threads claim jobs by bumping the tail, write the result and mark the slot done or failed; the producer
+ * frees slots in order once it read their result.
+ */
+static size_t const kRingHeaderBytes = 64;
+static size_t const kRingHead = 0;
+static size_t const kRingTail = 4;
+static size_t const kRingCompleted = 8;
+static size_t const kRingNotify = 12;
+
+static size_t const kRingSlotBytes = 2784;
+static size_t const kRingSlotState = 0;
+static size_t const kRingSlotKind = 4;
+static size_t const kRingSlotIndex = 8;
+static size_t const kRingSlotSecurity = 12;
+static size_t const kRingSlotInputLength = 16;
+static size_t const kRingSlotInput = 20;
+static size_t const kRingSlotInputBytes = 2673;
+static size_t const kRingSlotOutput = 2696;
+static size_t const kRingSlotOutputBytes = 81;
+
+typedef enum {
+  RING_SLOT_FREE = 0,
+  RING_SLOT_SUBMITTED,
+  RING_SLOT_DONE,
+  RING_SLOT_FAILED,
+} ring_slot_state_t;
+
+typedef enum {
+  RING_JOB_TRANSACTION_HASH = 1,
+  RING_JOB_ADDRESS_TRYTES,
+} ring_job_kind_t;
+
+/**
+ * Reads an int32 field of a slot
+ */
+inline int32_t ringSlotField(uint8_t const *slot, size_t offset) {
+  int32_t value;
+
+  memcpy(&value, slot + offset, sizeof(value));
+  return value;
+}
+
+/**
+ * Submission and completion ring in memory shared with JS, so that small jobs are handed over in batches instead of
+ * one native call each. Jobs are drained by up to one task per scheduler thread.
+ */
+class JobRing : public std::enable_shared_from_this<JobRing> {
+ public:
+  /**
+   * Runs the job of a slot, writing its output into the slot
+   *
+   * @return false if the job failed
+   */
+  typedef std::function<bool(uint8_t *slot)> Handler;
+
+  /**
+   * Called from a scheduler thread once jobs completed, unless the notify counter of the header is still set
+   */
+  typedef std::function<void()> Notify;
+
+  /**
+   * @param memory The shared memory, 4 bytes aligned, kRingHeaderBytes + slots * kRingSlotBytes long
+   * @param slots The number of slots, a power of two
+   * @param priority The scheduler queue the jobs run on
+   */
+  JobRing(uint8_t *memory, uint32_t slots, priority_t priority, Handler handler, Notify notify);
+
+  /**
+   * Starts draining the jobs submitted since the last call, if not already. Called by the producer once per batch.
+   */
+  void kick();
+
+  /**
+   * Stops claiming jobs. Jobs already running still complete.
+   */
+  void close();
+
+  /**
+   * Blocks until no job runs anymore, after close(). The shared memory may be released then.
+   */
+  void wait();
+
+ private:
+  std::atomic<int32_t> &counter(size_t offset) {
+    return *reinterpret_cast<std::atomic<int32_t> *>(memory_ + offset);
+  }
+
+  std::atomic<int32_t> &state(uint32_t index) {
+    return *reinterpret_cast<std::atomic<int32_t> *>(slot(index) + kRingSlotState);
+  }
+
+  uint8_t *slot(uint32_t index) { return memory_ + kRingHeaderBytes + (index & (slots_ - 1)) * kRingSlotBytes; }
+
+  // Number of submitted jobs not claimed yet
+  uint32_t pending() {
+    return static_cast<uint32_t>(counter(kRingHead).load(std::memory_order_acquire)) -
+           static_cast<uint32_t>(counter(kRingTail).load(std::memory_order_acquire));
+  }
+
+  bool claim(uint32_t &index);
+
+  void drain();
+
+  bool leave();
+
+  uint8_t *memory_;
+  uint32_t slots_;
+  priority_t priority_;
+  Handler handler_;
+  Notify notify_;
+  std::mutex mutex_;
+  std::condition_variable idle_;
+  size_t active_;
+  std::atomic<bool> closed_;
+};
+
+}  // namespace entangled
+
+#endif  // __RING_JOB_RING_H__
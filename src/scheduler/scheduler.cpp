@@ -0,0 +1,262 @@
+/*
+ * Copyright (c) 2020 IOTA Stiftung
+ * https://github.com/iotaledger/entangled-node
+ *
+ * Refer to the LICENSE file for licensing information
+ */
+
+#include <string.h>
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <memory>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "scheduler/scheduler.h"
+
+namespace entangled {
+
+static size_t const kDefaultCapacity = 4096;
+static size_t const kMaxDedicatedPools = 16;
+
+// Applies a placement to the calling thread, best effort: the thread keeps running where it was otherwise
+static void applyPlacement(Placement const &placement) {
+#ifdef __linux__
+  if (!placement.cpus.empty()) {
+    cpu_set_t set;
+
+    CPU_ZERO(&set);
+    for (int cpu : placement.cpus) {
+      CPU_SET(cpu, &set);
+    }
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+  }
+  if (placement.nice != 0) {
+    // Nice levels are per thread on Linux
+    id_t tid = static_cast<id_t>(syscall(SYS_gettid));
+    setpriority(PRIO_PROCESS, tid, getpriority(PRIO_PROCESS, tid) + placement.nice);
+  }
+#else
+  (void)placement;
+#endif
+}
+
+char const *priorityName(priority_t priority) {
+  switch (priority) {
+    case PRIORITY_INTERACTIVE:
+      return "interactive";
+    case PRIORITY_NORMAL:
+      return "normal";
+    case PRIORITY_BULK:
+      return "bulk";
+    default:
+      return "unknown";
+  }
+}
+
+bool priorityFromName(char const *name, priority_t &priority) {
+  for (int i = 0; i < PRIORITY_COUNT; i++) {
+    if (strcmp(name, priorityName(static_cast<priority_t>(i))) == 0) {
+      priority = static_cast<priority_t>(i);
+      return true;
+    }
+  }
+  return false;
+}
+
+char const *placementError(Placement const &placement) {
+  if (placement.nice < -39 || placement.nice > 39) {
+    return "Nice increment out of range";
+  }
+#ifdef __linux__
+  cpu_set_t available;
+
+  CPU_ZERO(&available);
+  sched_getaffinity(0, sizeof(available), &available);
+  for (int cpu : placement.cpus) {
+    if (cpu < 0 || cpu >= CPU_SETSIZE || !CPU_ISSET(cpu, &available)) {
+      return "CPU not available to the process";
+    }
+  }
+#endif
+  return NULL;
+}
+
+Scheduler &Scheduler::instance() {
+  // Never destroyed: workers may still be running a task while the process exits
+  static Scheduler *scheduler = new Scheduler(std::thread::hardware_concurrency(), Placement());
+  return *scheduler;
+}
+
+Scheduler *Scheduler::pool(Placement const &placement) {
+  static std::mutex mutex;
+  static std::map<Placement, Scheduler *> pools;
+
+  if (placement.isDefault()) {
+    return &instance();
+  }
+
+  std::lock_guard<std::mutex> lock(mutex);
+  auto existing = pools.find(placement);
+  if (existing != pools.end()) {
+    return existing->second;
+  }
+  if (pools.size() >= kMaxDedicatedPools) {
+    return NULL;
+  }
+
+  size_t threads = placement.cpus.empty() ? std::thread::hardware_concurrency() : placement.cpus.size();
+  Scheduler *scheduler = new Scheduler(threads, placement);
+  pools[placement] = scheduler;
+  return scheduler;
+}
+
+Scheduler::Scheduler(size_t threads, Placement const &placement) : placement_(placement), running_(0) {
+  for (int i = 0; i < PRIORITY_COUNT; i++) {
+    queued_[i] = 0;
+    capacity_[i] = kDefaultCapacity;
+    admitted_[i] = 0;
+    rejected_[i] = 0;
+  }
+
+  if (threads == 0) {
+    threads = 1;
+  }
+  for (size_t i = 0; i < threads; i++) {
+    workers_.emplace_back([this] { loop(); });
+  }
+}
+
+// Passes claimed by the calling thread and its helpers, outliving the call for helpers starting late
+typedef struct {
+  std::function<bool(size_t)> pass;
+  size_t passes;
+  std::atomic<size_t> next;
+  std::atomic<bool> valid;
+  std::mutex mutex;
+  std::condition_variable cond;
+  size_t done;
+} passes_t;
+
+static void claimPasses(passes_t &passes) {
+  for (size_t pass = passes.next.fetch_add(1); pass < passes.passes; pass = passes.next.fetch_add(1)) {
+    if (!passes.pass(pass)) {
+      passes.valid.store(false, std::memory_order_relaxed);
+    }
+
+    std::lock_guard<std::mutex> lock(passes.mutex);
+    if (++passes.done == passes.passes) {
+      passes.cond.notify_all();
+    }
+  }
+}
+
+bool Scheduler::runPasses(Scheduler *scheduler, size_t passes, std::function<bool(size_t pass)> const &pass,
+                          priority_t priority) {
+  auto shared = std::make_shared<passes_t>();
+
+  shared->pass = pass;
+  shared->passes = passes;
+  shared->next = 0;
+  shared->valid = true;
+  shared->done = 0;
+
+  if (scheduler != NULL) {
+    size_t helpers = std::min(scheduler->threads(), passes) - std::min<size_t>(1, passes);
+    for (size_t i = 0; i < helpers; i++) {
+      scheduler->resubmit(priority, [shared] { claimPasses(*shared); });
+    }
+  }
+  claimPasses(*shared);
+
+  std::unique_lock<std::mutex> lock(shared->mutex);
+  shared->cond.wait(lock, [&shared] { return shared->done == shared->passes; });
+  return shared->valid.load(std::memory_order_relaxed);
+}
+
+bool Scheduler::submit(priority_t priority, Task task) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (queued_[priority] >= capacity_[priority]) {
+      rejected_[priority]++;
+      return false;
+    }
+    queues_[priority].push_back({std::move(task), true});
+    queued_[priority]++;
+    admitted_[priority]++;
+  }
+  cond_.notify_one();
+  return true;
+}
+
+void Scheduler::resubmit(priority_t priority, Task task) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    queues_[priority].push_back({std::move(task), false});
+  }
+  cond_.notify_one();
+}
+
+void Scheduler::setCapacity(priority_t priority, size_t capacity) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  capacity_[priority] = capacity;
+}
+
+scheduler_stats_t Scheduler::stats() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  scheduler_stats_t stats;
+
+  stats.threads = workers_.size();
+  stats.running = running_;
+  for (int i = 0; i < PRIORITY_COUNT; i++) {
+    stats.queued[i] = queued_[i];
+    stats.capacity[i] = capacity_[i];
+    stats.admitted[i] = admitted_[i];
+    stats.rejected[i] = rejected_[i];
+  }
+  return stats;
+}
+
+void Scheduler::loop() {
+  applyPlacement(placement_);
+
+  for (;;) {
+    Task task;
+
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      int priority = PRIORITY_COUNT;
+
+      cond_.wait(lock, [this, &priority] {
+        for (priority = 0; priority < PRIORITY_COUNT; priority++) {
+          if (!queues_[priority].empty()) {
+            return true;
+          }
+        }
+        return false;
+      });
+
+      entry_t &entry = queues_[priority].front();
+      task = std::move(entry.task);
+      if (entry.admitted) {
+        queued_[priority]--;
+      }
+      queues_[priority].pop_front();
+      running_++;
+    }
+
+    task();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    running_--;
+  }
+}
+
+}  // namespace entangled
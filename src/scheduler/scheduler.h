@@ -0,0 +1,162 @@
+/*
+ * Copyright (c) 2020 IOTA Stiftung
+ * https://github.com/iotaledger/entangled-node
+ *
+ * Refer to the LICENSE file for licensing information
+ */
+
+#ifndef __SCHEDULER_SCHEDULER_H__
+#define __SCHEDULER_SCHEDULER_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace entangled {
+
+typedef enum {
+  PRIORITY_INTERACTIVE = 0,
+  PRIORITY_NORMAL,
+  PRIORITY_BULK,
+  PRIORITY_COUNT,
+} priority_t;
+
+/**
+ * Returns the name of a priority, as used by the JS API
+ */
+char const *priorityName(priority_t priority);
+
+/**
+ * Parses a priority name
+ *
+ * @return false if the name is unknown
+ */
+bool priorityFromName(char const *name, priority_t &priority);
+
+/**
+ * Where the threads of a pool run
+ */
+struct Placement {
+  Placement() : nice(0) {}
+
+  bool operator<(Placement const &other) const {
+    return nice != other.nice ? nice < other.nice : cpus < other.cpus;
+  }
+
+  bool isDefault() const { return cpus.empty() && nice == 0; }
+
+  // CPUs the threads are pinned to, sorted, or empty for any
+  std::vector<int> cpus;
+  // Added to the nice level of the process, as with nice -n. Negative values need privileges.
+  int nice;
+};
+
+/**
+ * Checks that a placement can be applied: its CPUs are available to the process and its nice increment is in range.
+ * Pinning and nice levels are only supported on Linux, elsewhere only the number of threads is honoured.
+ *
+ * @return NULL if valid, otherwise the reason it is not
+ */
+char const *placementError(Placement const &placement);
+
+typedef struct {
+  size_t threads;
+  size_t running;
+  size_t queued[PRIORITY_COUNT];
+  size_t capacity[PRIORITY_COUNT];
+  uint64_t admitted[PRIORITY_COUNT];
+  uint64_t rejected[PRIORITY_COUNT];
+} scheduler_stats_t;
+
+/**
+ * Process-wide pool of native threads shared by every binding. Tasks are taken from strict priority queues, so an
+ * interactive task always runs before queued normal or bulk work. Long computations are expected to split
+ * themselves into short tasks, resubmitting a continuation each time, so that they do not hold a thread while more
+ * urgent work is waiting.
+ */
+class Scheduler {
+ public:
+  typedef std::function<void()> Task;
+
+  /**
+   * Returns the pool, starting its threads on first use. It lives until the process exits.
+   */
+  static Scheduler &instance();
+
+  /**
+   * Returns the pool of a placement: the default one for the default placement, otherwise a dedicated pool with one
+   * thread per CPU of the set, or per core if the set is empty, started on first use and living until the process
+   * exits
+   *
+   * @return NULL if the maximum number of dedicated pools is reached
+   */
+  static Scheduler *pool(Placement const &placement);
+
+  /**
+   * Runs passes of a computation on the calling thread, helped by the threads of a pool. Each pass is run once, by
+   * whichever thread claims it first. Helpers are queued as continuations of the calling job, and those starting
+   * once every pass was claimed return without calling pass, so that it may use buffers released on return.
+   *
+   * @param scheduler The pool helping, or NULL to run every pass on the calling thread
+   * @param passes The number of passes
+   * @param pass Runs a pass given its index, returning false if it failed
+   * @param priority The priority of the helping tasks
+   *
+   * @return false if a pass failed, once every pass is done
+   */
+  static bool runPasses(Scheduler *scheduler, size_t passes, std::function<bool(size_t pass)> const &pass,
+                        priority_t priority);
+
+  /**
+   * Admits a new job. It is rejected when the queue of its priority already holds capacity admitted tasks.
+   *
+   * @return false if the job was rejected
+   */
+  bool submit(priority_t priority, Task task);
+
+  /**
+   * Queues the continuation of an already admitted job, bypassing admission control
+   */
+  void resubmit(priority_t priority, Task task);
+
+  /**
+   * Sets the maximum number of admitted tasks waiting in a queue
+   */
+  void setCapacity(priority_t priority, size_t capacity);
+
+  size_t threads() const { return workers_.size(); }
+
+  scheduler_stats_t stats();
+
+ private:
+  typedef struct {
+    Task task;
+    bool admitted;
+  } entry_t;
+
+  Scheduler(size_t threads, Placement const &placement);
+
+  void loop();
+
+  Placement placement_;
+
+  std::mutex mutex_;
+  std::condition_variable cond_;
+  std::deque<entry_t> queues_[PRIORITY_COUNT];
+  size_t queued_[PRIORITY_COUNT];
+  size_t capacity_[PRIORITY_COUNT];
+  uint64_t admitted_[PRIORITY_COUNT];
+  uint64_t rejected_[PRIORITY_COUNT];
+  size_t running_;
+  std::vector<std::thread> workers_;
+};
+
+}  // namespace entangled
+
+#endif  // __SCHEDULER_SCHEDULER_H__
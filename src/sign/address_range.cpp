@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) 2020 IOTA Stiftung
+ * https://github.com/iotaledger/entangled-node
+ *
+ * Refer to the LICENSE file for licensing information
+ */
+
+#include <algorithm>
+#include <functional>
+
+#include "sign/address_range.h"
+#include "sign/iss.h"
+
+namespace entangled {
+
+// Addresses generated per pass, a few milliseconds of work each
+static size_t const kPassAddresses = 8;
+
+// Runs a pass per kPassAddresses addresses, given their first index and count
+static bool runInPasses(size_t count, std::function<bool(size_t, size_t)> const &pass, Scheduler *scheduler,
+                        priority_t priority) {
+  return Scheduler::runPasses(
+      scheduler, (count + kPassAddresses - 1) / kPassAddresses,
+      [=](size_t index) {
+        size_t first = index * kPassAddresses;
+        return pass(first, std::min(kPassAddresses, count - first));
+      },
+      priority);
+}
+
+bool addressRange(trit_t const *seed, uint64_t start, size_t count, size_t security, trit_t *addresses,
+                  Scheduler *scheduler, priority_t priority) {
+  if (security < 1 || security > kIssMaxSecurity) {
+    return false;
+  }
+
+  return runInPasses(
+      count,
+      [=](size_t first, size_t length) {
+        return issAddressRangeTrits(seed, start + first, length, security, addresses + first * kHashTrits);
+      },
+      scheduler, priority);
+}
+
+bool addressBatch(char *seeds, uint64_t const *indexes, uint8_t const *securities, size_t count, char *addresses,
+                  Scheduler *scheduler, priority_t priority) {
+  return runInPasses(
+      count,
+      [=](size_t first, size_t length) {
+        trit_t seedTrits[kPassAddresses * kHashTrits];
+        trit_t addressTrits[kPassAddresses * kHashTrits];
+        char *trytes = seeds + first * kSeedTrytes;
+        bool valid = true;
+
+        // The trytes of a seed are scrubbed as soon as read, its trits once its subseed is derived
+        for (size_t i = 0; i < length; i++) {
+          valid = trytesToTrits(trytes + i * kSeedTrytes, kSeedTrytes, seedTrits + i * kHashTrits) && valid;
+          issScrub(trytes + i * kSeedTrytes, kSeedTrytes);
+        }
+        valid = valid && issAddressBatchTrits(seedTrits, indexes + first, securities + first, length, addressTrits);
+        issScrub(seedTrits, sizeof(seedTrits));
+        if (valid) {
+          tritsToTrytes(addressTrits, length * kHashTrytes, addresses + first * kHashTrytes);
+        }
+        return valid;
+      },
+      scheduler, priority);
+}
+
+}  // namespace entangled
@@ -0,0 +1,55 @@
+/*
+ * Copyright (c) 2020 IOTA Stiftung
+ * https://github.com/iotaledger/entangled-node
+ *
+ * Refer to the LICENSE file for licensing information
+ */
+
+#ifndef __SIGN_ADDRESS_RANGE_H__
+#define __SIGN_ADDRESS_RANGE_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "pow/trinary.h"
+#include "scheduler/scheduler.h"
+
+namespace entangled {
+
+/**
+ * Generates the addresses of consecutive seed indexes, in passes of a few addresses spread over the threads of a
+ * pool, the calling thread taking part. Key material is scrubbed before returning.
+ *
+ * @param seed The 243 trit seed
+ * @param start The first key index
+ * @param count The number of addresses
+ * @param security The security level
+ * @param addresses The output addresses, count * 243 trits long
+ * @param scheduler The pool helping, or NULL to generate them on the calling thread only
+ * @param priority The scheduler priority of the helping tasks
+ *
+ * @return false if the security level is not 1 to 3
+ */
+bool addressRange(trit_t const *seed, uint64_t start, size_t count, size_t security, trit_t *addresses,
+                  Scheduler *scheduler, priority_t priority);
+
+/**
+ * Generates the addresses of independent (seed, index, security) tuples, in passes spread over the threads of a
+ * pool as addressRange() does. The trytes of every seed are scrubbed once read, whether valid or not.
+ *
+ * @param seeds The seeds, count * 81 trytes long, scrubbed
+ * @param indexes The key indexes
+ * @param securities The security levels
+ * @param count The number of addresses
+ * @param addresses The output addresses, count * 81 trytes long
+ * @param scheduler The pool helping, or NULL to generate them on the calling thread only
+ * @param priority The scheduler priority of the helping tasks
+ *
+ * @return false if a seed holds a character other than a tryte or a security level is not 1 to 3
+ */
+bool addressBatch(char *seeds, uint64_t const *indexes, uint8_t const *securities, size_t count, char *addresses,
+                  Scheduler *scheduler, priority_t priority);
+
+}  // namespace entangled
+
+#endif  // __SIGN_ADDRESS_RANGE_H__
@@ -0,0 +1,280 @@
+/*
+ * Copyright (c) 2020 IOTA Stiftung
+ * https://github.com/iotaledger/entangled-node
+ *
+ * Refer to the LICENSE file for licensing information
+ */
+
+#include <string.h>
+#include <algorithm>
+#include <vector>
+
+#include "sign/iss.h"
+#include "sign/kerl.h"
+
+namespace entangled {
+
+// Times a chunk of the key is hashed into its digest, and the largest normalized tryte value
+static uint8_t const kDigestRounds = 26;
+static int const kMaxTryteValue = 13;
+
+// Addresses whose keys are hashed together, enough to keep 8 Kerl lanes busy at security 1
+static size_t const kRangeGroup = 8;
+
+void issScrub(void *buffer, size_t size) {
+  volatile uint8_t *bytes = static_cast<volatile uint8_t *>(buffer);
+
+  for (size_t i = 0; i < size; i++) {
+    bytes[i] = 0;
+  }
+}
+
+void issAddIndex(trit_t const *seed, uint64_t index, trit_t *trits) {
+  trit_t increment[kHashTrits] = {0};
+  int carry = 0;
+
+  // The index is at most 3^41, so that it fits the seed
+  longToTrits(static_cast<int64_t>(index), increment, 41);
+  for (size_t i = 0; i < kHashTrits; i++) {
+    int sum = seed[i] + increment[i] + carry;
+    carry = sum > 1 ? 1 : sum < -1 ? -1 : 0;
+    trits[i] = static_cast<trit_t>(sum - 3 * carry);
+  }
+}
+
+void issIncrement(trit_t *trits) {
+  for (size_t i = 0; i < kHashTrits; i++) {
+    if (trits[i] < 1) {
+      trits[i]++;
+      return;
+    }
+    trits[i] = -1;
+  }
+}
+
+// Hashes a seed plus an index into its subseed
+static void hashSubseed(trit_t const *indexed, trit_t *subseed) {
+  Kerl kerl;
+
+  kerl.absorb(indexed, kHashTrits);
+  kerl.squeeze(subseed, kHashTrits);
+}
+
+void issSubseed(trit_t const *seed, uint64_t index, trit_t *subseed) {
+  issAddIndex(seed, index, subseed);
+  hashSubseed(subseed, subseed);
+}
+
+void issKey(trit_t const *subseed, size_t security, trit_t *key) {
+  Kerl kerl;
+
+  kerl.absorb(subseed, kHashTrits);
+  kerl.squeeze(key, security * kIssFragmentTrits);
+}
+
+// Hashes the fragments of a key whose chunks were hashed 26 times into its digests
+static void fragmentDigests(trit_t const *chunks, size_t security, trit_t *digests) {
+  Kerl kerl;
+
+  for (size_t fragment = 0; fragment < security; fragment++) {
+    kerl.reset();
+    kerl.absorb(chunks + fragment * kIssFragmentTrits, kIssFragmentTrits);
+    kerl.squeeze(digests + fragment * kHashTrits, kHashTrits);
+  }
+}
+
+void issDigests(trit_t const *key, size_t security, trit_t *digests) {
+  std::vector<trit_t> chunks(key, key + security * kIssFragmentTrits);
+
+  // Every chunk of every fragment is independent, and hashed across the lanes of the multi-buffer Keccak
+  kerlChunks(chunks.data(), security * kIssFragmentChunks, kDigestRounds);
+  fragmentDigests(chunks.data(), security, digests);
+  issScrub(chunks.data(), chunks.size());
+}
+
+void issAddress(trit_t const *digests, size_t security, trit_t *address) {
+  Kerl kerl;
+
+  kerl.absorb(digests, security * kHashTrits);
+  kerl.squeeze(address, kHashTrits);
+}
+
+void issNormalize(trit_t const *bundle, int8_t *normalized) {
+  for (size_t i = 0; i < kHashTrytes; i += kIssFragmentChunks) {
+    int sum = 0;
+
+    for (size_t j = i; j < i + kIssFragmentChunks; j++) {
+      normalized[j] = static_cast<int8_t>(bundle[3 * j] + 3 * bundle[3 * j + 1] + 9 * bundle[3 * j + 2]);
+      sum += normalized[j];
+    }
+
+    // Moves the first values that can move towards a sum of 0, one step at a time
+    for (; sum > 0; sum--) {
+      for (size_t j = i; j < i + kIssFragmentChunks; j++) {
+        if (normalized[j] > -kMaxTryteValue) {
+          normalized[j]--;
+          break;
+        }
+      }
+    }
+    for (; sum < 0; sum++) {
+      for (size_t j = i; j < i + kIssFragmentChunks; j++) {
+        if (normalized[j] < kMaxTryteValue) {
+          normalized[j]++;
+          break;
+        }
+      }
+    }
+  }
+}
+
+void issSignature(trit_t *key, size_t security, int8_t const *normalized) {
+  uint8_t rounds[kIssMaxSecurity * kIssFragmentChunks];
+
+  for (size_t i = 0; i < security * kIssFragmentChunks; i++) {
+    rounds[i] = static_cast<uint8_t>(kMaxTryteValue - normalized[i]);
+  }
+  kerlChunks(key, security * kIssFragmentChunks, rounds);
+}
+
+bool issAddressTrits(trit_t const *seed, uint64_t index, size_t security, trit_t *address) {
+  trit_t subseed[kHashTrits];
+  trit_t digests[kIssMaxSecurity * kHashTrits];
+
+  if (security < 1 || security > kIssMaxSecurity) {
+    return false;
+  }
+
+  std::vector<trit_t> key(security * kIssFragmentTrits);
+  issSubseed(seed, index, subseed);
+  issKey(subseed, security, key.data());
+  issDigests(key.data(), security, digests);
+  issAddress(digests, security, address);
+
+  issScrub(subseed, sizeof(subseed));
+  issScrub(key.data(), key.size());
+  return true;
+}
+
+// Generates the addresses of up to kRangeGroup subseeds, their keys being hashed together across the Kerl lanes
+static void groupAddresses(trit_t const *subseeds, uint8_t const *securities, size_t count, trit_t *keys,
+                           trit_t *addresses) {
+  trit_t digests[kIssMaxSecurity * kHashTrits];
+  size_t chunks = 0;
+
+  for (size_t i = 0; i < count; i++) {
+    issKey(subseeds + i * kHashTrits, securities[i], keys + chunks * kHashTrits);
+    chunks += securities[i] * kIssFragmentChunks;
+  }
+  kerlChunks(keys, chunks, kDigestRounds);
+  for (size_t i = 0, offset = 0; i < count; offset += securities[i] * kIssFragmentTrits, i++) {
+    fragmentDigests(keys + offset, securities[i], digests);
+    issAddress(digests, securities[i], addresses + i * kHashTrits);
+  }
+}
+
+bool issAddressRangeTrits(trit_t const *seed, uint64_t start, size_t count, size_t security, trit_t *addresses) {
+  trit_t indexed[kHashTrits];
+  trit_t subseeds[kRangeGroup * kHashTrits];
+  uint8_t securities[kRangeGroup];
+
+  if (security < 1 || security > kIssMaxSecurity) {
+    return false;
+  }
+
+  std::vector<trit_t> keys(kRangeGroup * security * kIssFragmentTrits);
+  memset(securities, static_cast<int>(security), sizeof(securities));
+  issAddIndex(seed, start, indexed);
+  for (size_t first = 0; first < count; first += kRangeGroup) {
+    size_t group = std::min(kRangeGroup, count - first);
+
+    for (size_t i = 0; i < group; i++) {
+      hashSubseed(indexed, subseeds + i * kHashTrits);
+      issIncrement(indexed);
+    }
+    groupAddresses(subseeds, securities, group, keys.data(), addresses + first * kHashTrits);
+  }
+
+  issScrub(indexed, sizeof(indexed));
+  issScrub(subseeds, sizeof(subseeds));
+  issScrub(keys.data(), keys.size());
+  return true;
+}
+
+bool issAddressBatchTrits(trit_t *seeds, uint64_t const *indexes, uint8_t const *securities, size_t count,
+                          trit_t *addresses) {
+  trit_t subseeds[kRangeGroup * kHashTrits];
+
+  for (size_t i = 0; i < count; i++) {
+    if (securities[i] < 1 || securities[i] > kIssMaxSecurity) {
+      return false;
+    }
+  }
+
+  std::vector<trit_t> keys(kRangeGroup * kIssMaxSecurity * kIssFragmentTrits);
+  for (size_t first = 0; first < count; first += kRangeGroup) {
+    size_t group = std::min(kRangeGroup, count - first);
+
+    for (size_t i = first; i < first + group; i++) {
+      issSubseed(seeds + i * kHashTrits, indexes[i], subseeds + (i - first) * kHashTrits);
+      issScrub(seeds + i * kHashTrits, kHashTrits);
+    }
+    groupAddresses(subseeds, securities + first, group, keys.data(), addresses + first * kHashTrits);
+  }
+
+  issScrub(subseeds, sizeof(subseeds));
+  issScrub(keys.data(), keys.size());
+  return true;
+}
+
+bool issSeedTrits(char const *seed, size_t length, trit_t *trits) {
+  memset(trits, 0, kHashTrits * sizeof(trit_t));
+  return length <= kSeedTrytes && trytesToTrits(seed, length, trits);
+}
+
+bool issAddressTrytes(char const *seed, size_t length, uint64_t index, size_t security, char *address) {
+  trit_t seedTrits[kHashTrits];
+  trit_t addressTrits[kHashTrits];
+  bool valid = issSeedTrits(seed, length, seedTrits) && issAddressTrits(seedTrits, index, security, addressTrits);
+
+  issScrub(seedTrits, sizeof(seedTrits));
+  if (valid) {
+    tritsToTrytes(addressTrits, kHashTrytes, address);
+  }
+  return valid;
+}
+
+bool issSignatureTrits(trit_t const *seed, uint64_t index, size_t security, trit_t const *bundle, trit_t *signature) {
+  trit_t subseed[kHashTrits];
+  int8_t normalized[kHashTrytes];
+
+  if (security < 1 || security > kIssMaxSecurity) {
+    return false;
+  }
+
+  issSubseed(seed, index, subseed);
+  issKey(subseed, security, signature);
+  issScrub(subseed, sizeof(subseed));
+  issNormalize(bundle, normalized);
+  issSignature(signature, security, normalized);
+  return true;
+}
+
+bool issSignatureTrytes(char const *seed, size_t length, uint64_t index, size_t security, char const *bundle,
+                        char *signature) {
+  trit_t seedTrits[kHashTrits];
+  trit_t bundleTrits[kHashTrits];
+  bool valid = issSeedTrits(seed, length, seedTrits) && trytesToTrits(bundle, kHashTrytes, bundleTrits) &&
+               security >= 1 && security <= kIssMaxSecurity;
+
+  if (valid) {
+    std::vector<trit_t> signatureTrits(security * kIssFragmentTrits);
+    issSignatureTrits(seedTrits, index, security, bundleTrits, signatureTrits.data());
+    tritsToTrytes(signatureTrits.data(), signatureTrits.size() / 3, signature);
+    issScrub(signatureTrits.data(), signatureTrits.size());
+  }
+  issScrub(seedTrits, sizeof(seedTrits));
+  return valid;
+}
+
+}  // namespace entangled
@@ -0,0 +1,192 @@
+/*
+ * Copyright (c) 2020 IOTA Stiftung
+ * https://github.com/iotaledger/entangled-node
+ *
+ * Refer to the LICENSE file for licensing information
+ */
+
+#ifndef __SIGN_ISS_H__
+#define __SIGN_ISS_H__
+
+#include <stdint.h>
+
+#include "pow/trinary.h"
+
+namespace entangled {
+
+// Chunks of a key fragment, each hashed up to 26 times into a signature or digest, and its length in trits
+static size_t const kIssFragmentChunks = 27;
+static size_t const kIssFragmentTrits = kIssFragmentChunks * kHashTrits;
+static size_t const kIssMaxSecurity = 3;
+static size_t const kSeedTrytes = 81;
+
+/**
+ * Adds an index to a seed, as 243 trit balanced ternary integers, the last carry being dropped
+ *
+ * @param seed The 243 trit seed
+ * @param index The key index
+ * @param trits The output 243 trits
+ */
+void issAddIndex(trit_t const *seed, uint64_t index, trit_t *trits);
+
+/**
+ * Adds 1 to a 243 trit balanced ternary integer in place, the last carry being dropped
+ *
+ * @param trits The 243 trits
+ */
+void issIncrement(trit_t *trits);
+
+/**
+ * Derives the subseed of an index: the seed plus the index, hashed
+ *
+ * @param seed The 243 trit seed
+ * @param index The key index
+ * @param subseed The output 243 trit subseed
+ */
+void issSubseed(trit_t const *seed, uint64_t index, trit_t *subseed);
+
+/**
+ * Squeezes the private key of a subseed
+ *
+ * @param subseed The 243 trit subseed
+ * @param security The security level, 1 to 3
+ * @param key The output key, security * kIssFragmentTrits long
+ */
+void issKey(trit_t const *subseed, size_t security, trit_t *key);
+
+/**
+ * Hashes each chunk of a key 26 times, then each fragment into its digest
+ *
+ * @param key The key, security * kIssFragmentTrits long, left untouched
+ * @param security The security level, 1 to 3
+ * @param digests The output digests, security * 243 trits long
+ */
+void issDigests(trit_t const *key, size_t security, trit_t *digests);
+
+/**
+ * Hashes digests into an address
+ *
+ * @param digests The digests, security * 243 trits long
+ * @param security The security level, 1 to 3
+ * @param address The output 243 trit address
+ */
+void issAddress(trit_t const *digests, size_t security, trit_t *address);
+
+/**
+ * Normalizes a bundle hash, so that the tryte values of each third sum up to 0
+ *
+ * @param bundle The 243 trit bundle hash
+ * @param normalized The output 81 tryte values, from -13 to 13
+ */
+void issNormalize(trit_t const *bundle, int8_t *normalized);
+
+/**
+ * Signs a normalized bundle hash, hashing chunk i of the key 13 - normalized[i] times in place
+ *
+ * @param key The key, security * kIssFragmentTrits long, replaced by the signature
+ * @param security The security level, 1 to 3
+ * @param normalized The 81 normalized tryte values of the bundle hash
+ */
+void issSignature(trit_t *key, size_t security, int8_t const *normalized);
+
+/**
+ * Generates the address of a seed index. Key material is scrubbed before returning.
+ *
+ * @param seed The 243 trit seed
+ * @param index The key index
+ * @param security The security level
+ * @param address The output 243 trit address
+ *
+ * @return false if the security level is not 1 to 3
+ */
+bool issAddressTrits(trit_t const *seed, uint64_t index, size_t security, trit_t *address);
+
+/**
+ * Generates the addresses of consecutive seed indexes. Subseeds are derived by incrementing the seed plus the first
+ * index, and the keys of several addresses are hashed together across the lanes of the multi-buffer Kerl. Key
+ * material is scrubbed before returning.
+ *
+ * @param seed The 243 trit seed
+ * @param start The first key index
+ * @param count The number of addresses
+ * @param security The security level
+ * @param addresses The output addresses, count * 243 trits long
+ *
+ * @return false if the security level is not 1 to 3
+ */
+bool issAddressRangeTrits(trit_t const *seed, uint64_t start, size_t count, size_t security, trit_t *addresses);
+
+/**
+ * Generates the addresses of independent seed indexes, the keys of several of them being hashed together across the
+ * lanes of the multi-buffer Kerl. Every seed is scrubbed once its subseed is derived, key material before returning.
+ *
+ * @param seeds The 243 trit seeds, count * 243 trits long, scrubbed
+ * @param indexes The key indexes
+ * @param securities The security levels
+ * @param count The number of addresses
+ * @param addresses The output addresses, count * 243 trits long
+ *
+ * @return false if a security level is not 1 to 3, in which case nothing is generated nor scrubbed
+ */
+bool issAddressBatchTrits(trit_t *seeds, uint64_t const *indexes, uint8_t const *securities, size_t count,
+                          trit_t *addresses);
+
+/**
+ * Zeroes a buffer in a way the compiler cannot drop, to scrub key material
+ *
+ * @param buffer The buffer
+ * @param size The number of bytes
+ */
+void issScrub(void *buffer, size_t size);
+
+/**
+ * Reads a seed in trytes
+ *
+ * @param seed The seed, up to 81 trytes, padded with 9s
+ * @param length The number of seed trytes
+ * @param trits The output 243 trit seed
+ *
+ * @return false if the seed is too long or holds a character other than a tryte
+ */
+bool issSeedTrits(char const *seed, size_t length, trit_t *trits);
+
+/**
+ * Generates the address of a seed index in trytes, see issAddressTrits()
+ *
+ * @param seed The seed, up to 81 trytes, padded with 9s
+ * @param length The number of seed trytes
+ * @param address The output 81 trytes
+ *
+ * @return false if the seed or security level is invalid
+ */
+bool issAddressTrytes(char const *seed, size_t length, uint64_t index, size_t security, char *address);
+
+/**
+ * Generates the signature of a bundle hash with a seed index. Key material is scrubbed before returning.
+ *
+ * @param seed The 243 trit seed
+ * @param index The key index
+ * @param security The security level
+ * @param bundle The 243 trit bundle hash
+ * @param signature The output signature, security * kIssFragmentTrits long
+ *
+ * @return false if the security level is not 1 to 3
+ */
+bool issSignatureTrits(trit_t const *seed, uint64_t index, size_t security, trit_t const *bundle, trit_t *signature);
+
+/**
+ * Generates the signature of a bundle hash with a seed index in trytes, see issSignatureTrits()
+ *
+ * @param seed The seed, up to 81 trytes, padded with 9s
+ * @param length The number of seed trytes
+ * @param bundle The 81 tryte bundle hash
+ * @param signature The output signature, security * kIssFragmentTrits / 3 trytes long
+ *
+ * @return false if the seed, bundle hash or security level is invalid
+ */
+bool issSignatureTrytes(char const *seed, size_t length, uint64_t index, size_t security, char const *bundle,
+                        char *signature);
+
+}  // namespace entangled
+
+#endif  // __SIGN_ISS_H__
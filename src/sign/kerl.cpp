@@ -0,0 +1,277 @@
+/*
+ * Copyright (c) 2020 IOTA Stiftung
+ * https://github.com/iotaledger/entangled-node
+ *
+ * Refer to the LICENSE file for licensing information
+ */
+
+#include <string.h>
+#include <algorithm>
+#include <vector>
+
+#include "pow/cpu.h"
+#include "sign/kerl_kernel.h"
+
+namespace entangled {
+
+static size_t const kKerlLimbs = kKerlBytes / 8;
+static size_t const kKerlTrits = kHashTrits - 1;
+
+// 64 bit limbs of (3^242 - 1) / 2, the offset between balanced and unsigned 242 trit integers, of its opposite modulo
+// 2^384 and of 3^242, least significant limb first
+static uint64_t const kHalf3[kKerlLimbs] = {0x9f007669a5ce8964ULL, 0x3ade00d91484504fULL, 0x50979d570c24486eULL,
+                                           0x48bbae3679a4c702ULL, 0xaa06a805a9f6808bULL, 0x5e69ebefa87fabdfULL};
+static uint64_t const kNegHalf3[kKerlLimbs] = {0x60ff89965a31769cULL, 0xc521ff26eb7bafb0ULL, 0xaf6862a8f3dbb791ULL,
+                                              0xb74451c9865b38fdULL, 0x55f957fa56097f74ULL, 0xa196141057805420ULL};
+static uint64_t const kPow3[kKerlLimbs] = {0x3e00ecd34b9d12c9ULL, 0x75bc01b22908a09fULL, 0xa12f3aae184890dcULL,
+                                          0x91775c6cf3498e04ULL, 0x540d500b53ed0116ULL, 0xbcd3d7df50ff57bfULL};
+
+// Trits multiplied in at once, 3^40 being below 2^64, and trits divided out at once, 3^20 being below 2^32
+static size_t const kMulTrits = 40;
+static size_t const kDivTrits = 20;
+static uint64_t const kDivisor = 3486784401ULL;
+
+// Powers of 3 up to 3^40
+static uint64_t const *pow3() {
+  static struct Table {
+    Table() {
+      values[0] = 1;
+      for (size_t i = 1; i <= kMulTrits; i++) {
+        values[i] = values[i - 1] * 3;
+      }
+    }
+    uint64_t values[kMulTrits + 1];
+  } const table;
+
+  return table.values;
+}
+
+// Unsigned trits of every value below 3^5, least significant first
+static uint8_t const (*tritGroups())[5] {
+  static struct Table {
+    Table() {
+      for (size_t value = 0; value < 243; value++) {
+        for (size_t i = 0, rest = value; i < 5; i++, rest /= 3) {
+          values[value][i] = static_cast<uint8_t>(rest % 3);
+        }
+      }
+    }
+    uint8_t values[243][5];
+  } const table;
+
+  return table.values;
+}
+
+// a = a * m + c modulo 2^384
+static void mulAdd(uint64_t *a, uint64_t m, uint64_t c) {
+  for (size_t i = 0; i < kKerlLimbs; i++) {
+#if defined(__SIZEOF_INT128__)
+    unsigned __int128 product = static_cast<unsigned __int128>(a[i]) * m + c;
+    a[i] = static_cast<uint64_t>(product);
+    c = static_cast<uint64_t>(product >> 64);
+#else
+    uint64_t aLow = a[i] & 0xffffffff, aHigh = a[i] >> 32, mLow = m & 0xffffffff, mHigh = m >> 32;
+    uint64_t low = aLow * mLow, mid1 = aHigh * mLow, mid2 = aLow * mHigh, high = aHigh * mHigh;
+    uint64_t mid = (low >> 32) + (mid1 & 0xffffffff) + (mid2 & 0xffffffff);
+    uint64_t result = (mid << 32) | (low & 0xffffffff);
+    high += (mid >> 32) + (mid1 >> 32) + (mid2 >> 32);
+    a[i] = result + c;
+    c = high + (a[i] < result);
+#endif
+  }
+}
+
+// a += b modulo 2^384, returning the carry out
+static bool addLimbs(uint64_t *a, uint64_t const *b) {
+  uint64_t carry = 0;
+
+  for (size_t i = 0; i < kKerlLimbs; i++) {
+    uint64_t sum = a[i] + carry;
+    carry = sum < carry;
+    a[i] = sum + b[i];
+    carry += a[i] < sum;
+  }
+  return carry != 0;
+}
+
+// a /= 3^20, a being limbs long, returning the remainder. Dividing 32 bits at a time by a constant below 2^32 compiles
+// to multiplications.
+static uint64_t divide(uint64_t *a, size_t limbs) {
+  uint64_t rem = 0;
+
+  for (size_t i = limbs; i-- > 0;) {
+    uint64_t high = rem << 32 | a[i] >> 32;
+    uint64_t low = (high % kDivisor) << 32 | (a[i] & 0xffffffff);
+    a[i] = (high / kDivisor) << 32 | low / kDivisor;
+    rem = low % kDivisor;
+  }
+  return rem;
+}
+
+void kerlTritsToBytes(trit_t const *trits, uint8_t *bytes) {
+  uint64_t const *powers = pow3();
+  uint64_t limbs[kKerlLimbs] = {0};
+
+  // Unsigned digits, 40 at a time from the most significant ones
+  for (size_t end = kKerlTrits; end > 0;) {
+    size_t start = end > kMulTrits ? end - kMulTrits : 0;
+    uint64_t value = 0;
+    for (size_t i = end; i-- > start;) {
+      value = value * 3 + static_cast<uint64_t>(trits[i] + 1);
+    }
+    mulAdd(limbs, powers[end - start], value);
+    end = start;
+  }
+
+  // Then minus (3^242 - 1) / 2, in two's complement
+  addLimbs(limbs, kNegHalf3);
+
+  for (size_t j = 0; j < kKerlLimbs; j++) {
+    uint64_t limb = limbs[kKerlLimbs - 1 - j];
+    for (size_t k = 0; k < 8; k++) {
+      bytes[8 * j + k] = static_cast<uint8_t>(limb >> (56 - 8 * k));
+    }
+  }
+}
+
+void kerlBytesToTrits(uint8_t const *bytes, trit_t *trits) {
+  uint8_t const(*groups)[5] = tritGroups();
+  uint64_t limbs[kKerlLimbs];
+
+  for (size_t j = 0; j < kKerlLimbs; j++) {
+    uint64_t limb = 0;
+    for (size_t k = 0; k < 8; k++) {
+      limb = limb << 8 | bytes[8 * j + k];
+    }
+    limbs[kKerlLimbs - 1 - j] = limb;
+  }
+
+  // Unsigned digits of the value plus (3^242 - 1) / 2, itself plus 3^242 when below -(3^242 - 1) / 2
+  bool negative = limbs[kKerlLimbs - 1] >> 63 != 0;
+  if (!addLimbs(limbs, kHalf3) && negative) {
+    addLimbs(limbs, kPow3);
+  }
+
+  // 20 digits at a time, split into groups of 5 through a table, over the limbs left non-zero
+  size_t size = kKerlLimbs;
+  for (size_t start = 0; start < kKerlTrits; start += kDivTrits) {
+    uint64_t rem = divide(limbs, size);
+    while (size > 0 && limbs[size - 1] == 0) {
+      size--;
+    }
+    for (size_t i = start; i < start + kDivTrits && i < kKerlTrits; i += 5, rem /= 243) {
+      uint8_t const *group = groups[rem % 243];
+      for (size_t k = 0; k < 5 && i + k < kKerlTrits; k++) {
+        trits[i + k] = static_cast<trit_t>(group[k]) - 1;
+      }
+    }
+  }
+  trits[kKerlTrits] = 0;
+}
+
+void Kerl::reset() {
+  KeccakP1600_Initialize(state_);
+  offset_ = 0;
+}
+
+void Kerl::absorb(trit_t const *trits, size_t length) {
+  uint8_t bytes[kKerlBytes];
+
+  for (size_t i = 0; i < length; i += kHashTrits) {
+    kerlTritsToBytes(trits + i, bytes);
+
+    // A block may straddle two rates
+    size_t first = std::min(kKerlBytes, kKerlRate - offset_);
+    KeccakP1600_AddBytes(state_, bytes, offset_, first);
+    offset_ += first;
+    if (offset_ == kKerlRate) {
+      KeccakP1600_Permute_24rounds(state_);
+      KeccakP1600_AddBytes(state_, bytes + first, 0, kKerlBytes - first);
+      offset_ = kKerlBytes - first;
+    }
+  }
+}
+
+// Pads the bytes absorbed with Kerl's suffix and permutes
+static void pad(uint64_t *state, size_t offset) {
+  KeccakP1600_AddByte(state, 0x01, offset);
+  KeccakP1600_AddByte(state, 0x80, kKerlRate - 1);
+  KeccakP1600_Permute_24rounds(state);
+}
+
+void Kerl::squeeze(trit_t *trits, size_t length) {
+  uint8_t bytes[kKerlBytes];
+
+  // Every block is the hash of the complement of the previous one
+  for (size_t i = 0; i < length; i += kHashTrits) {
+    pad(state_, offset_);
+    KeccakP1600_ExtractBytes(state_, bytes, 0, kKerlBytes);
+    kerlBytesToTrits(bytes, trits + i);
+    for (size_t j = 0; j < kKerlBytes; j++) {
+      bytes[j] = ~bytes[j];
+    }
+    KeccakP1600_Initialize(state_);
+    KeccakP1600_AddBytes(state_, bytes, 0, kKerlBytes);
+    offset_ = kKerlBytes;
+  }
+}
+
+// Hashes chunks one at a time, each as a single block
+static void kerlChunksScalar(trit_t *chunks, size_t count, uint8_t const *rounds) {
+  uint64_t state[KeccakP1600_stateSizeInBytes / 8];
+  uint8_t bytes[kKerlBytes];
+
+  for (size_t i = 0; i < count; i++) {
+    trit_t *chunk = chunks + i * kHashTrits;
+    for (size_t round = 0; round < rounds[i]; round++) {
+      kerlTritsToBytes(chunk, bytes);
+      KeccakP1600_Initialize(state);
+      KeccakP1600_AddBytes(state, bytes, 0, kKerlBytes);
+      pad(state, kKerlBytes);
+      KeccakP1600_ExtractBytes(state, bytes, 0, kKerlBytes);
+      kerlBytesToTrits(bytes, chunk);
+    }
+  }
+}
+
+size_t kerlLanes() {
+  cpu_features_t const &cpu = cpuFeatures();
+
+#if defined(ENTANGLED_POW_AVX512)
+  if (cpu.avx512f) {
+    return 8;
+  }
+#endif
+#if defined(ENTANGLED_POW_AVX2)
+  if (cpu.avx2) {
+    return 4;
+  }
+#endif
+  (void)cpu;
+  return 1;
+}
+
+void kerlChunks(trit_t *chunks, size_t count, uint8_t const *rounds) {
+  switch (kerlLanes()) {
+#if defined(ENTANGLED_POW_AVX512)
+    case 8:
+      kerlChunkLanesAvx512(chunks, count, rounds);
+      return;
+#endif
+#if defined(ENTANGLED_POW_AVX2)
+    case 4:
+      kerlChunkLanesAvx2(chunks, count, rounds);
+      return;
+#endif
+    default:
+      kerlChunksScalar(chunks, count, rounds);
+  }
+}
+
+void kerlChunks(trit_t *chunks, size_t count, uint8_t rounds) {
+  std::vector<uint8_t> counts(count, rounds);
+
+  kerlChunks(chunks, count, counts.data());
+}
+
+}  // namespace entangled
@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2020 IOTA Stiftung
+ * https://github.com/iotaledger/entangled-node
+ *
+ * Refer to the LICENSE file for licensing information
+ */
+
+#ifndef __SIGN_KERL_H__
+#define __SIGN_KERL_H__
+
+#include <stdint.h>
+
+extern "C" {
+#include "keccak/KeccakP-1600-SnP.h"
+}
+
+#include "pow/trinary.h"
+
+namespace entangled {
+
+// Bytes of the Keccak-384 input and output of a 243 trit Kerl block, and bytes of the Keccak-384 rate
+static size_t const kKerlBytes = 48;
+static size_t const kKerlRate = 104;
+
+/**
+ * Converts a 243 trit block to the 48 bytes Keccak-384 absorbs: the integer of its first 242 trits, in big endian
+ * two's complement
+ *
+ * @param trits The 243 trits
+ * @param bytes The output 48 bytes
+ */
+void kerlTritsToBytes(trit_t const *trits, uint8_t *bytes);
+
+/**
+ * Converts 48 bytes squeezed from Keccak-384 to a 243 trit block: the balanced ternary residue of their big endian
+ * two's complement integer modulo 3^242, the last trit being 0
+ *
+ * @param bytes The 48 bytes
+ * @param trits The output 243 trits
+ */
+void kerlBytesToTrits(uint8_t const *bytes, trit_t *trits);
+
+/**
+ * Scalar Kerl sponge, Keccak-384 over 243 trit blocks. Blocks are XORed straight into a Keccak-p[1600] state, without
+ * the byte queue and bit length bookkeeping of the generic KeccakHash interface.
+ */
+class Kerl {
+ public:
+  Kerl() { reset(); }
+
+  void reset();
+
+  /**
+   * Absorbs whole 243 trit blocks
+   *
+   * @param trits The trits
+   * @param length The number of trits, a multiple of 243
+   */
+  void absorb(trit_t const *trits, size_t length);
+
+  /**
+   * Squeezes whole 243 trit blocks
+   *
+   * @param trits The output trits
+   * @param length The number of trits, a multiple of 243
+   */
+  void squeeze(trit_t *trits, size_t length);
+
+ private:
+  uint64_t state_[KeccakP1600_stateSizeInBytes / 8];
+  // Offset of the next byte absorbed within the rate
+  size_t offset_;
+};
+
+/**
+ * Hashes independent 243 trit chunks in place, each chunk being replaced by its Kerl hash a number of times. Chunks
+ * are spread over the lanes of a multi-buffer Keccak-p[1600], 8 with AVX-512 and 4 with AVX2.
+ *
+ * @param chunks The chunks, 243 trits each
+ * @param count The number of chunks
+ * @param rounds The number of times each chunk is hashed
+ */
+void kerlChunks(trit_t *chunks, size_t count, uint8_t const *rounds);
+
+/**
+ * Hashes independent 243 trit chunks in place, the same number of times each
+ */
+void kerlChunks(trit_t *chunks, size_t count, uint8_t rounds);
+
+/**
+ * Returns the number of chunks kerlChunks() hashes at once on this CPU
+ */
+size_t kerlLanes();
+
+}  // namespace entangled
+
+#endif  // __SIGN_KERL_H__
@@ -0,0 +1,53 @@
+/*
+ * Copyright (c) 2020 IOTA Stiftung
+ * https://github.com/iotaledger/entangled-node
+ *
+ * Refer to the LICENSE file for licensing information
+ */
+
+#if defined(ENTANGLED_POW_AVX2)
+
+// Everything but the kernel is included first, so that only the kernel is compiled for AVX2
+#include <immintrin.h>
+#include <stdint.h>
+
+#include "sign/kerl.h"
+
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("avx2"))), apply_to = function)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("avx2")
+#endif
+
+#include "sign/kerl_kernel.h"
+
+namespace entangled {
+
+struct KeccakAvx2 {
+  typedef __m256i word;
+  static size_t const kLanes = 4;
+
+  static word set(uint64_t value) { return _mm256_set1_epi64x(static_cast<long long>(value)); }
+  static word bxor(word a, word b) { return _mm256_xor_si256(a, b); }
+  static word bandnot(word a, word b) { return _mm256_andnot_si256(a, b); }
+  static word rol(word a, unsigned offset) {
+    return offset == 0 ? a : _mm256_or_si256(_mm256_slli_epi64(a, offset), _mm256_srli_epi64(a, 64 - offset));
+  }
+  static word load(uint64_t const *lanes) { return _mm256_loadu_si256(reinterpret_cast<__m256i const *>(lanes)); }
+  static void store(word a, uint64_t *lanes) { _mm256_storeu_si256(reinterpret_cast<__m256i *>(lanes), a); }
+};
+
+void kerlChunkLanesAvx2(trit_t *chunks, size_t count, uint8_t const *rounds) {
+  kerlChunkLanes<KeccakAvx2>(chunks, count, rounds);
+}
+
+}  // namespace entangled
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
+
+#endif  // ENTANGLED_POW_AVX2
@@ -0,0 +1,51 @@
+/*
+ * Copyright (c) 2020 IOTA Stiftung
+ * https://github.com/iotaledger/entangled-node
+ *
+ * Refer to the LICENSE file for licensing information
+ */
+
+#if defined(ENTANGLED_POW_AVX512)
+
+// Everything but the kernel is included first, so that only the kernel is compiled for AVX-512
+#include <immintrin.h>
+#include <stdint.h>
+
+#include "sign/kerl.h"
+
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("avx512f"))), apply_to = function)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("avx512f")
+#endif
+
+#include "sign/kerl_kernel.h"
+
+namespace entangled {
+
+struct KeccakAvx512 {
+  typedef __m512i word;
+  static size_t const kLanes = 8;
+
+  static word set(uint64_t value) { return _mm512_set1_epi64(static_cast<long long>(value)); }
+  static word bxor(word a, word b) { return _mm512_xor_si512(a, b); }
+  static word bandnot(word a, word b) { return _mm512_maskz_andnot_epi64(0xff, a, b); }
+  static word rol(word a, unsigned offset) { return _mm512_maskz_rolv_epi64(0xff, a, _mm512_set1_epi64(offset)); }
+  static word load(uint64_t const *lanes) { return _mm512_loadu_si512(lanes); }
+  static void store(word a, uint64_t *lanes) { _mm512_storeu_si512(lanes, a); }
+};
+
+void kerlChunkLanesAvx512(trit_t *chunks, size_t count, uint8_t const *rounds) {
+  kerlChunkLanes<KeccakAvx512>(chunks, count, rounds);
+}
+
+}  // namespace entangled
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
+
+#endif  // ENTANGLED_POW_AVX512
@@ -0,0 +1,150 @@
+/*
+ * Copyright (c) 2020 IOTA Stiftung
+ * https://github.com/iotaledger/entangled-node
+ *
+ * Refer to the LICENSE file for licensing information
+ */
+
+#ifndef __SIGN_KERL_KERNEL_H__
+#define __SIGN_KERL_KERNEL_H__
+
+#include <stdint.h>
+
+#include "sign/kerl.h"
+
+namespace entangled {
+
+/*
+ * Multi-buffer Keccak-p[1600]: lane i of the state of buffer k is element k of word i. A lane type L provides the
+ * word type, the number of buffers kLanes and the bitwise operations, as the Ptrit types do for Curl.
+ */
+
+static uint64_t const kKeccakRoundConstants[24] = {
+    0x0000000000000001ULL, 0x0000000000008082ULL, 0x800000000000808aULL, 0x8000000080008000ULL,
+    0x000000000000808bULL, 0x0000000080000001ULL, 0x8000000080008081ULL, 0x8000000000008009ULL,
+    0x000000000000008aULL, 0x0000000000000088ULL, 0x0000000080008009ULL, 0x000000008000000aULL,
+    0x000000008000808bULL, 0x800000000000008bULL, 0x8000000000008089ULL, 0x8000000000008003ULL,
+    0x8000000000008002ULL, 0x8000000000000080ULL, 0x000000000000800aULL, 0x800000008000000aULL,
+    0x8000000080008081ULL, 0x8000000000008080ULL, 0x0000000080000001ULL, 0x8000000080008008ULL,
+};
+
+// Rho and pi merged: lane i after pi is lane kKeccakPiSource[i] before it, rotated by kKeccakRho[i]
+static unsigned const kKeccakPiSource[25] = {0, 6,  12, 18, 24, 3,  9,  10, 16, 22, 1,  7, 13,
+                                             19, 20, 4, 5,  11, 17, 23, 2, 8,  14, 15, 21};
+static unsigned const kKeccakRho[25] = {0,  44, 43, 21, 14, 28, 20, 3, 45, 61, 1,  6, 25,
+                                        8,  18, 27, 36, 10, 15, 56, 62, 55, 39, 41, 2};
+
+template <class L>
+inline void keccakPermute(typename L::word *a) {
+  typedef typename L::word word;
+  word b[25], c[5], d[5];
+
+  for (size_t round = 0; round < 24; round++) {
+    for (size_t x = 0; x < 5; x++) {
+      c[x] = L::bxor(L::bxor(L::bxor(a[x], a[x + 5]), L::bxor(a[x + 10], a[x + 15])), a[x + 20]);
+    }
+    for (size_t x = 0; x < 5; x++) {
+      d[x] = L::bxor(c[(x + 4) % 5], L::rol(c[(x + 1) % 5], 1));
+    }
+    b[0] = L::bxor(a[0], d[0]);
+    for (size_t i = 1; i < 25; i++) {
+      b[i] = L::rol(L::bxor(a[kKeccakPiSource[i]], d[kKeccakPiSource[i] % 5]), kKeccakRho[i]);
+    }
+    for (size_t y = 0; y < 25; y += 5) {
+      for (size_t x = 0; x < 5; x++) {
+        a[y + x] = L::bxor(b[y + x], L::bandnot(b[y + (x + 1) % 5], b[y + (x + 2) % 5]));
+      }
+    }
+    a[0] = L::bxor(a[0], L::set(kKeccakRoundConstants[round]));
+  }
+}
+
+static inline uint64_t loadLittleEndian(uint8_t const *bytes) {
+  uint64_t lane = 0;
+
+  for (size_t i = 0; i < 8; i++) {
+    lane |= static_cast<uint64_t>(bytes[i]) << (8 * i);
+  }
+  return lane;
+}
+
+static inline void storeLittleEndian(uint64_t lane, uint8_t *bytes) {
+  for (size_t i = 0; i < 8; i++) {
+    bytes[i] = static_cast<uint8_t>(lane >> (8 * i));
+  }
+}
+
+/**
+ * Hashes chunks with a lane type, see kerlChunks(). Each buffer takes the next chunk as soon as its chunk is done.
+ */
+template <class L>
+void kerlChunkLanes(trit_t *chunks, size_t count, uint8_t const *rounds) {
+  typedef typename L::word word;
+  static size_t const kLanes = L::kLanes;
+  static size_t const kBlockLanes = kKerlBytes / 8;
+  // Chunk and hashes left of each buffer, none once remaining is 0
+  size_t chunk[kLanes];
+  size_t remaining[kLanes];
+  uint64_t lanes[kBlockLanes][kLanes];
+  uint8_t bytes[kKerlBytes];
+  word state[25];
+  size_t next = 0;
+
+  for (size_t k = 0; k < kLanes; k++) {
+    remaining[k] = 0;
+  }
+
+  for (;;) {
+    size_t active = 0;
+
+    for (size_t k = 0; k < kLanes; k++) {
+      while (remaining[k] == 0 && next < count) {
+        chunk[k] = next;
+        remaining[k] = rounds[next++];
+      }
+      if (remaining[k] == 0) {
+        for (size_t j = 0; j < kBlockLanes; j++) {
+          lanes[j][k] = 0;
+        }
+        continue;
+      }
+      active++;
+      kerlTritsToBytes(chunks + chunk[k] * kHashTrits, bytes);
+      for (size_t j = 0; j < kBlockLanes; j++) {
+        lanes[j][k] = loadLittleEndian(bytes + 8 * j);
+      }
+    }
+    if (active == 0) {
+      break;
+    }
+
+    // A single 48 byte block absorbed with Kerl's padding: 0x01 right after it and 0x80 at the end of the 104 byte rate
+    for (size_t j = 0; j < 25; j++) {
+      state[j] = j < kBlockLanes ? L::load(lanes[j]) : L::set(0);
+    }
+    state[6] = L::set(0x01);
+    state[12] = L::set(0x8000000000000000ULL);
+    keccakPermute<L>(state);
+    for (size_t j = 0; j < kBlockLanes; j++) {
+      L::store(state[j], lanes[j]);
+    }
+
+    for (size_t k = 0; k < kLanes; k++) {
+      if (remaining[k] == 0) {
+        continue;
+      }
+      for (size_t j = 0; j < kBlockLanes; j++) {
+        storeLittleEndian(lanes[j][k], bytes + 8 * j);
+      }
+      kerlBytesToTrits(bytes, chunks + chunk[k] * kHashTrits);
+      remaining[k]--;
+    }
+  }
+}
+
+void kerlChunkLanesAvx2(trit_t *chunks, size_t count, uint8_t const *rounds);
+void kerlChunkLanesAvx512(trit_t *chunks, size_t count, uint8_t const *rounds);
+
+}  // namespace entangled
+
+#endif  // __SIGN_KERL_KERNEL_H__
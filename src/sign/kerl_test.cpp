@@ -0,0 +1,347 @@
+/*
+ * Copyright (c) 2020 IOTA Stiftung
+ * https://github.com/iotaledger/entangled-node
+ *
+ * Refer to the LICENSE file for licensing information
+ */
+
+/*
+ * Checks the Kerl trit and byte conversions against the generic 32 bit word implementation they replaced, and the Kerl
+ * sponge and chunk hashing against a Kerl over the generic KeccakHash interface, then times both.
+ * Usage: kerl_test [conversions]. Exits with status 1 on any mismatch.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <random>
+#include <vector>
+
+extern "C" {
+#include "keccak/KeccakHash.h"
+}
+
+#include "sign/kerl.h"
+
+using namespace entangled;
+
+static size_t const kWords = 12;
+
+// (3^242 - 1) / 2 and 3^242, least significant word first
+static uint32_t const kReferenceHalf3[kWords] = {0xa5ce8964, 0x9f007669, 0x1484504f, 0x3ade00d9,
+                                                 0x0c24486e, 0x50979d57, 0x79a4c702, 0x48bbae36,
+                                                 0xa9f6808b, 0xaa06a805, 0xa87fabdf, 0x5e69ebef};
+static uint32_t const kReferencePow3[kWords] = {0x4b9d12c9, 0x3e00ecd3, 0x2908a09f, 0x75bc01b2,
+                                                0x184890dc, 0xa12f3aae, 0xf3498e04, 0x91775c6c,
+                                                0x53ed0116, 0x540d500b, 0x50ff57bf, 0xbcd3d7df};
+
+static bool referenceAdd(uint32_t *a, uint32_t const *b) {
+  uint64_t carry = 0;
+
+  for (size_t i = 0; i < kWords; i++) {
+    carry += static_cast<uint64_t>(a[i]) + b[i];
+    a[i] = static_cast<uint32_t>(carry);
+    carry >>= 32;
+  }
+  return carry != 0;
+}
+
+// One trit at a time, multiply-adds and divisions over 32 bit words
+static void referenceTritsToBytes(trit_t const *trits, uint8_t *bytes) {
+  uint32_t words[kWords] = {0};
+  uint32_t negHalf3[kWords];
+
+  for (size_t i = 242; i-- > 0;) {
+    uint64_t carry = static_cast<uint64_t>(trits[i] + 1);
+    for (size_t j = 0; j < kWords; j++) {
+      carry += static_cast<uint64_t>(words[j]) * 3;
+      words[j] = static_cast<uint32_t>(carry);
+      carry >>= 32;
+    }
+  }
+
+  uint64_t carry = 1;
+  for (size_t j = 0; j < kWords; j++) {
+    carry += static_cast<uint32_t>(~kReferenceHalf3[j]);
+    negHalf3[j] = static_cast<uint32_t>(carry);
+    carry >>= 32;
+  }
+  referenceAdd(words, negHalf3);
+
+  for (size_t j = 0; j < kWords; j++) {
+    uint32_t word = words[kWords - 1 - j];
+    bytes[4 * j] = static_cast<uint8_t>(word >> 24);
+    bytes[4 * j + 1] = static_cast<uint8_t>(word >> 16);
+    bytes[4 * j + 2] = static_cast<uint8_t>(word >> 8);
+    bytes[4 * j + 3] = static_cast<uint8_t>(word);
+  }
+}
+
+static void referenceBytesToTrits(uint8_t const *bytes, trit_t *trits) {
+  uint32_t words[kWords];
+
+  for (size_t j = 0; j < kWords; j++) {
+    uint8_t const *word = bytes + 4 * (kWords - 1 - j);
+    words[j] = static_cast<uint32_t>(word[0]) << 24 | static_cast<uint32_t>(word[1]) << 16 |
+               static_cast<uint32_t>(word[2]) << 8 | word[3];
+  }
+
+  bool negative = words[kWords - 1] >> 31 != 0;
+  if (!referenceAdd(words, kReferenceHalf3) && negative) {
+    referenceAdd(words, kReferencePow3);
+  }
+
+  for (size_t i = 0; i < 242; i++) {
+    uint64_t rem = 0;
+    for (size_t j = kWords; j-- > 0;) {
+      uint64_t value = rem << 32 | words[j];
+      words[j] = static_cast<uint32_t>(value / 3);
+      rem = value % 3;
+    }
+    trits[i] = static_cast<trit_t>(rem) - 1;
+  }
+  trits[242] = 0;
+}
+
+// Kerl over KeccakHash.c
+class ReferenceKerl {
+ public:
+  ReferenceKerl() { reset(); }
+
+  void reset() { Keccak_HashInitialize(&keccak_, 832, 768, 384, 0x01); }
+
+  void absorb(trit_t const *trits, size_t length) {
+    uint8_t bytes[kKerlBytes];
+
+    for (size_t i = 0; i < length; i += kHashTrits) {
+      referenceTritsToBytes(trits + i, bytes);
+      Keccak_HashUpdate(&keccak_, bytes, 8 * kKerlBytes);
+    }
+  }
+
+  void squeeze(trit_t *trits, size_t length) {
+    uint8_t bytes[kKerlBytes];
+
+    for (size_t i = 0; i < length; i += kHashTrits) {
+      Keccak_HashFinal(&keccak_, bytes);
+      referenceBytesToTrits(bytes, trits + i);
+      for (size_t j = 0; j < kKerlBytes; j++) {
+        bytes[j] = ~bytes[j];
+      }
+      reset();
+      Keccak_HashUpdate(&keccak_, bytes, 8 * kKerlBytes);
+    }
+  }
+
+ private:
+  Keccak_HashInstance keccak_;
+};
+
+static size_t failures = 0;
+
+static void fail(char const *what, size_t test) {
+  if (failures++ < 10) {
+    fprintf(stderr, "Mismatch in %s, test %zu\n", what, test);
+  }
+}
+
+// Converts trits both ways with both implementations, they must round trip
+static void checkTrits(trit_t const *trits, size_t test) {
+  uint8_t reference[kKerlBytes], bytes[kKerlBytes];
+  trit_t back[kHashTrits];
+
+  referenceTritsToBytes(trits, reference);
+  kerlTritsToBytes(trits, bytes);
+  if (memcmp(reference, bytes, kKerlBytes) != 0) {
+    fail("kerlTritsToBytes", test);
+  }
+  kerlBytesToTrits(bytes, back);
+  if (memcmp(trits, back, 242) != 0 || back[242] != 0) {
+    fail("round trip", test);
+  }
+}
+
+static void checkBytes(uint8_t const *bytes, size_t test) {
+  trit_t reference[kHashTrits], trits[kHashTrits];
+
+  referenceBytesToTrits(bytes, reference);
+  kerlBytesToTrits(bytes, trits);
+  if (memcmp(reference, trits, kHashTrits) != 0) {
+    fail("kerlBytesToTrits", test);
+  }
+}
+
+static void testEdges() {
+  trit_t trits[kHashTrits];
+  uint8_t bytes[kKerlBytes];
+  size_t test = 0;
+
+  // Constant trits, and a single non-zero trit at every position
+  for (int value = -1; value <= 1; value++) {
+    memset(trits, value, sizeof(trits));
+    trits[242] = 0;
+    checkTrits(trits, test++);
+  }
+  for (size_t i = 0; i < 242; i++) {
+    for (int value = -1; value <= 1; value += 2) {
+      memset(trits, 0, sizeof(trits));
+      trits[i] = static_cast<trit_t>(value);
+      checkTrits(trits, test++);
+    }
+  }
+
+  // Constant bytes, then every single byte value at every position over zero and ones
+  for (int fill = 0; fill < 256; fill++) {
+    memset(bytes, fill, sizeof(bytes));
+    checkBytes(bytes, test++);
+  }
+  for (size_t i = 0; i < kKerlBytes; i++) {
+    for (int value = 0; value < 256; value++) {
+      memset(bytes, 0, sizeof(bytes));
+      bytes[i] = static_cast<uint8_t>(value);
+      checkBytes(bytes, test++);
+      memset(bytes, 0xff, sizeof(bytes));
+      bytes[i] = static_cast<uint8_t>(value);
+      checkBytes(bytes, test++);
+    }
+  }
+}
+
+static void testRandom(std::mt19937_64 &random, size_t count) {
+  trit_t trits[kHashTrits];
+  uint8_t bytes[kKerlBytes];
+
+  for (size_t test = 0; test < count; test++) {
+    for (size_t i = 0; i < 242; i++) {
+      trits[i] = static_cast<trit_t>(random() % 3) - 1;
+    }
+    trits[242] = 0;
+    checkTrits(trits, test);
+    for (size_t i = 0; i < kKerlBytes; i++) {
+      bytes[i] = static_cast<uint8_t>(random());
+    }
+    checkBytes(bytes, test);
+  }
+}
+
+static void randomTrits(std::mt19937_64 &random, trit_t *trits, size_t length) {
+  for (size_t i = 0; i < length; i++) {
+    trits[i] = static_cast<trit_t>(random() % 3) - 1;
+  }
+}
+
+// Absorbs and squeezes up to 30 blocks, through one sponge, several times
+static void testSponge(std::mt19937_64 &random) {
+  std::vector<trit_t> input(30 * kHashTrits), reference(5 * kHashTrits), output(5 * kHashTrits);
+  ReferenceKerl referenceKerl;
+  Kerl kerl;
+  size_t test = 0;
+
+  for (size_t absorbed = 0; absorbed <= 30; absorbed++) {
+    for (size_t squeezed = 1; squeezed <= 5; squeezed++) {
+      randomTrits(random, input.data(), input.size());
+      for (size_t repeat = 0; repeat < 2; repeat++) {
+        referenceKerl.absorb(input.data(), absorbed * kHashTrits);
+        referenceKerl.squeeze(reference.data(), squeezed * kHashTrits);
+        kerl.absorb(input.data(), absorbed * kHashTrits);
+        kerl.squeeze(output.data(), squeezed * kHashTrits);
+        if (reference != output) {
+          fail("Kerl", test);
+        }
+      }
+      referenceKerl.reset();
+      kerl.reset();
+      test++;
+    }
+  }
+}
+
+// Hashes chunks a random number of times each, as key digests and signatures do
+static void testChunks(std::mt19937_64 &random) {
+  size_t const count = 3 * 27;
+  std::vector<trit_t> chunks(count * kHashTrits), reference;
+  std::vector<uint8_t> rounds(count);
+
+  randomTrits(random, chunks.data(), chunks.size());
+  for (size_t i = 0; i < count; i++) {
+    chunks[i * kHashTrits + 242] = 0;
+    rounds[i] = static_cast<uint8_t>(random() % 27);
+  }
+  reference = chunks;
+
+  kerlChunks(chunks.data(), count, rounds.data());
+  for (size_t i = 0; i < count; i++) {
+    for (size_t round = 0; round < rounds[i]; round++) {
+      ReferenceKerl kerl;
+      kerl.absorb(&reference[i * kHashTrits], kHashTrits);
+      kerl.squeeze(&reference[i * kHashTrits], kHashTrits);
+    }
+    if (memcmp(&chunks[i * kHashTrits], &reference[i * kHashTrits], kHashTrits) != 0) {
+      fail("kerlChunks", i);
+    }
+  }
+}
+
+template <class F>
+static double nanoseconds(size_t count, F convert) {
+  auto start = std::chrono::steady_clock::now();
+
+  for (size_t i = 0; i < count; i++) {
+    convert();
+  }
+  return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / count;
+}
+
+static void benchmark(std::mt19937_64 &random, size_t count) {
+  trit_t trits[kHashTrits];
+  uint8_t bytes[kKerlBytes];
+
+  for (size_t i = 0; i < kKerlBytes; i++) {
+    bytes[i] = static_cast<uint8_t>(random());
+  }
+  kerlBytesToTrits(bytes, trits);
+
+  // Chained, so that no conversion can be skipped
+  double referenceToBytes = nanoseconds(count, [&] {
+    referenceTritsToBytes(trits, bytes);
+    trits[bytes[0] % 242] = static_cast<trit_t>(bytes[1] % 3) - 1;
+  });
+  double toBytes = nanoseconds(count, [&] {
+    kerlTritsToBytes(trits, bytes);
+    trits[bytes[0] % 242] = static_cast<trit_t>(bytes[1] % 3) - 1;
+  });
+  double referenceToTrits = nanoseconds(count, [&] {
+    referenceBytesToTrits(bytes, trits);
+    bytes[trits[0] + 1] ^= static_cast<uint8_t>(trits[1] + 2);
+  });
+  double toTrits = nanoseconds(count, [&] {
+    kerlBytesToTrits(bytes, trits);
+    bytes[trits[0] + 1] ^= static_cast<uint8_t>(trits[1] + 2);
+  });
+
+  printf("Kerl conversions, %zu each\n", count);
+  printf("  trits to bytes: %.1f ns, reference %.1f ns, %.1fx\n", toBytes, referenceToBytes,
+         referenceToBytes / toBytes);
+  printf("  bytes to trits: %.1f ns, reference %.1f ns, %.1fx\n", toTrits, referenceToTrits,
+         referenceToTrits / toTrits);
+}
+
+int main(int argc, char **argv) {
+  size_t count = argc > 1 ? strtoul(argv[1], NULL, 10) : 100000;
+  std::mt19937_64 random(243);
+
+  testEdges();
+  testRandom(random, count);
+  testSponge(random);
+  testChunks(random);
+  if (count > 0) {
+    benchmark(random, count);
+  }
+  if (failures > 0) {
+    fprintf(stderr, "%zu mismatches\n", failures);
+    return 1;
+  }
+  printf("Conversions match\n");
+  return 0;
+}
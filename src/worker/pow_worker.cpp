@@ -0,0 +1,207 @@
+/*
+ * Copyright (c) 2020 IOTA Stiftung
+ * https://github.com/iotaledger/entangled-node
+ *
+ * Refer to the LICENSE file for licensing information
+ */
+
+/*
+ * Proof of Work worker process, serving the requests of SocketPowBackend on a Unix domain socket:
+ *
+ *   entangled_pow_worker <socket path> [threads]
+ *
+ * Every connection carries one request, run on the thread pool of the worker. Identical requests share one search,
+ * and a request is cancelled once its connection is closed. A single poll() loop serves every connection.
+ */
+
+#include <errno.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "pow/socket_backend.h"
+#include "pow/transaction.h"
+
+using namespace entangled;
+
+// A client connection, shared with the completion of its request
+struct connection_t {
+  int fd;
+  // The request bytes read, then the reply and the number of its bytes written
+  std::string buffer;
+  std::string reply;
+  size_t written;
+  // Set once the request is read, its reply being encoded by its completion
+  std::shared_ptr<Control> control;
+  std::mutex mutex;
+  bool done;
+};
+
+static PollWaker waker;
+
+static void respond(connection_t &connection, pow_status_t status, PowTask *task) {
+  std::string reply = std::to_string(status) + " " + std::to_string(connection.control->attempts()) + " " +
+                      std::to_string(connection.control->threads());
+  std::string result;
+
+  if (status == POW_FOUND) {
+    task->encodeResult(result);
+    reply += " " + result;
+  }
+  std::lock_guard<std::mutex> lock(connection.mutex);
+  if (!encodeFrame(reply, connection.reply)) {
+    connection.reply.clear();
+  }
+  connection.done = true;
+}
+
+// Takes the request of a connection, which is read once
+static void submit(std::shared_ptr<connection_t> connection, std::string const &request) {
+  std::shared_ptr<PowTask> task = decodePowTask(request);
+
+  connection->control = std::make_shared<Control>();
+  if (!task) {
+    respond(*connection, POW_INVALID_INPUT, NULL);
+    return;
+  }
+
+  pow_settings_t settings = powDefaults();
+  Scheduler *scheduler = Scheduler::pool(settings.placement);
+  std::shared_ptr<Control> progress;
+  auto complete = [connection](pow_status_t status, std::shared_ptr<PowTask> solved) {
+    respond(*connection, status, solved.get());
+    waker.wake();
+  };
+
+  pow_request_t submitted = {"remote:" + request, task, connection->control, scheduler, PRIORITY_NORMAL,
+                             settings.threads};
+  if (scheduler == NULL || !LocalPowBackend().submit(submitted, complete, progress)) {
+    respond(*connection, POW_REJECTED, NULL);
+  }
+}
+
+// Returns false once the connection is done with, closing it
+static bool step(std::shared_ptr<connection_t> const &connection) {
+  std::string request;
+  char chunk[256];
+  bool done;
+
+  if (!connection->control) {
+    int read = readSome(connection->fd, connection->buffer, request);
+    if (read < 0) {
+      close(connection->fd);
+      return false;
+    }
+    if (read > 0) {
+      connection->buffer.clear();
+      submit(connection, request);
+    }
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(connection->mutex);
+    done = connection->done;
+  }
+  if (done) {
+    if (writeSome(connection->fd, connection->reply, connection->written) != 0) {
+      close(connection->fd);
+      return false;
+    }
+    return true;
+  }
+
+  // A client never sends anything after its request, so anything readable is it closing its connection
+  if (connection->control) {
+    ssize_t received = recv(connection->fd, chunk, sizeof(chunk), MSG_DONTWAIT);
+    if (received == 0 || (received < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+      connection->control->cancel();
+      close(connection->fd);
+      return false;
+    }
+  }
+  return true;
+}
+
+int main(int argc, char **argv) {
+  struct sockaddr_un address;
+  std::vector<std::shared_ptr<connection_t>> connections;
+  std::vector<struct pollfd> pfds;
+
+  if (argc < 2 || argc > 3 || strlen(argv[1]) >= sizeof(address.sun_path)) {
+    fprintf(stderr, "Usage: %s <socket path> [threads]\n", argv[0]);
+    return 1;
+  }
+  if (argc == 3) {
+    pow_settings_t settings = powDefaults();
+    settings.threads = strtoul(argv[2], NULL, 10);
+    setPowDefaults(settings);
+  }
+  signal(SIGPIPE, SIG_IGN);
+
+  memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  strcpy(address.sun_path, argv[1]);
+  unlink(argv[1]);
+
+  int server = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (server < 0 || !setNonBlocking(server) ||
+      bind(server, reinterpret_cast<struct sockaddr *>(&address), sizeof(address)) != 0 ||
+      listen(server, SOMAXCONN) != 0) {
+    perror(argv[1]);
+    return 1;
+  }
+
+  for (;;) {
+    pfds.assign({{waker.fd(), POLLIN, 0}, {server, POLLIN, 0}});
+    for (auto const &connection : connections) {
+      std::lock_guard<std::mutex> lock(connection->mutex);
+      pfds.push_back({connection->fd, static_cast<short>(connection->done ? POLLOUT : POLLIN), 0});
+    }
+
+    if (poll(pfds.data(), pfds.size(), -1) <= 0) {
+      continue;
+    }
+    if (pfds[0].revents != 0) {
+      waker.drain();
+    }
+
+    // Requests completed since the poll woke the loop to write their reply
+    std::vector<std::shared_ptr<connection_t>> served;
+    for (size_t i = 0; i < connections.size(); i++) {
+      bool completed;
+      {
+        std::lock_guard<std::mutex> lock(connections[i]->mutex);
+        completed = connections[i]->done && pfds[i + 2].events == POLLIN;
+      }
+      if ((pfds[i + 2].revents == 0 && !completed) || step(connections[i])) {
+        served.push_back(connections[i]);
+      }
+    }
+    connections.swap(served);
+
+    if (pfds[1].revents != 0) {
+      int fd;
+      while ((fd = accept(server, NULL, NULL)) >= 0) {
+        if (!setNonBlocking(fd)) {
+          close(fd);
+          continue;
+        }
+        std::shared_ptr<connection_t> connection = std::make_shared<connection_t>();
+        connection->fd = fd;
+        connection->written = 0;
+        connection->done = false;
+        connections.push_back(connection);
+      }
+    }
+  }
+}
@@ -1,7 +1,7 @@
 const chai = require('chai')
 const assert = chai.assert
 
-const { powTrytesFunc, powBundleFunc, genAddressTrytesFunc, genAddressTritsFunc, genSignatureTrytesFunc, genSignatureTritsFunc, transactionHashFunc, bundleMiner } = require('../iota_common')
+const { powTrytesFunc, powBundleFunc, genAddressTrytesFunc, genAddressTritsFunc, genSignatureTrytesFunc, genSignatureTritsFunc, transactionHashFunc, bundleMiner, powBundlesFunc, transactionHashSync, createJobRing, createHashStream, schedulerStats, setQueueCapacity, setPowDefaults } = require('../iota_common')
 
 describe('IotaCommon.powTrytesFunc', function() {
 	const tests = [
@@ -68,6 +68,15 @@ describe('IotaCommon.genAddressTrytesFunc', function() {
 			assert.deepEqual(test.expected, address)
 		})
 	})
+
+	it('Should reject an invalid security level', async function() {
+		try {
+			await genAddressTrytesFunc(seed, 0, 4)
+			assert.fail()
+		} catch (err) {
+			assert.equal(err.message, 'Invalid seed, bundle hash or security level')
+		}
+	})
 })
 
 describe('IotaCommon.genAddressTritsFunc', function() {
@@ -172,3 +181,768 @@ describe('IotaCommon.bundleMiner', function() {
 		})
 	})
 })
+
+describe('IotaCommon.async', function() {
+	const trytes = '9'.repeat(2673)
+
+	it('Should keep the event loop running while Proof of Work is in progress', async function() {
+		this.timeout(0)
+		let ticks = 0
+		const timer = setInterval(() => ticks++, 1)
+		await powTrytesFunc(trytes, 14)
+		clearInterval(timer)
+		assert.isAbove(ticks, 0)
+	})
+
+	it('Should return the same transaction hash synchronously and asynchronously', async function() {
+		assert.equal(transactionHashSync(trytes), await transactionHashFunc(trytes))
+	})
+})
+
+describe('IotaCommon.powTrytesFunc options', function() {
+	const trytes = '9'.repeat(2673)
+
+	it('Should reject with an AbortError once aborted', async function() {
+		if (typeof AbortController === 'undefined') {
+			this.skip()
+		}
+		const controller = new AbortController()
+		setTimeout(() => controller.abort(), 50)
+		const start = Date.now()
+		try {
+			await powTrytesFunc(trytes, 81, { signal: controller.signal })
+			assert.fail('Proof of Work should have been cancelled')
+		} catch (err) {
+			assert.equal(err.name, 'AbortError')
+			assert.isBelow(Date.now() - start, 1000)
+		}
+	})
+
+	it('Should reject with ETIMEDOUT past the deadline', async function() {
+		try {
+			await powTrytesFunc(trytes, 81, { deadline: Date.now() + 50 })
+			assert.fail('Proof of Work should have timed out')
+		} catch (err) {
+			assert.equal(err.code, 'ETIMEDOUT')
+		}
+	})
+
+	it('Should report progress while searching', async function() {
+		const events = []
+		try {
+			await powTrytesFunc(trytes, 81, { timeout: 500, progressInterval: 50, onProgress: (event) => events.push(event) })
+		} catch (err) {
+			assert.equal(err.code, 'ETIMEDOUT')
+		}
+		assert.isAbove(events.length, 0)
+		assert.isAbove(events[events.length - 1].attempts, 0)
+		assert.isAbove(events[events.length - 1].hashrate, 0)
+	})
+})
+
+describe('IotaCommon.scheduler', function() {
+	const trytes = '9'.repeat(2673)
+
+	it('Should expose per priority queue statistics', function() {
+		const stats = schedulerStats()
+		assert.isAbove(stats.threads, 0)
+		for (const priority of ['interactive', 'normal', 'bulk']) {
+			assert.isAtLeast(stats.queues[priority].capacity, 1)
+		}
+	})
+
+	it('Should reject jobs with EBUSY once a queue is full', async function() {
+		const rejected = schedulerStats().queues.bulk.rejected
+		setQueueCapacity('bulk', 0)
+		try {
+			await powTrytesFunc(trytes, 1, { priority: 'bulk' })
+			assert.fail('Proof of Work should have been rejected')
+		} catch (err) {
+			assert.equal(err.code, 'EBUSY')
+		} finally {
+			setQueueCapacity('bulk', 4096)
+		}
+		assert.equal(schedulerStats().queues.bulk.rejected, rejected + 1)
+	})
+
+	it('Should run interactive jobs while Proof of Work is queued', async function() {
+		const pow = powTrytesFunc(trytes, 81, { timeout: 1000, priority: 'bulk' }).catch((err) => err)
+		const start = Date.now()
+		await transactionHashFunc(trytes)
+		assert.isBelow(Date.now() - start, 500)
+		assert.equal((await pow).code, 'ETIMEDOUT')
+	})
+})
+
+describe('IotaCommon.powTrytesFunc coalescing', function() {
+	const trytes = '9'.repeat(2673)
+
+	it('Should give identical requests in flight the same nonce', async function() {
+		this.timeout(0)
+		const nonces = await Promise.all([powTrytesFunc(trytes, 14), powTrytesFunc(trytes, 14), powTrytesFunc(trytes, 14)])
+		assert.equal(nonces[0], nonces[1])
+		assert.equal(nonces[0], nonces[2])
+	})
+
+	it('Should keep searching for the other requests when one of them times out', async function() {
+		this.timeout(0)
+		const first = powTrytesFunc(trytes, 13, { timeout: 1 }).catch((err) => err)
+		const second = powTrytesFunc(trytes, 13)
+		assert.equal((await first).code, 'ETIMEDOUT')
+		assert.lengthOf(await second, 27)
+	})
+})
+
+describe('IotaCommon.powBundlesFunc', function() {
+	const tx = '9'.repeat(2673)
+	const bundles = [
+		{ trytes: [tx, tx], trunk: 'A'.repeat(81), branch: 'B'.repeat(81) },
+		{ trytes: [tx, tx], trunk: 'C'.repeat(81), branch: 'D'.repeat(81) }
+	]
+
+	it('Should attach every bundle to its own trunk and branch', async function() {
+		this.timeout(0)
+		const results = await Promise.all(powBundlesFunc(bundles, 9))
+		results.forEach(function(txs, i) {
+			assert.lengthOf(txs, 2)
+			assert.equal(txs[1].slice(2430, 2511), bundles[i].trunk)
+			assert.equal(txs[1].slice(2511, 2592), bundles[i].branch)
+			assert.equal(txs[0].slice(2430, 2511), transactionHashSync(txs[1]))
+		})
+	})
+
+	it('Should reject every bundle once aborted', async function() {
+		if (typeof AbortController === 'undefined') {
+			this.skip()
+		}
+		const controller = new AbortController()
+		const results = powBundlesFunc(bundles, 81, { signal: controller.signal }).map((result) => result.catch((err) => err))
+		setTimeout(() => controller.abort(), 50)
+		for (const err of await Promise.all(results)) {
+			assert.equal(err.name, 'AbortError')
+		}
+	})
+})
+
+describe('IotaCommon.worker_threads', function() {
+	let Worker
+	try {
+		Worker = require('worker_threads').Worker
+	} catch (err) {
+		// Node 10 needs --experimental-worker
+	}
+	const trytes = '9'.repeat(2673)
+	const source = `
+		const { parentPort, workerData } = require('worker_threads')
+		const { powTrytesFunc, transactionHashFunc } = require(workerData.module)
+		Promise.all([powTrytesFunc(workerData.trytes, 9), transactionHashFunc(workerData.trytes)]).then(([nonce, hash]) => parentPort.postMessage({ nonce, hash }))
+	`
+	const run = () =>
+		new Promise((resolve, reject) => {
+			const worker = new Worker(source, { eval: true, workerData: { module: require.resolve('../iota_common'), trytes } })
+			worker.once('message', resolve)
+			worker.once('error', reject)
+		})
+
+	it('Should load and run in several worker threads at once', async function() {
+		if (!Worker) {
+			this.skip()
+		}
+		this.timeout(0)
+		const results = await Promise.all([run(), run(), powTrytesFunc(trytes, 9)])
+		assert.equal(results[0].hash, transactionHashSync(trytes))
+		assert.equal(results[0].nonce, results[2])
+		assert.equal(results[1].nonce, results[2])
+	})
+
+	it('Should cancel the jobs of a terminated worker thread', async function() {
+		if (!Worker) {
+			this.skip()
+		}
+		this.timeout(0)
+		const worker = new Worker(`require(${JSON.stringify(require.resolve('../iota_common'))}).powTrytesFunc('${trytes}', 81)`, { eval: true })
+		await new Promise((resolve) => setTimeout(resolve, 100))
+		await worker.terminate()
+		const start = Date.now()
+		while (schedulerStats().running > 0 && Date.now() - start < 1000) {
+			await new Promise((resolve) => setTimeout(resolve, 10))
+		}
+		assert.equal(schedulerStats().running, 0)
+	})
+})
+
+describe('IotaCommon.createJobRing', function() {
+	const transactions = Array.from({ length: 20 }, (_, i) => i.toString(3).replace(/0/g, '9').replace(/1/g, 'A').replace(/2/g, 'B').padEnd(2673, '9'))
+
+	it('Should hash more transactions than it has slots', async function() {
+		const ring = createJobRing({ slots: 4 })
+		const hashes = await Promise.all(transactions.map((trytes) => ring.transactionHash(trytes)))
+		hashes.forEach((hash, i) => assert.equal(hash, transactionHashSync(transactions[i])))
+		ring.close()
+	})
+
+	it('Should reject pending jobs once closed', async function() {
+		const ring = createJobRing({ slots: 2 })
+		const results = transactions.map((trytes) => ring.transactionHash(trytes).catch((err) => err))
+		ring.close()
+		const settled = await Promise.all(results)
+		assert.equal(settled[settled.length - 1].message, 'Job ring closed')
+		await ring.transactionHash(transactions[0]).then(assert.fail, (err) => assert.equal(err.message, 'Job ring closed'))
+	})
+})
+
+describe('IotaCommon.createHashStream', function() {
+	const transactions = Array.from({ length: 20 }, (_, i) => i.toString(3).replace(/0/g, '9').replace(/1/g, 'A').replace(/2/g, 'B').padEnd(2673, '9'))
+	const read = (stream) =>
+		new Promise((resolve, reject) => {
+			const hashes = []
+			stream.on('data', (hash) => hashes.push(hash))
+			stream.on('end', () => resolve(hashes))
+			stream.on('error', reject)
+		})
+
+	it('Should hash packed transactions in order', async function() {
+		const stream = createHashStream({ concurrency: 4 })
+		const hashes = read(stream)
+		const packed = Buffer.from(transactions.join(''), 'latin1')
+		// Chunks not aligned on transactions
+		for (let offset = 0; offset < packed.length; offset += 1000) {
+			stream.write(packed.slice(offset, offset + 1000))
+		}
+		stream.end()
+		assert.deepEqual(await hashes, transactions.map((trytes) => transactionHashSync(trytes)))
+	})
+
+	it('Should hold writes back while hashes are not read', async function() {
+		const stream = createHashStream({ concurrency: 2, highWaterMark: 2 })
+		const accepted = transactions.map((trytes) => stream.write(trytes))
+		assert.equal(accepted[accepted.length - 1], false)
+		await new Promise((resolve) => setTimeout(resolve, 100))
+		assert.isAtMost(stream.readableLength, 4)
+		stream.end()
+		assert.equal((await read(stream)).length, transactions.length)
+	})
+
+	it('Should report transactions below the min weight magnitude', async function() {
+		const stream = createHashStream({ mwm: 3 })
+		const invalid = []
+		stream.on('invalid', (trytes, hash) => invalid.push(hash))
+		const hashes = read(stream)
+		transactions.forEach((trytes) => stream.write(trytes))
+		stream.end()
+		const valid = await hashes
+		assert.equal(valid.length + invalid.length, transactions.length)
+		valid.forEach((hash) => assert.equal(hash[hash.length - 1], '9'))
+		invalid.forEach((hash) => assert.notEqual(hash[hash.length - 1], '9'))
+	})
+})
+
+describe('IotaCommon.powTrytesFunc placement', function() {
+	const trytes = '9'.repeat(2673)
+
+	it('Should find a valid nonce with fewer threads, pinned and niced', async function() {
+		this.timeout(0)
+		// Threads claim iterations in any order, so the nonce found depends on the number of threads
+		for (const options of [{ threads: 1 }, { cpus: [0], nice: 1 }]) {
+			const { nonce, weight, threads } = await powTrytesFunc(trytes, 9, { ...options, stats: true })
+			assert.equal(transactionHashSync(trytes.slice(0, 2646) + nonce).slice(-3), '999')
+			assert.isAtLeast(weight, 9)
+			assert.isAtLeast(threads, 1)
+			assert.isAtMost(threads, options.threads || options.cpus.length)
+		}
+	})
+
+	it('Should reject CPUs not available to the process', async function() {
+		const err = await powTrytesFunc(trytes, 9, { cpus: [1 << 20] }).catch((err) => err)
+		assert.equal(err.code, 'EINVAL')
+		try {
+			setPowDefaults({ nice: 100 })
+			assert.fail('Should throw')
+		} catch (err) {
+			assert.equal(err.code, 'EINVAL')
+		}
+	})
+})
+
+describe('IotaCommon.calibrate', function() {
+	const file = require('path').join(require('os').tmpdir(), `entangled-calibration-${process.pid}.json`)
+
+	after(function() {
+		require('fs').unlinkSync(file)
+	})
+
+	it('Should select and persist the fastest configuration', async function() {
+		this.timeout(0)
+		const { calibrate, calibration, estimatePowTime } = require('../iota_common')
+		const result = await calibrate({ duration: 500, file })
+		assert.isAbove(result.hashrate, 0)
+		assert.isAtLeast(result.threads, 1)
+		assert.deepEqual(calibration(), result)
+		assert.equal(Math.round(estimatePowTime(9, 2)), Math.round((2 * Math.pow(3, 9) * 1000) / result.hashrate))
+	})
+
+	it('Should reload the calibration file on require', function() {
+		const modulePath = require.resolve('../iota_common')
+		process.env.ENTANGLED_CALIBRATION_FILE = file
+		delete require.cache[modulePath]
+		try {
+			assert.equal(require('../iota_common').calibration().kernel, JSON.parse(require('fs').readFileSync(file, 'utf8')).kernel)
+		} finally {
+			delete process.env.ENTANGLED_CALIBRATION_FILE
+			delete require.cache[modulePath]
+			require('../iota_common')
+		}
+	})
+})
+
+describe('IotaCommon.powKernels', function() {
+	const { powKernels, setPowKernel } = require('../iota_common')
+	const trytes = '9'.repeat(2673)
+
+	it('Should find a valid nonce with every supported kernel', async function() {
+		this.timeout(0)
+		const { supported, selected } = powKernels()
+		assert.equal(supported[0], 'ptrit64')
+		try {
+			for (const kernel of supported) {
+				setPowKernel(kernel)
+				assert.equal(powKernels().selected, kernel)
+				const nonce = await powTrytesFunc(trytes, 9)
+				assert.equal(transactionHashSync(trytes.slice(0, 2673 - 27) + nonce).slice(-3), '999')
+			}
+		} finally {
+			setPowKernel(selected)
+		}
+	})
+
+	it('Should refuse unknown kernels', function() {
+		try {
+			setPowKernel('mmx')
+			assert.fail('Should throw')
+		} catch (err) {
+			assert.equal(err.code, 'EINVAL')
+		}
+	})
+})
+
+describe('IotaCommon.midstate cache', function() {
+	const { midstateCacheStats } = require('../iota_common')
+	const tx = 'MIDSTATE'.padEnd(2673, '9')
+	const hashes = ['A', 'B', 'C'].map((c) => c.repeat(81))
+
+	it('Should reattach to a new trunk and branch from the cached prefix', async function() {
+		this.timeout(0)
+		const before = midstateCacheStats()
+		const first = await powBundleFunc([tx], hashes[0], hashes[1], 9)
+		const second = await powBundleFunc([tx], hashes[1], hashes[2], 9)
+		const after = midstateCacheStats()
+		assert.equal(after.misses - before.misses, 1)
+		assert.equal(after.hits - before.hits, 1)
+		assert.equal(second[0].slice(2430, 2511), hashes[1])
+		assert.equal(second[0].slice(2511, 2592), hashes[2])
+		;[first[0], second[0]].forEach((trytes) => assert.equal(transactionHashSync(trytes).slice(-3), '999'))
+	})
+})
+
+describe('IotaCommon.powTrytesBatchFunc', function() {
+	const { powTrytesBatchFunc } = require('../iota_common')
+	const txs = Array.from({ length: 40 }, (_, i) => ('BATCH' + '9ABCDEFGHIJKLMNOPQRSTUVWXYZ'[i % 27] + 'ABCDEFGHIJKLMNOPQRSTUVWXYZ'[Math.floor(i / 27)]).padEnd(2673, '9'))
+
+	it('Should find the Proof of Work of every transaction of the batch', async function() {
+		this.timeout(0)
+		const nonces = await powTrytesBatchFunc(txs, 9)
+		assert.lengthOf(nonces, txs.length)
+		nonces.forEach((nonce, i) => {
+			assert.lengthOf(nonce, 27)
+			assert.equal(transactionHashSync(txs[i].slice(0, 2646) + nonce).slice(-3), '999')
+		})
+	})
+
+	it('Should reject invalid transactions', async function() {
+		try {
+			await powTrytesBatchFunc([txs[0], 'INVALID'], 9)
+			assert.fail()
+		} catch (err) {
+			assert.equal(err.code, 'EINVAL')
+		}
+	})
+})
+
+describe('IotaCommon.powTrytesFunc partitions', function() {
+	const tx = 'PARTITION'.padEnd(2673, '9')
+	// Iteration counter written in nonce trits 6 to 32
+	const counter = (nonce) => {
+		const trits = [...nonce].flatMap((tryte) => {
+			const value = '9ABCDEFGHIJKLMNOPQRSTUVWXYZ'.indexOf(tryte)
+			const balanced = value > 13 ? value - 27 : value
+			return [0, 1, 2].map((i) => {
+				const trit = ((Math.floor((balanced + 13) / Math.pow(3, i)) % 3) + 3) % 3
+				return trit
+			})
+		})
+		return trits.slice(6, 33).reduceRight((sum, trit) => sum * 3 + trit, 0)
+	}
+
+	it('Should find a nonce within its partition', async function() {
+		this.timeout(0)
+		const nonce = await powTrytesFunc(tx, 9, { partition: { index: 2, count: 3 } })
+		const value = counter(nonce)
+		assert.isAtLeast(value, 2 * 2541865828329)
+		assert.isBelow(value, 7625597484987)
+		assert.equal(transactionHashSync(tx.slice(0, 2646) + nonce).slice(-3), '999')
+	})
+
+	it('Should reject with ERANGE once the range is exhausted', async function() {
+		try {
+			await powTrytesFunc(tx, 60, { range: { start: 5, end: 7 } })
+			assert.fail()
+		} catch (err) {
+			assert.equal(err.code, 'ERANGE')
+		}
+	})
+
+	it('Should release every thread once a range shared by several threads is exhausted', async function() {
+		this.timeout(0)
+		const err = await powTrytesFunc(tx, 60, { range: { start: 0, end: 2000 } }).catch((err) => err)
+		assert.equal(err.code, 'ERANGE')
+		const start = Date.now()
+		while (schedulerStats().running > 0 && Date.now() - start < 1000) {
+			await new Promise((resolve) => setTimeout(resolve, 10))
+		}
+		assert.equal(schedulerStats().running, 0)
+	})
+
+	it('Should refuse invalid partitions', async function() {
+		try {
+			await powTrytesFunc(tx, 9, { partition: { index: 3, count: 3 } })
+			assert.fail()
+		} catch (err) {
+			assert.equal(err.code, 'EINVAL')
+		}
+	})
+})
+
+describe('IotaCommon.hashcashFunc', function() {
+	const { hashcashFunc } = require('../iota_common')
+	const tx = 'HASHCASH'.padEnd(2673, '9')
+
+	it('Should find a nonce ending the buffer, as transaction Proof of Work does', async function() {
+		this.timeout(0)
+		const { nonce, hash } = await hashcashFunc(tx, 2646, 27, 9)
+		assert.lengthOf(nonce, 27)
+		assert.equal(hash, transactionHashSync(tx.slice(0, 2646) + nonce))
+		assert.equal(hash.slice(-3), '999')
+	})
+
+	it('Should find a nonce anywhere in the buffer', async function() {
+		this.timeout(0)
+		const { nonce, hash } = await hashcashFunc(tx, 81, 9, 6)
+		assert.lengthOf(nonce, 9)
+		assert.equal(hash, transactionHashSync(tx.slice(0, 81) + nonce + tx.slice(90)))
+		assert.equal(hash.slice(-2), '99')
+	})
+
+	it('Should take trits', async function() {
+		this.timeout(0)
+		const trits = new Array(486).fill(0)
+		const { nonce, hash } = await hashcashFunc(trits, 100, 20, 4)
+		assert.lengthOf(nonce, 20)
+		assert.lengthOf(hash, 243)
+		assert.deepEqual(hash.slice(-4), [0, 0, 0, 0])
+	})
+
+	it('Should refuse a nonce across two blocks', async function() {
+		try {
+			await hashcashFunc(tx, 75, 9, 6)
+			assert.fail()
+		} catch (err) {
+			assert.equal(err.code, 'EINVAL')
+		}
+	})
+})
+
+describe('IotaCommon.setPowBackend', function() {
+	const { setPowBackend } = require('../iota_common')
+	const path = require('path')
+	const fs = require('fs')
+	const binary = path.join(__dirname, '..', 'build', 'Release', 'entangled_pow_worker')
+	const socket = path.join(require('os').tmpdir(), `entangled-pow-${process.pid}.sock`)
+	const tx = 'WORKER'.padEnd(2673, '9')
+	let worker = null
+
+	after(function() {
+		setPowBackend()
+		if (worker) {
+			worker.kill()
+		}
+	})
+
+	it('Should run Proof of Work in process once the worker cannot be reached', async function() {
+		this.timeout(0)
+		setPowBackend({ socket: `${socket}.missing`, retries: 1, retryDelay: 10 })
+		const nonce = await powTrytesFunc(tx, 9)
+		assert.equal(transactionHashSync(tx.slice(0, 2646) + nonce).slice(-3), '999')
+	})
+
+	it('Should reject with ECONNREFUSED without fallback', async function() {
+		setPowBackend({ socket: `${socket}.missing`, retries: 0, fallback: false })
+		try {
+			await powTrytesFunc(tx, 9)
+			assert.fail()
+		} catch (err) {
+			assert.equal(err.code, 'ECONNREFUSED')
+		}
+	})
+
+	it('Should retry, then fall back, when a worker replies before its search ends or rejects the request', async function() {
+		this.timeout(0)
+		const fake = `${socket}.fake`
+		// POW_SEARCHING and POW_REJECTED
+		for (const status of [0, 5]) {
+			let connections = 0
+			const server = require('net').createServer((connection) => {
+				let received = Buffer.alloc(0)
+				connections++
+				connection.on('data', (data) => {
+					received = Buffer.concat([received, data])
+					if (received.length >= 4 && received.length >= 4 + received.readUInt32BE(0)) {
+						const reply = Buffer.from(`${status} 0 0`)
+						const header = Buffer.alloc(4)
+						header.writeUInt32BE(reply.length)
+						connection.end(Buffer.concat([header, reply]))
+					}
+				})
+			})
+			await new Promise((resolve) => server.listen(fake, resolve))
+			try {
+				setPowBackend({ socket: fake, retries: 1, retryDelay: 10, fallback: false })
+				const err = await powTrytesFunc(tx, 9).catch((err) => err)
+				assert.equal(err.code, 'ECONNREFUSED')
+				assert.equal(connections, 2)
+				setPowBackend({ socket: fake, retries: 0 })
+				const nonce = await powTrytesFunc(tx, 9)
+				assert.equal(transactionHashSync(tx.slice(0, 2646) + nonce).slice(-3), '999')
+			} finally {
+				setPowBackend()
+				await new Promise((resolve) => server.close(resolve))
+			}
+		}
+	})
+
+	it('Should run Proof of Work on a worker process', async function() {
+		this.timeout(0)
+		if (!fs.existsSync(binary)) {
+			this.skip()
+		}
+		worker = require('child_process').spawn(binary, [socket, '1'], { stdio: 'inherit' })
+		while (!fs.existsSync(socket)) {
+			await new Promise((resolve) => setTimeout(resolve, 10))
+		}
+		setPowBackend({ socket, fallback: false })
+		const nonce = await powTrytesFunc(tx, 9)
+		assert.equal(transactionHashSync(tx.slice(0, 2646) + nonce).slice(-3), '999')
+		const bundle = await powBundleFunc([tx, tx], 'A'.repeat(81), 'B'.repeat(81), 9)
+		assert.lengthOf(bundle, 2)
+		assert.equal(transactionHashSync(bundle[1]).slice(-3), '999')
+	})
+})
+
+describe('IotaCommon.powTrytesFunc stats', function() {
+	const tx = 'STATS'.padEnd(2673, '9')
+
+	it('Should report the weight, attempts, time and threads of the search', async function() {
+		this.timeout(0)
+		const { nonce, weight, attempts, elapsed, threads, backend } = await powTrytesFunc(tx, 9, { stats: true })
+		const hash = transactionHashSync(tx.slice(0, 2646) + nonce)
+		assert.isAtLeast(weight, 9)
+		assert.equal(hash.slice(-Math.floor(weight / 3)), '9'.repeat(Math.floor(weight / 3)))
+		assert.isAbove(attempts, 0)
+		assert.isAtLeast(elapsed, 0)
+		assert.isAtLeast(threads, 1)
+		assert.equal(backend, 'local')
+	})
+
+	it('Should report the smallest weight of a bundle', async function() {
+		this.timeout(0)
+		const { trytes, weight, attempts } = await powBundleFunc([tx, tx], 'A'.repeat(81), 'B'.repeat(81), 9, { stats: true })
+		assert.lengthOf(trytes, 2)
+		assert.isAtLeast(weight, 9)
+		assert.isAbove(attempts, 0)
+	})
+})
+
+describe('IotaCommon.transactionHashesFunc', function() {
+	const { transactionHashesFunc } = require('../iota_common')
+	const txs = Array.from({ length: 700 }, (_, i) => `BATCH${'ABCDEFGHIJKLMNOPQRSTUVWXYZ9'[i % 27]}${i}`.replace(/[0-9]/g, (d) => 'ABCDEFGHIJ'[d]).padEnd(2673, '9'))
+
+	it('Should hash every transaction as transactionHashSync does', async function() {
+		this.timeout(0)
+		const hashes = await transactionHashesFunc(txs)
+		assert.lengthOf(hashes, txs.length)
+		hashes.forEach((hash, i) => assert.equal(hash, transactionHashSync(txs[i])))
+	})
+
+	it('Should hash packed Buffers and report weights', async function() {
+		this.timeout(0)
+		const nonce = await powTrytesFunc(txs[0], 9)
+		const attached = txs[0].slice(0, 2646) + nonce
+		const { hashes, weights } = await transactionHashesFunc(Buffer.from(attached + txs[1]), { weights: true })
+		assert.deepEqual(hashes, [transactionHashSync(attached), transactionHashSync(txs[1])])
+		assert.isAtLeast(weights[0], 9)
+		assert.equal(hashes[0].slice(-Math.floor(weights[0] / 3)), '9'.repeat(Math.floor(weights[0] / 3)))
+	})
+
+	it('Should reject invalid trytes', async function() {
+		try {
+			await transactionHashesFunc([txs[0].slice(0, 2672) + 'a'])
+			assert.fail()
+		} catch (err) {
+			assert.equal(err.code, 'EINVAL')
+		}
+	})
+})
+
+describe('Keccak-p[1600]', function() {
+	const path = require('path')
+	const fs = require('fs')
+	const name = process.platform === 'win32' ? 'keccak_test.exe' : 'keccak_test'
+	const binary = path.join(__dirname, '..', 'build', 'Release', name)
+
+	it('Should match the reference implementation', function() {
+		this.timeout(0)
+		if (!fs.existsSync(binary)) {
+			this.skip()
+		}
+		const result = require('child_process').spawnSync(binary, ['10000'], { encoding: 'utf8' })
+		assert.equal(result.status, 0, result.stderr)
+	})
+})
+
+describe('Kerl', function() {
+	const path = require('path')
+	const fs = require('fs')
+	const name = process.platform === 'win32' ? 'kerl_test.exe' : 'kerl_test'
+	const binary = path.join(__dirname, '..', 'build', 'Release', name)
+
+	it('Should match the generic conversions and sponge', function() {
+		this.timeout(0)
+		if (!fs.existsSync(binary)) {
+			this.skip()
+		}
+		const result = require('child_process').spawnSync(binary, ['10000'], { encoding: 'utf8' })
+		assert.equal(result.status, 0, result.stderr)
+	})
+})
+
+describe('IotaCommon.Kerl and CurlP81', function() {
+	const { Kerl, CurlP81 } = require('../iota_common')
+	const input = 'EMIDYNHBWMBCXVDEFOFWINXTERALUKYYPPHKP9JJFGJEIUY9MUDVNFZHMMWZUYUSWAIOWEVTHNWMHANBH'
+	const tx = 'STREAMING'.padEnd(2673, '9')
+
+	it('Should hash trytes with Kerl', function() {
+		assert.equal(new Kerl().absorb(input).squeezeTrytes(), 'EJEAOOZYSAWFPZQESYDHZCGYNSTWXUMVJOVDWUNZJXDGWCLUFGIMZRMGCAZGKNPLBRLGUNYWKLJTYEAQX')
+	})
+
+	it('Should hash a transaction piece by piece as transactionHashSync does', function() {
+		const curl = new CurlP81()
+		for (let offset = 0; offset < tx.length; offset += 243) {
+			curl.absorb(tx.slice(offset, offset + 243))
+		}
+		assert.equal(curl.squeezeTrytes(), transactionHashSync(tx))
+	})
+
+	it('Should take trits, trytes and Buffers alike', function() {
+		const trits = new Kerl().absorb(input).squeeze()
+		assert.lengthOf(trits, 243)
+		assert.deepEqual(new Kerl().absorb(Buffer.from(input)).squeeze(), trits)
+		assert.deepEqual(new Kerl().absorb(trits).squeeze(), new Kerl().absorb(Int8Array.from(trits)).squeeze())
+	})
+
+	it('Should fork the sponge with clone', function() {
+		const prefix = new CurlP81().absorb(tx.slice(0, 2592))
+		const fork = prefix.clone()
+		const suffix = tx.slice(2592)
+		assert.equal(fork.absorb(suffix).squeezeTrytes(), transactionHashSync(tx))
+		assert.equal(prefix.absorb(suffix).squeezeTrytes(), transactionHashSync(tx))
+		assert.instanceOf(fork, CurlP81)
+		assert.equal(prefix.reset().absorb(tx).squeezeTrytes(), transactionHashSync(tx))
+	})
+
+	it('Should refuse invalid input', function() {
+		const kerl = new Kerl()
+		assert.throws(() => kerl.absorb(input.slice(1)), /multiple of 243/)
+		assert.throws(() => kerl.absorb(input.toLowerCase()), /Invalid trits or trytes/)
+		assert.throws(() => new CurlP81().absorb(new Array(243).fill(2)), /Invalid trits or trytes/)
+		assert.throws(() => kerl.squeeze(100), /multiple of 243/)
+		assert.throws(() => Kerl.prototype.absorb.call(new CurlP81(), input))
+	})
+})
+
+describe('IotaCommon.genAddressRange', function() {
+	const { genAddressRange, genAddressTrytesSync } = require('../iota_common')
+	const seed = 'NREIZPJYTY9FUVBTLTQWHRUUAQ9YFAUVQVRBAZSIJOIHQMS9UFGSXQDHCRNYCILBXGOQGSFABTPMRESEB'
+
+	it('Should generate the addresses of a range in chunks', async function() {
+		this.timeout(0)
+		const chunks = []
+		for await (const chunk of genAddressRange(seed, 898, 5, 2, { chunkSize: 2 })) {
+			chunks.push(chunk)
+		}
+		assert.deepEqual(chunks.map((chunk) => chunk.length), [2, 2, 1])
+		assert.equal(chunks[1][0], 'UTTVTRVZNJDOXPOSRA9IRUSMRSIZWN9MSDOSNTIUFZXUVJIDDP9OODNNEJZWHVTVOZSQBYIDERWJXHOV9')
+	})
+
+	it('Should increment the seed as index additions do, carries included', async function() {
+		this.timeout(0)
+		const carrying = 'M'.repeat(81)
+		const addresses = []
+		for await (const chunk of genAddressRange(carrying, 0, 30, 1, { chunkSize: 13 })) {
+			addresses.push(...chunk)
+		}
+		assert.deepEqual(addresses, Array.from({ length: 30 }, (_, i) => genAddressTrytesSync(carrying, i, 1)))
+	})
+
+	it('Should reject an invalid security level', async function() {
+		try {
+			for await (const chunk of genAddressRange(seed, 0, 10, 4)) {
+				assert.fail(chunk)
+			}
+			assert.fail()
+		} catch (err) {
+			assert.equal(err.message, 'Invalid seed, bundle hash or security level')
+		}
+	})
+})
+
+describe('IotaCommon.genAddressBatchFunc', function() {
+	const { genAddressBatchFunc, genAddressTrytesSync } = require('../iota_common')
+	const seeds = ['NREIZPJYTY9FUVBTLTQWHRUUAQ9YFAUVQVRBAZSIJOIHQMS9UFGSXQDHCRNYCILBXGOQGSFABTPMRESEB', 'M'.repeat(81), 'SEED']
+	const tuples = Array.from({ length: 20 }, (_, i) => ({ seed: seeds[i % 3].padEnd(81, '9'), index: 3 * i, security: 1 + (i % 3) }))
+
+	it('Should generate the address of every tuple into one packed Buffer', async function() {
+		this.timeout(0)
+		const packed = Buffer.from(tuples.map((tuple) => tuple.seed).join(''))
+		const addresses = await genAddressBatchFunc(packed, tuples.map((tuple) => tuple.index), tuples.map((tuple) => tuple.security))
+		packed.fill(0)
+		assert.equal(addresses.length, tuples.length * 81)
+		tuples.forEach((tuple, i) =>
+			assert.equal(addresses.toString('latin1', 81 * i, 81 * (i + 1)), genAddressTrytesSync(tuple.seed, tuple.index, tuple.security))
+		)
+	})
+
+	it('Should reject invalid seeds and security levels', async function() {
+		for (const [seed, security] of [['a'.repeat(81), 2], ['9'.repeat(81), 4]]) {
+			try {
+				await genAddressBatchFunc(Buffer.from(seed + '9'.repeat(81)), [0, 1], security)
+				assert.fail()
+			} catch (err) {
+				assert.equal(err.code, 'EINVAL')
+			}
+		}
+	})
+
+	it('Should default to security 2 when security is null', async function() {
+		const addresses = await genAddressBatchFunc(Buffer.from(tuples[0].seed), [7], null)
+		assert.equal(addresses.toString('latin1'), genAddressTrytesSync(tuples[0].seed, 7, 2))
+	})
+})